@@ -0,0 +1,254 @@
+// Callback benchmark: cost of the real-time data callbacks, without audio devices.
+//
+// Drives internal::data_callback_{loopback,playback,duplex} directly over every
+// AudioRedirector::Formats x AudioRedirector::SampleRates x period size, with the same
+// pipeline state the Start*Redirect functions build. Loopback and playback run as a pair
+// (write one period, render one period) so the ring holds steady at the target latency.
+// Reports ns/frame and p50/p99 per call; --json writes the results for regression tracking.
+//
+// Usage: CallbackBench [--calls <n>] [--json <path>|-]
+
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#include "AudioRedirector.hpp"
+#include "AudioInternal.hpp"
+#include "MAConvert.hpp"
+#include "SampleConvert.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr ma_uint32 kChannels = 2;
+static constexpr ma_uint32 kPeriods[] = {128, 256, 480, 512, 1024};
+static constexpr int kWarmupCalls = 64; // After pre-roll, so the jitter buffer and drift loop are settled
+
+enum class Case
+{
+	Loopback,     // data_callback_loopback: capture -> ring
+	Playback,     // data_callback_playback: ring -> jitter buffer -> resampler -> gain -> limiter
+	Duplex,       // data_callback_duplex with the limiter on
+	DuplexDirect, // data_callback_duplex at unity gain without the limiter (straight conversion)
+};
+
+static const char *to_string(Case c) {
+	switch (c) {
+		case Case::Loopback: return "loopback";
+		case Case::Playback: return "playback";
+		case Case::Duplex: return "duplex";
+		case Case::DuplexDirect: return "duplex-direct";
+	}
+	return "unknown";
+}
+
+struct Measurement {
+	Case callback;
+	ma_format format;
+	ma_uint32 sampleRate;
+	ma_uint32 periodFrames;
+	double nsPerFrame; // Mean over all timed calls
+	double p50Us;
+	double p99Us;
+	double budgetPercent; // p99 call against the period length
+};
+
+// "s16 (Signed 16-bit)" -> "s16"
+static std::string_view short_name(ma_format format) {
+	const std::string_view name = ma::convert::to_string(format);
+	return name.substr(0, name.find(' '));
+}
+
+// A stereo tone at -6 dBFS in the given format, one period long.
+static std::vector<ma_uint8> make_period(ma_format format, ma_uint32 sampleRate, ma_uint32 frames) {
+	std::vector<float> tone((size_t)frames * kChannels);
+	for (ma_uint32 i = 0; i < frames; ++i) {
+		const float s = 0.5f * std::sin(2.0f * 3.14159265f * 997.0f * i / sampleRate);
+		tone[i * kChannels + 0] = s;
+		tone[i * kChannels + 1] = -s;
+	}
+
+	std::vector<ma_uint8> data((size_t)frames * ma_get_bytes_per_frame(format, kChannels));
+	SampleConvert::Convert(data.data(), format, tone.data(), ma_format_f32, tone.size());
+	return data;
+}
+
+static Measurement summarize(Case c, ma_format format, ma_uint32 sampleRate, ma_uint32 period, std::vector<double> &callNs) {
+	double total = 0.0;
+	for (const double ns : callNs) total += ns;
+
+	std::sort(callNs.begin(), callNs.end());
+	const double p99 = callNs[callNs.size() * 99 / 100];
+	const double periodNs = 1e9 * period / sampleRate;
+
+	return Measurement{
+		c, format, sampleRate, period,
+		total / ((double)callNs.size() * period),
+		callNs[callNs.size() / 2] / 1000.0,
+		p99 / 1000.0,
+		100.0 * p99 / periodNs,
+	};
+}
+
+static double time_call(ma_device_data_proc callback, ma_device *device, void *pOutput, const void *pInput, ma_uint32 frames) {
+	const auto start = Clock::now();
+	callback(device, pOutput, pInput, frames);
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void run_loopback(ma_format format, ma_uint32 sampleRate, ma_uint32 period, int calls, std::vector<Measurement> &results) {
+	AudioRedirector::SetLoopbackFormat(format);
+	AudioRedirector::SetLoopbackSampleRate(sampleRate);
+	AudioRedirector::SetLimiterEnabled(true);
+	AudioRedirector::SetPlaybackVolume(1.0f);
+
+	if (internal::init_loopback_pipeline() != MA_SUCCESS) {
+		std::fprintf(stderr, "Failed to initialize the loopback pipeline.\n");
+		std::exit(1);
+	}
+
+	// The loopback callbacks take everything from internal state; the device is never read.
+	static ma_device device = {};
+	const std::vector<ma_uint8> input = make_period(format, sampleRate, period);
+	std::vector<ma_uint8> output(input.size());
+
+	// Pre-roll: the jitter buffer holds playback back until it reaches the target latency.
+	const ma_uint64 prerollCalls = (ma_uint64)AudioRedirector::GetLoopbackLatency() * sampleRate / 1000 / period + 2;
+	for (ma_uint64 i = 0; i < prerollCalls + kWarmupCalls; ++i) {
+		internal::data_callback_loopback(&device, nullptr, input.data(), period);
+		internal::data_callback_playback(&device, output.data(), nullptr, period);
+	}
+
+	std::vector<double> writeNs, renderNs;
+	writeNs.reserve(calls);
+	renderNs.reserve(calls);
+	for (int i = 0; i < calls; ++i) {
+		writeNs.push_back(time_call(internal::data_callback_loopback, &device, nullptr, input.data(), period));
+		renderNs.push_back(time_call(internal::data_callback_playback, &device, output.data(), nullptr, period));
+	}
+
+	internal::uninit_loopback_pipeline();
+
+	results.push_back(summarize(Case::Loopback, format, sampleRate, period, writeNs));
+	results.push_back(summarize(Case::Playback, format, sampleRate, period, renderNs));
+}
+
+static void run_duplex(Case c, ma_format format, ma_uint32 sampleRate, ma_uint32 period, int calls, std::vector<Measurement> &results) {
+	AudioRedirector::SetDuplexFormat(format);
+	AudioRedirector::SetDuplexSampleRate(sampleRate);
+	AudioRedirector::SetLimiterEnabled(c == Case::Duplex);
+	AudioRedirector::SetDuplexVolume(1.0f);
+
+	internal::init_duplex_pipeline();
+
+	// The duplex callback reads the formats and channel count from the device.
+	static ma_device device = {};
+	device.capture.format = format;
+	device.capture.channels = kChannels;
+	device.playback.format = format;
+	device.playback.channels = kChannels;
+
+	const std::vector<ma_uint8> input = make_period(format, sampleRate, period);
+	std::vector<ma_uint8> output(input.size());
+
+	for (int i = 0; i < kWarmupCalls; ++i) {
+		internal::data_callback_duplex(&device, output.data(), input.data(), period);
+	}
+
+	std::vector<double> callNs;
+	callNs.reserve(calls);
+	for (int i = 0; i < calls; ++i) {
+		callNs.push_back(time_call(internal::data_callback_duplex, &device, output.data(), input.data(), period));
+	}
+
+	results.push_back(summarize(c, format, sampleRate, period, callNs));
+}
+
+static bool write_json(const std::vector<Measurement> &results, int calls, const std::string &path) {
+	FILE *file = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+	if (file == nullptr) return false;
+
+	std::fprintf(file, "{\n");
+	std::fprintf(file, "  \"benchmark\": \"CallbackBench\",\n");
+	std::fprintf(file, "  \"isa\": \"%s\",\n", SampleConvert::to_string(SampleConvert::GetIsa()));
+	std::fprintf(file, "  \"channels\": %u,\n", kChannels);
+	std::fprintf(file, "  \"callsPerCase\": %d,\n", calls);
+	std::fprintf(file, "  \"results\": [\n");
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Measurement &m = results[i];
+		const std::string_view format = short_name(m.format);
+		std::fprintf(
+			file,
+			"    {\"callback\": \"%s\", \"format\": \"%.*s\", \"sampleRate\": %u, \"periodFrames\": %u, "
+			"\"nsPerFrame\": %.3f, \"p50Us\": %.3f, \"p99Us\": %.3f, \"budgetPercent\": %.3f}%s\n",
+			to_string(m.callback), (int)format.size(), format.data(), m.sampleRate, m.periodFrames,
+			m.nsPerFrame, m.p50Us, m.p99Us, m.budgetPercent, i + 1 < results.size() ? "," : ""
+		);
+	}
+
+	std::fprintf(file, "  ]\n}\n");
+	if (file != stdout) std::fclose(file);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	int calls = 400;
+	std::string jsonPath;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--calls" && i + 1 < argc) {
+			calls = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--json" && i + 1 < argc) {
+			jsonPath = argv[++i];
+		} else {
+			std::fprintf(stderr, "Usage: CallbackBench [--calls <n>] [--json <path>|-]\n");
+			return 2;
+		}
+	}
+
+	// With the JSON on stdout the table goes to stderr, so the output stays parseable.
+	FILE *table = jsonPath == "-" ? stderr : stdout;
+
+	std::fprintf(
+		table, "%u channels, %d timed calls per case, kernel set: %s\n\n",
+		kChannels, calls, SampleConvert::to_string(SampleConvert::GetIsa())
+	);
+	std::fprintf(
+		table, "%-14s %-7s %8s %8s %10s %10s %10s %9s\n",
+		"Callback", "Format", "Rate", "Period", "ns/frame", "p50 us", "p99 us", "Budget"
+	);
+
+	std::vector<Measurement> results;
+	for (const ma_format format : AudioRedirector::Formats) {
+		for (const ma_uint32 sampleRate : AudioRedirector::SampleRates) {
+			for (const ma_uint32 period : kPeriods) {
+				const size_t first = results.size();
+				run_loopback(format, sampleRate, period, calls, results);
+				run_duplex(Case::Duplex, format, sampleRate, period, calls, results);
+				run_duplex(Case::DuplexDirect, format, sampleRate, period, calls, results);
+
+				for (size_t i = first; i < results.size(); ++i) {
+					const Measurement &m = results[i];
+					const std::string_view name = short_name(m.format);
+					std::fprintf(
+						table, "%-14s %-7.*s %8u %8u %10.1f %10.2f %10.2f %8.2f%%\n",
+						to_string(m.callback), (int)name.size(), name.data(), m.sampleRate, m.periodFrames,
+						m.nsPerFrame, m.p50Us, m.p99Us, m.budgetPercent
+					);
+				}
+			}
+		}
+	}
+
+	if (!jsonPath.empty() && !write_json(results, calls, jsonPath)) {
+		std::fprintf(stderr, "Failed to write %s.\n", jsonPath.c_str());
+		return 1;
+	}
+	return 0;
+}
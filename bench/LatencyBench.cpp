@@ -0,0 +1,123 @@
+// Latency benchmark: end-to-end latency of the loopback path on a simulated device pair.
+//
+// Stands in for the devices behind AudioRedirector::MeasureLoopbackLatency: a virtual clock
+// fires the loopback capture and playback callbacks at their period boundaries (a capture
+// buffer is delivered once it has been recorded, a playback buffer is heard one period after
+// it is rendered), markers are injected into the captured audio and detected in the rendered
+// audio with the same LatencyProbe. The result is the glass-to-glass latency the pipeline adds
+// on top of the device and driver buffers, for several target latencies and period pairs.
+//
+// Usage: LatencyBench [--seconds <n>]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#include "AudioRedirector.hpp"
+#include "AudioInternal.hpp"
+#include "LatencyProbe.hpp"
+
+static constexpr ma_uint32 kSampleRate = 48000;
+static constexpr ma_uint32 kChannels = 2;
+static constexpr ma_uint32 kIntervalFrames = kSampleRate / 4; // A marker every 250 ms
+
+struct Periods {
+	ma_uint32 capture;
+	ma_uint32 playback;
+};
+
+static double frames_to_ns(ma_uint64 frames) {
+	return 1e9 * (double)frames / kSampleRate;
+}
+
+static void run(ma_uint32 latencyMs, Periods periods, ma_uint32 seconds) {
+	AudioRedirector::SetLoopbackFormat(ma_format_f32);
+	AudioRedirector::SetLoopbackSampleRate(kSampleRate);
+	AudioRedirector::SetLoopbackLatency(latencyMs);
+	AudioRedirector::SetLimiterEnabled(true);
+	AudioRedirector::SetPlaybackVolume(1.0f);
+
+	if (internal::init_loopback_pipeline() != MA_SUCCESS) {
+		std::fprintf(stderr, "Failed to initialize the loopback pipeline.\n");
+		std::exit(1);
+	}
+
+	const ma_uint32 markers = seconds * kSampleRate / kIntervalFrames;
+	LatencyProbe probe;
+	probe.Reset(kSampleRate, kIntervalFrames, markers);
+
+	static ma_device device = {}; // The loopback callbacks never read it
+	std::vector<float> captured((size_t)periods.capture * kChannels);
+	std::vector<float> rendered((size_t)periods.playback * kChannels);
+
+	// Capture buffer k holds frames [k * capture, (k + 1) * capture) and is delivered when the
+	// last of them is recorded; playback buffer m is requested at m * playback and is heard
+	// from (m + 1) * playback. Both clocks run at exactly the nominal rate.
+	const ma_uint64 endFrame = (ma_uint64)seconds * kSampleRate;
+	ma_uint64 capturedFrames = 0, renderedFrames = 0;
+
+	while (capturedFrames < endFrame || renderedFrames < endFrame) {
+		const ma_uint64 captureDue = capturedFrames + periods.capture;
+		const ma_uint64 playbackDue = renderedFrames;
+
+		if (captureDue <= playbackDue) {
+			std::fill(captured.begin(), captured.end(), 0.0f);
+			probe.Emit(captured.data(), periods.capture, kChannels, frames_to_ns(capturedFrames));
+			internal::data_callback_loopback(&device, nullptr, captured.data(), periods.capture);
+			capturedFrames += periods.capture;
+		} else {
+			internal::data_callback_playback(&device, rendered.data(), nullptr, periods.playback);
+			probe.Detect(rendered.data(), periods.playback, kChannels, frames_to_ns(renderedFrames + periods.playback));
+			renderedFrames += periods.playback;
+		}
+	}
+
+	internal::uninit_loopback_pipeline();
+
+	std::vector<double> latencies = probe.GetLatenciesMs();
+	if (latencies.empty()) {
+		std::printf("%8u %8u %8u %8u/%-4u %8s\n", latencyMs, periods.capture, periods.playback, 0u, probe.GetSent(), "-");
+		return;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	const auto percentile = [&](double p) { return latencies[(size_t)(p * (latencies.size() - 1) + 0.5)]; };
+
+	std::printf(
+		"%8u %8u %8u %8u/%-4u %8.2f %8.2f %8.2f %8.2f\n",
+		latencyMs, periods.capture, periods.playback, (ma_uint32)latencies.size(), probe.GetSent(),
+		latencies.front(), percentile(0.50), percentile(0.99), latencies.back()
+	);
+}
+
+int main(int argc, char *argv[]) {
+	ma_uint32 seconds = 60;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--seconds" && i + 1 < argc) {
+			seconds = std::max(1, std::atoi(argv[++i]));
+		} else {
+			std::fprintf(stderr, "Usage: LatencyBench [--seconds <n>]\n");
+			return 2;
+		}
+	}
+
+	std::printf("%u Hz, %u channels, %u s of simulated audio per row, a marker every 250 ms\n\n", kSampleRate, kChannels, seconds);
+	std::printf(
+		"%8s %8s %8s %13s %8s %8s %8s %8s\n",
+		"Target", "Capture", "Playback", "Detected", "min ms", "p50 ms", "p99 ms", "max ms"
+	);
+
+	// 10 ms shared-mode periods, 3 ms low-latency periods, and a mismatched pair.
+	const Periods periodPairs[] = {{480, 480}, {144, 144}, {441, 480}, {1024, 256}};
+
+	for (const ma_uint32 latencyMs : {20u, 50u, 100u}) {
+		for (const Periods &periods : periodPairs) {
+			run(latencyMs, periods, seconds);
+		}
+	}
+	return 0;
+}
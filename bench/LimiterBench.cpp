@@ -0,0 +1,81 @@
+// Limiter benchmark: per-frame cost of the true-peak lookahead limiter at 192 kHz.
+//
+// Stereo f32 blocks of one 10 ms callback period are limited in place, for several lookahead
+// lengths and for a quiet signal (no gain reduction) as well as a 10x boosted one (limiting
+// all the time). Reported as ns per frame (p50/p99 over blocks) and as the share of the
+// real-time budget one callback would use.
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "Limiter.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr ma_uint32 kSampleRate = 192000;
+static constexpr ma_uint32 kChannels = 2;
+static constexpr ma_uint32 kBlockFrames = kSampleRate / 100; // 10 ms
+static constexpr int kBlocks = 3000;                         // 30 s of audio
+
+static std::vector<float> make_signal(float gain) {
+	std::vector<float> signal((size_t)kBlockFrames * kChannels * 64);
+	std::mt19937 rng(42);
+	std::normal_distribution<float> noise(0.0f, 0.2f);
+
+	for (size_t i = 0; i < signal.size() / kChannels; ++i) {
+		const float tone = 0.5f * std::sin(2.0f * 3.14159265f * 997.0f * i / kSampleRate);
+		signal[i * kChannels + 0] = gain * (tone + noise(rng));
+		signal[i * kChannels + 1] = gain * (0.8f * tone + noise(rng));
+	}
+	return signal;
+}
+
+static void run(const char *name, ma_uint32 lookaheadMs, const std::vector<float> &signal) {
+	Limiter limiter;
+	limiter.Reset(kSampleRate, kChannels, lookaheadMs, Limiter::DefaultReleaseMs);
+
+	const size_t blockSamples = (size_t)kBlockFrames * kChannels;
+	const size_t signalBlocks = signal.size() / blockSamples;
+	std::vector<float> block(blockSamples);
+	std::vector<double> nsPerFrame;
+	nsPerFrame.reserve(kBlocks);
+
+	for (int i = 0; i < kBlocks; ++i) {
+		std::copy_n(signal.begin() + (i % signalBlocks) * blockSamples, blockSamples, block.begin());
+
+		const auto start = Clock::now();
+		limiter.Process(block.data(), kBlockFrames);
+		nsPerFrame.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kBlockFrames);
+	}
+
+	std::sort(nsPerFrame.begin(), nsPerFrame.end());
+	const double p50 = nsPerFrame[nsPerFrame.size() / 2];
+	const double p99 = nsPerFrame[nsPerFrame.size() * 99 / 100];
+	const double budgetNs = 1e9 / kSampleRate;
+
+	std::printf(
+		"%-8s %10u %10u %10.1f %10.1f %9.2f%% %10.1f\n",
+		name, lookaheadMs, limiter.GetLatencyFrames(), p50, p99, 100.0 * p50 / budgetNs, limiter.GetGainReductionDb()
+	);
+}
+
+int main() {
+	std::printf("%u Hz, %u channels, %u-frame blocks\n\n", kSampleRate, kChannels, kBlockFrames);
+	std::printf(
+		"%-8s %10s %10s %10s %10s %10s %10s\n",
+		"Signal", "Lookahead", "Latency", "ns/f p50", "ns/f p99", "Budget", "GR dB"
+	);
+
+	const std::vector<float> quiet = make_signal(0.5f);
+	const std::vector<float> boosted = make_signal(10.0f);
+
+	for (const ma_uint32 lookaheadMs : {1u, 5u, 10u, 20u}) {
+		run("quiet", lookaheadMs, quiet);
+		run("10x", lookaheadMs, boosted);
+	}
+	return 0;
+}
@@ -0,0 +1,170 @@
+// Log benchmark: the queued background writer vs the previous synchronous logger.
+//
+// Each of 1..8 threads logs a run of two-line messages as fast as it can. Reports the time a
+// caller spends inside the log call as p50/p99 in nanoseconds, and messages per second from the
+// first call until the last message is on disk. The synchronous logger is the implementation
+// the writer replaced (a global mutex and an ofstream opened per message), kept here as the
+// reference.
+//
+// Release builds only: debug builds log to the console.
+//
+// Usage: LogBench [--messages <n per thread>]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <format>
+#include <string_view>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+#include "Log.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kThreadCounts[] = {1, 2, 4, 8};
+static const char *kLogPath = "LogBench.log";
+
+struct Percentiles {
+	double p50;
+	double p99;
+};
+
+static Percentiles percentiles(std::vector<double> &samples) {
+	std::sort(samples.begin(), samples.end());
+	return {samples[samples.size() / 2], samples[samples.size() * 99 / 100]};
+}
+
+// ----------------------------------------------------------------------------
+// The synchronous logger, as it was before the writer thread
+// ----------------------------------------------------------------------------
+
+namespace sync_log {
+	std::mutex mutex;
+
+	std::string timestamp() {
+		auto now = std::chrono::system_clock::now();
+		std::time_t time = std::chrono::system_clock::to_time_t(now);
+		std::tm localTime{};
+#if defined(_WIN32) || defined(_WIN64)
+		localtime_s(&localTime, &time);
+#else
+		localtime_r(&time, &localTime);
+#endif
+		std::ostringstream oss;
+		oss << std::put_time(&localTime, "%d-%m-%Y %H:%M:%S");
+		return oss.str();
+	}
+
+	void message(const std::string &message) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::ofstream logFile(kLogPath, std::ios::app);
+		if (!logFile.is_open()) return;
+
+		const std::string stamp = timestamp();
+		std::istringstream iss(message);
+		std::string line;
+		bool timestampAdded = false;
+
+		while (std::getline(iss, line)) {
+			if (line.empty()) continue;
+			if (!timestampAdded) {
+				logFile << "[" << stamp << "] " << Log::private_::GetLevelString(Log::Level::Info) << ": " << line << "\n";
+				timestampAdded = true;
+			} else {
+				logFile << std::string(stamp.size() + 3, ' ') << line << "\n";
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Benchmark
+// ----------------------------------------------------------------------------
+
+struct Measurement {
+	Percentiles callNs;
+	double messagesPerSecond;
+};
+
+template <typename LogFn, typename FlushFn>
+static Measurement run(int threads, int messages, LogFn log, FlushFn flush) {
+	std::filesystem::remove(kLogPath);
+	Log::SetLogFile(kLogPath); // The writer reopens it at its next batch
+
+	std::vector<std::vector<double>> callNs(threads);
+	std::vector<std::thread> workers;
+
+	const Clock::time_point start = Clock::now();
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t]() {
+			callNs[t].reserve(messages);
+			for (int i = 0; i < messages; ++i) {
+				const Clock::time_point before = Clock::now();
+				log(t, i);
+				callNs[t].push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+			}
+		});
+	}
+	for (std::thread &worker : workers) worker.join();
+	flush();
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::vector<double> all;
+	for (const std::vector<double> &samples : callNs) all.insert(all.end(), samples.begin(), samples.end());
+
+	return {percentiles(all), (double)threads * messages / seconds};
+}
+
+int main(int argc, char *argv[]) {
+#ifndef NDEBUG
+	(void)argc; (void)argv;
+	std::fprintf(stderr, "LogBench measures the file writer; build it in Release.\n");
+	return 1;
+#else
+	int messages = 20000;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--messages" && i + 1 < argc) {
+			messages = std::max(1, std::atoi(argv[++i]));
+		} else {
+			std::fprintf(stderr, "Usage: LogBench [--messages <n per thread>]\n");
+			return 1;
+		}
+	}
+
+	Log::SetRotation(0, 0); // The file size is part of what the synchronous logger pays for
+
+	std::printf("Messages per thread: %d\n\n", messages);
+	std::printf("%-12s %8s %12s %12s %14s\n", "Logger", "Threads", "p50 ns", "p99 ns", "Messages/s");
+
+	for (const int threads : kThreadCounts) {
+		const Measurement synchronous = run(threads, messages,
+			[](int t, int i) { sync_log::message(std::format("Message {} from thread {}\nTraceback: LogBench.cpp:1 in function: main", i, t)); },
+			[]() {}
+		);
+		std::printf("%-12s %8d %12.0f %12.0f %14.0f\n", "synchronous", threads,
+			synchronous.callNs.p50, synchronous.callNs.p99, synchronous.messagesPerSecond);
+
+		const Measurement queued = run(threads, messages,
+			[](int t, int i) { Log::Info("Message {} from thread {}\nTraceback: LogBench.cpp:1 in function: main", i, t); },
+			[]() { Log::Flush(); }
+		);
+		std::printf("%-12s %8d %12.0f %12.0f %14.0f\n", "queued", threads,
+			queued.callNs.p50, queued.callNs.p99, queued.messagesPerSecond);
+	}
+
+	std::filesystem::remove(kLogPath);
+	return 0;
+#endif
+}
@@ -0,0 +1,146 @@
+// Sample rate conversion benchmark: PolyphaseResampler tiers vs miniaudio's linear ma_resampler.
+//
+// Every ordered pair of AudioRedirector sample rates (90 pairs, identity excluded) converts
+// a stereo 997 Hz tone in callback-sized blocks. Both run through ma_resampler, the polyphase
+// one as the custom backend the devices use. Throughput is reported in million output frames
+// per second, with the high tier also on the scalar kernels; quality as the signal to noise
+// ratio of the output against the best fitting 997 Hz sine.
+
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <numbers>
+#include <vector>
+
+#include "AudioRedirector.hpp"
+#include "PolyphaseResampler.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr ma_uint32 kChannels = 2;
+static constexpr ma_uint32 kBlockFrames = 480;  // 10 ms at 48 kHz
+static constexpr double kSeconds = 4.0;         // Of input per measurement
+static constexpr double kToneHz = 997.0;        // Below the Nyquist frequency of every rate
+
+struct Run {
+	double mframesPerSecond;
+	double snrDb;
+};
+
+static std::vector<float> tone(ma_uint32 sampleRate, ma_uint64 frames) {
+	std::vector<float> samples((size_t)frames * kChannels);
+	for (ma_uint64 i = 0; i < frames; ++i) {
+		const float s = 0.5f * (float)std::sin(2.0 * std::numbers::pi * kToneHz * i / sampleRate);
+		for (ma_uint32 c = 0; c < kChannels; ++c) samples[i * kChannels + c] = s;
+	}
+	return samples;
+}
+
+// Least squares fit of a sine and cosine at the tone frequency to the first channel; what the
+// fit leaves over is noise, aliasing and distortion. The filter's warm-up is skipped.
+static double snr_db(const std::vector<float> &output, ma_uint64 frames, ma_uint32 sampleRate) {
+	const ma_uint64 skip = frames / 10;
+	double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+	for (ma_uint64 i = skip; i < frames; ++i) {
+		const double w = 2.0 * std::numbers::pi * kToneHz * i / sampleRate;
+		const double s = std::sin(w), c = std::cos(w), y = output[i * kChannels];
+		ss += s * s; cc += c * c; sc += s * c; ys += y * s; yc += y * c;
+	}
+	const double det = ss * cc - sc * sc;
+	const double a = (ys * cc - yc * sc) / det;
+	const double b = (yc * ss - ys * sc) / det;
+
+	double signal = 0.0, noise = 0.0;
+	for (ma_uint64 i = skip; i < frames; ++i) {
+		const double w = 2.0 * std::numbers::pi * kToneHz * i / sampleRate;
+		const double fit = a * std::sin(w) + b * std::cos(w);
+		const double error = output[i * kChannels] - fit;
+		signal += fit * fit;
+		noise += error * error;
+	}
+	return noise > 0.0 ? 10.0 * std::log10(signal / noise) : 999.0;
+}
+
+static Run measure(ma_resampler_config config, const std::vector<float> &input, ma_uint64 inputFrames) {
+	const ma_uint32 rateIn = config.sampleRateIn;
+	const ma_uint32 rateOut = config.sampleRateOut;
+	const ma_uint64 capacity = (ma_uint64)kBlockFrames * rateOut / rateIn + 16;
+	const ma_uint64 expected = inputFrames * rateOut / rateIn + 16;
+	std::vector<float> output((size_t)expected * kChannels);
+
+	ma_resampler resampler;
+	if (ma_resampler_init(&config, nullptr, &resampler) != MA_SUCCESS) return {0.0, 0.0};
+
+	const auto start = Clock::now();
+	ma_uint64 consumed = 0;
+	ma_uint64 produced = 0;
+	while (consumed < inputFrames) {
+		ma_uint64 frameCountIn = std::min<ma_uint64>(kBlockFrames, inputFrames - consumed);
+		ma_uint64 frameCountOut = std::min(capacity, expected - produced);
+		ma_resampler_process_pcm_frames(
+			&resampler, input.data() + consumed * kChannels, &frameCountIn, output.data() + produced * kChannels, &frameCountOut
+		);
+		if (frameCountIn == 0 && frameCountOut == 0) break;
+		consumed += frameCountIn;
+		produced += frameCountOut;
+	}
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	ma_resampler_uninit(&resampler, nullptr);
+	return {produced / seconds / 1e6, snr_db(output, produced, rateOut)};
+}
+
+static ma_resampler_config polyphase(ma_uint32 rateIn, ma_uint32 rateOut, PolyphaseResampler::Quality quality) {
+	ma_resampler_config config = ma_resampler_config_init(ma_format_f32, kChannels, rateIn, rateOut, ma_resample_algorithm_custom);
+	config.pBackendVTable = PolyphaseResampler::BackendVTable();
+	config.pBackendUserData = PolyphaseResampler::BackendUserData(quality);
+	return config;
+}
+
+int main() {
+	const PolyphaseResampler::Isa isa = PolyphaseResampler::GetIsa();
+	const PolyphaseResampler::Quality qualities[] = {
+		PolyphaseResampler::Quality::Low, PolyphaseResampler::Quality::Medium, PolyphaseResampler::Quality::High
+	};
+
+	std::printf(
+		"Block: %u input frames, %u channels, %.0f s of a %.0f Hz tone, kernel set: %s\n",
+		kBlockFrames, kChannels, kSeconds, kToneHz, SampleConvert::to_string(isa)
+	);
+	std::printf("Throughput in million output frames per second; SNR in dB.\n\n");
+	std::printf(
+		"%6s %6s | %8s %6s | %8s %6s | %8s %6s | %8s %6s | %11s\n",
+		"In", "Out", "Linear", "SNR", "Low", "SNR", "Medium", "SNR", "High", "SNR", "High scalar"
+	);
+
+	for (const ma_uint32 rateIn : AudioRedirector::SampleRates) {
+		const ma_uint64 inputFrames = (ma_uint64)(rateIn * kSeconds);
+		const std::vector<float> input = tone(rateIn, inputFrames);
+
+		for (const ma_uint32 rateOut : AudioRedirector::SampleRates) {
+			if (rateIn == rateOut) continue;
+
+			// The linear resampler as a device's data converter sets it up.
+			ma_resampler_config linearConfig = ma_resampler_config_init(ma_format_f32, kChannels, rateIn, rateOut, ma_resample_algorithm_linear);
+			linearConfig.linear.lpfOrder = ma_device_config_init(ma_device_type_playback).resampling.linear.lpfOrder;
+			const Run linear = measure(linearConfig, input, inputFrames);
+
+			Run tiers[3];
+			for (int i = 0; i < 3; ++i) tiers[i] = measure(polyphase(rateIn, rateOut, qualities[i]), input, inputFrames);
+
+			PolyphaseResampler::SetIsa(PolyphaseResampler::Isa::Scalar);
+			const Run scalar = measure(polyphase(rateIn, rateOut, PolyphaseResampler::Quality::High), input, inputFrames);
+			PolyphaseResampler::SetIsa(isa);
+
+			std::printf(
+				"%6u %6u | %8.1f %6.1f | %8.1f %6.1f | %8.1f %6.1f | %8.1f %6.1f | %11.1f\n",
+				rateIn, rateOut, linear.mframesPerSecond, linear.snrDb,
+				tiers[0].mframesPerSecond, tiers[0].snrDb, tiers[1].mframesPerSecond, tiers[1].snrDb,
+				tiers[2].mframesPerSecond, tiers[2].snrDb, scalar.mframesPerSecond
+			);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <functional>
+#include "miniaudio.h"
+
+class ChannelMatrix;
+class FlightRecorder;
+struct ChannelRoute;
+enum class ResamplerQuality;
+
+// State shared between the AudioRedirector translation units.
+namespace internal {
+	extern ma_context context;
+
+	// Per-start processing state of the active loopback and duplex routes (rings, jitter buffer,
+	// resampler, gain, limiter), built from the current settings. The Start*Redirect functions
+	// call these around device init; benchmarks call them to drive the callbacks without devices.
+	ma_result init_loopback_pipeline();
+	void uninit_loopback_pipeline();
+	void init_duplex_pipeline();
+
+	// The callbacks find their route in pDevice->pUserData; with none they run the active route.
+	void data_callback_loopback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount);
+	void data_callback_playback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount);
+	void data_callback_duplex(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount);
+
+	// Routing matrix of a route list: the sum of its gains, ignoring routes outside the channel
+	// counts; with no routes, the default routing by channel position.
+	void build_routing(
+		ChannelMatrix &matrix, ma_uint32 inputChannels, ma_uint32 outputChannels, const ChannelRoute *routes, size_t routeCount
+	);
+
+	// The formats a route opens its devices with: the settings, or in auto format mode the
+	// devices' native formats.
+	struct StreamFormat {
+		ma_format format;
+		ma_format playbackFormat;
+		ma_uint32 channels;
+		ma_uint32 playbackChannels;
+		ma_uint32 sampleRate;
+	};
+
+	// Plugs the resampler of a quality setting into a device's or a data converter's config.
+	void set_resampler(ma_resampler_config &config, ResamplerQuality quality);
+
+	// Offline renders run a path's callbacks on a route of their own beside the live ones, built
+	// like a live route from the path's settings and volume but in the given stream format, on a
+	// bare device. offline_process() runs one period through it: the duplex callback, or the
+	// loopback callback and then the playback callback, whose jitter buffer pre-rolls as it would
+	// live. The source type is ma_device_type_loopback or ma_device_type_capture (duplex).
+	struct OfflineRoute;
+	OfflineRoute *create_offline_route(ma_device_type sourceType, const StreamFormat &format); // nullptr when out of memory
+	void destroy_offline_route(OfflineRoute *route);
+	void offline_process(OfflineRoute *route, void *pOutput, const void *pInput, ma_uint32 frameCount);
+
+	// The recorder the live routes and the supervisor record their events in.
+	const FlightRecorder &event_recorder();
+
+	// Poll until the condition holds or timeoutMs of pipeline time passed; on VirtualBackend's
+	// manual clock the wait drives the clock itself. Returns whether the condition was met.
+	bool wait_until(const std::function<bool()> &condition, ma_uint32 timeoutMs);
+}; // namespace internal
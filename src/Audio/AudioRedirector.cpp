@@ -1,58 +1,522 @@
 #include "AudioRedirector.hpp"
 #include <format>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <optional>
+#include <memory>
+#include <condition_variable>
 #include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <csignal>
+#include <cerrno>
+#include <charconv>
+#include <iterator>
+#include <bit>
+#include <algorithm>
 
 #include "MAConvert.hpp"
+#include "AudioInternal.hpp"
+#include "SpscRing.hpp"
+#include "JitterBuffer.hpp"
+#include "DriftEstimator.hpp"
+#include "FractionalResampler.hpp"
+#include "PolyphaseResampler.hpp"
+#include "ChannelMatrix.hpp"
+#include "RecordTap.hpp"
+#include "SampleConvert.hpp"
+#include "GainStage.hpp"
+#include "Limiter.hpp"
+#include "CallbackMonitor.hpp"
+#include "FlightRecorder.hpp"
+#include "VirtualBackend.hpp"
+#include "Log.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include "WinError.hpp"
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
 
 #define MINIAUDIO_IMPLEMENTATION
 
 namespace internal {
     namespace loopback {
-        ma_format format = ma_format_f32;   // Default format
-        ma_uint32 channels = 2;             // Default to stereo
+        ma_format format = ma_format_f32;   // Default format (loopback capture and ring)
+        ma_format playbackFormat = ma_format_f32;
+        ma_uint32 channels = 2;             // Default to stereo (loopback capture and ring)
+        ma_uint32 playbackChannels = 2;
+        std::vector<ChannelRoute> routing;  // Empty: by channel position
         ma_uint32 sampleRate = 48000;       // Default sample rate
+        ma_uint32 latencyMs = 50;           // Default target latency
+        PeriodConfig period;                // Backend default periods, low latency profile
+        bool autoFormat = false;            // Native formats of the devices in place of the above
+        ResamplerQuality resampler = ResamplerQuality::Medium;
+        std::mutex mutex;                   // Guards the settings above; only held to copy them
+
+        constexpr ma_uint32 chunkFrames = 1024; // Playback side processing block size
     };
 
     namespace duplex {
-        ma_format format = ma_format_f32;   // Default format
-        ma_uint32 channels = 2;             // Default to stereo
+        ma_format format = ma_format_f32;   // Default format (capture side)
+        ma_format playbackFormat = ma_format_f32;
+        ma_uint32 channels = 2;             // Default to stereo (capture side)
+        ma_uint32 playbackChannels = 2;
+        std::vector<ChannelRoute> routing;
         ma_uint32 sampleRate = 48000;       // Default sample rate
+        PeriodConfig period;
+        bool autoFormat = false;
+        ResamplerQuality resampler = ResamplerQuality::Medium;
+        std::mutex mutex;
+
+        constexpr ma_uint32 chunkFrames = 1024; // Gain processing block size
+    };
+
+    namespace limiter {
+        // Shared by both paths, so atomic rather than under either path's settings mutex
+        std::atomic<bool> enabled = false; // Opt-in: the lookahead adds latency and rules out the straight copy
+        std::atomic<ma_uint32> lookaheadMs = Limiter::DefaultLookaheadMs;
+        std::atomic<ma_uint32> releaseMs = Limiter::DefaultReleaseMs;
+    };
+
+    // Recordings of what the active loopback and duplex routes receive from their source.
+    namespace recording {
+        RecordTap loopbackTap;
+        RecordTap duplexTap;
+    };
+
+    namespace reconfigure {
+        constexpr ma_uint32 crossfadeMs = 20;      // Old and new route overlap this long
+        constexpr ma_uint32 startTimeoutMs = 2000; // For the new route's first audible frame
+    };
+
+    namespace recovery {
+        constexpr ma_uint32 stallPeriods = 8;     // Watchdog: playback callbacks missing this many periods
+        constexpr ma_uint32 minStallMs = 200;     // ... and at least this long is a stall
+        constexpr ma_uint32 pollMs = 5;           // Supervisor tick
+        constexpr ma_uint32 firstBackoffMs = 50;  // Delay before retrying a failed reopen, doubling
+        constexpr ma_uint32 maxBackoffMs = 2000;  // ... up to this
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool quit = false;
+    };
+
+    // Events from the data callbacks and the supervisor, which the supervisor thread decodes
+    // into the log; a route failure or a crash logs them at once.
+    namespace events {
+        constexpr ma_uint32 logIntervalMs = 1000;
+
+        FlightRecorder recorder;
+        std::atomic<ma_uint64> cursor = 0; // Next event to log
+        std::mutex mutex;                  // One reader at a time
+    };
+
+    // Everything the crash handler touches is set up by InstallCrashHandler(), so the handler
+    // itself neither allocates nor locks.
+    namespace crash {
+        constexpr int signals[] = {SIGSEGV, SIGILL, SIGFPE, SIGABRT};
+
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        void (*previous[std::size(signals)])(int) = {};
+        LPTOP_LEVEL_EXCEPTION_FILTER previousFilter = nullptr;
+#else
+        int file = -1;
+        struct sigaction previous[std::size(signals)] = {};
+#endif
+        std::atomic<bool> entered = false; // The first crash writes the events, later ones only chain
+        char line[256];
+    };
+
+    // When each side of a route switch was first heard and stopped being heard, recorded by the
+    // playback callback in pipeline time while armed (a switch is in progress). A callback's
+    // audio is taken to last from the callback until its frames have played out.
+    struct SwitchTimes {
+        std::atomic<bool> armed = false;
+        std::atomic<double> firstAudibleNs = 0.0;
+        std::atomic<double> audibleUntilNs = 0.0;
+
+        void Arm();
+        void Record(bool audible, ma_uint32 frameCount, ma_uint32 sampleRate); // Callback thread; a no-op unless armed
+    };
+
+    // Keeps one redirect path running. A device notification or the watchdog (no playback
+    // callback for stallPeriods) marks the active route lost; the supervisor thread then reopens
+    // it on the same devices, retrying with a doubling backoff while they stay unavailable. The
+    // mutex serializes everything that starts or stops the path's routes and is held across the
+    // device opens; the settings accessors never take it.
+    struct Supervisor {
+        explicit Supervisor(FlightRecorder::Source source) : source(source) {}
+
+        const FlightRecorder::Source source; // What its events are recorded as
+        std::mutex mutex;
+        std::atomic<bool> enabled = false; // A redirect was started and not stopped
+        std::atomic<double> lostNs = 0.0;  // Pipeline time a notification reported the route lost
+
+        // Supervisor thread, under the mutex
+        const void *watched = nullptr;     // Route the watchdog follows; a swap moves it
+        ma_uint64 lastCallbacks = 0;
+        double lastProgressNs = 0.0;
+        bool recovering = false;           // Down, reopening with backoff
+        bool reopened = false;             // Reopened, waiting for its first callback
+        double detectedNs = 0.0;
+        double nextAttemptNs = 0.0;
+        ma_uint32 backoffMs = 0;
+
+        // Published through GetStats()
+        std::atomic<ma_uint32> deviceLosses = 0;
+        std::atomic<ma_uint32> stalls = 0;
+        std::atomic<ma_uint32> reroutes = 0;
+        std::atomic<ma_uint32> recoveries = 0;
+        std::atomic<ma_uint32> failedAttempts = 0;
+        std::atomic<bool> down = false;
+        std::atomic<double> lastRecoveryMs = 0.0;
+        std::atomic<double> maxRecoveryMs = 0.0;
+
+        void Reset();
+        void Notify(ma_device_notification_type type); // Notification callback of the active route
+
+        // Whether the route should be reopened now, given its playback callback count, the
+        // pipeline time of its first callback (0 before), whether its devices run and their period.
+        bool Due(const void *route, ma_uint64 callbacks, double firstCallbackNs, bool running, double periodNs, double nowNs);
+        void Attempted(bool success, double nowNs);
+
+        RecoveryStats Snapshot() const;
+    };
+
+    // One running instance of the loopback path: both devices and the processing state between
+    // them, built from the settings at the time. A hot reconfiguration builds the next route
+    // beside the running one and crossfades over to it.
+    struct LoopbackRoute {
+        ma_device loopbackDevice = {};
+        ma_device playbackDevice = {};
+        std::optional<ma_device_id> loopbackId; // Empty for the default device
+        std::optional<ma_device_id> playbackId;
+
+        ma_format format = ma_format_f32;         // Settings latched when the route was built
+        ma_format playbackFormat = ma_format_f32;
+        ma_uint32 channels = 2;
+        ma_uint32 playbackChannels = 2;
+        ma_uint32 sampleRate = 48000;
+        bool negotiated = false;                  // Picked from the devices' native formats
+
+        SpscRing ringBuffer;
+        JitterBuffer jitterBuffer;
+        DriftEstimator driftEstimator;
+        FractionalResampler resampler;
+        ChannelMatrix routing;        // Loopback channels -> playback channels
+        std::vector<float> unrouted;  // f32 resampler output at the loopback channels, unless routing is the identity
+        std::vector<float> scratch;   // f32 staging between routing and playback device
+        GainStage gain;             // User volume
+        GainStage fade;             // Crossfade in and out of a reconfiguration
+        Limiter limiter;
+        bool limiterActive = false; // limiter::enabled, latched when the route was built
+        std::atomic<ma_uint64> framesPlayed = 0;
+        CallbackMonitor loopbackMonitor;
+        CallbackMonitor playbackMonitor;
+        SwitchTimes switchTimes;
+        std::atomic<double> firstCallbackNs = 0.0; // Pipeline time of the first playback callback
+        std::atomic<bool> closing = false;         // Being stopped on purpose; its stop notifications are ours
+        float recordedVolume = 1.0f;               // Playback callback: last volume recorded as an event
+        RouteConversions conversions = {};         // Published once running, under conversionsMutex
+    };
+
+    struct DuplexRoute {
+        ma_device device = {};
+        std::optional<ma_device_id> captureId;
+        std::optional<ma_device_id> playbackId;
+
+        ma_format format = ma_format_f32;         // Settings latched when the route was built
+        ma_format playbackFormat = ma_format_f32;
+        ma_uint32 channels = 2;
+        ma_uint32 playbackChannels = 2;
+        ma_uint32 sampleRate = 48000;
+        bool negotiated = false;
+
+        ChannelMatrix routing;        // Capture channels -> playback channels
+        std::vector<float> unrouted;  // f32 capture, unless routing is the identity
+        std::vector<float> scratch;   // f32 staging between duplex capture and playback
+        GainStage gain;
+        GainStage fade;
+        Limiter limiter;
+        bool limiterActive = false;
+        std::atomic<ma_uint64> framesPlayed = 0;
+        CallbackMonitor monitor;
+        SwitchTimes switchTimes;
+        std::atomic<double> firstCallbackNs = 0.0;
+        std::atomic<bool> closing = false;
+        float recordedVolume = 1.0f;
+        RouteConversions conversions = {};
+    };
+
+    // A route of an offline render, on a bare device the callbacks read it and the formats from.
+    struct OfflineRoute {
+        ma_device device = {};
+        std::unique_ptr<LoopbackRoute> loopback; // One of the two
+        std::unique_ptr<DuplexRoute> duplex;
     };
 
     ma_context context;
-    ma_device duplexDevice = {};
-    ma_device loopbackDevice = {};
-    ma_device playbackDevice = {};
-    ma_pcm_rb ringBuffer;
+
+    // The running route and the slot a reconfiguration builds the next one in.
+    LoopbackRoute loopbackRoutes[2];
+    DuplexRoute duplexRoutes[2];
+    std::atomic<LoopbackRoute*> loopbackRoute = &loopbackRoutes[0];
+    std::atomic<DuplexRoute*> duplexRoute = &duplexRoutes[0];
+
+    // Frames played by earlier routes of the same redirect, so the count carries across a swap.
+    std::atomic<ma_int64> loopbackFramesBase = 0;
+    std::atomic<ma_int64> duplexFramesBase = 0;
+
+    Supervisor loopbackSupervisor(FlightRecorder::Source::LoopbackRoute);
+    Supervisor duplexSupervisor(FlightRecorder::Source::DuplexRoute);
+
+    // The routes' conversions snapshots. The getters poll them from the UI thread while the
+    // supervisor re-inits the devices they describe, so they never read the devices themselves.
+    std::mutex conversionsMutex;
 
     // ------------------------------------------------------------------------
     // Internal helpers
     // ------------------------------------------------------------------------
 
-    ma_result init_loopback_device(const ma_device_id *id);
-    ma_result init_playback_device(const ma_device_id *id);
-    ma_result init_duplex_device(const ma_device_id *inputId, const ma_device_id *playbackId);
-
-    void data_callback_loopback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
-    void data_callback_playback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
-    void data_callback_duplex(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+    StreamFormat negotiate_format(
+        ma_device_type sourceType, const std::optional<ma_device_id> &sourceId,
+        const std::optional<ma_device_id> &playbackId, const StreamFormat &settings
+    );
+    void latch_loopback_format(LoopbackRoute &route);
+    void latch_duplex_format(DuplexRoute &route);
+    StreamConversion stream_conversion(const ma_device &device, ma_device_type side);
+    void publish_conversions(LoopbackRoute &route);
+    void publish_conversions(DuplexRoute &route);
+
+    ma_result init_loopback_device(LoopbackRoute &route);
+    ma_result init_playback_device(LoopbackRoute &route);
+    ma_result init_duplex_device(DuplexRoute &route);
+
+    ma_result init_loopback_pipeline(LoopbackRoute &route);
+    void uninit_loopback_pipeline(LoopbackRoute &route);
+    void init_duplex_pipeline(DuplexRoute &route);
+
+    ResultVoid start_loopback_route(LoopbackRoute &route);
+    ResultVoid stop_loopback_route(LoopbackRoute &route);
+    ResultVoid start_duplex_route(DuplexRoute &route);
+    ResultVoid stop_duplex_route(DuplexRoute &route);
+
+    Result<SwitchReport, Error> swap_loopback_route(const std::optional<ma_device_id> &playbackId);
+    Result<SwitchReport, Error> swap_duplex_route(const std::optional<ma_device_id> &playbackId);
+    SwitchReport make_switch_report(double startNs, double readyNs, const SwitchTimes &outgoing, const SwitchTimes &incoming);
+    double pipeline_time_ns();
+
+    void start_supervisor();
+    void stop_supervisor();
+    void supervise_loopback();
+    void supervise_duplex();
+    void notification_callback_loopback(const ma_device_notification *pNotification);
+    void notification_callback_duplex(const ma_device_notification *pNotification);
+
+    void log_events(const char *failure);
+    void log_events_on_crash(const char *cause);
+    void write_crash(const char *text, size_t length);
+    void write_crash(const char *text);
+    ResultVoid install_crash_handler(const std::string &path);
+    void record_volume(FlightRecorder *recorder, float &recorded, float volume, FlightRecorder::Source source);
+
+    bool is_running(ma_device *device);
+    LoopbackRoute &route_of(LoopbackRoute *route);
+
+    ma_uint32 render_playback_chunk(LoopbackRoute &route, float* pOutput, ma_uint32 frameCount);
 };
 
 // ============================================================================
 // Public API accessors
 // ============================================================================
 
-ma_format AudioRedirector::GetLoopbackFormat() { return internal::loopback::format; }
-ma_uint32 AudioRedirector::GetLoopbackSampleRate() { return internal::loopback::sampleRate; }
+// The path settings are copied under the path's settings mutex as a route is built, by the
+// Start, Reconfigure and Switch functions and by the supervisor's reopens. That mutex is only
+// ever held for the copy, never across a device open, so the accessors do not wait on one.
 
-void AudioRedirector::SetLoopbackFormat(ma_format format) { internal::loopback::format = format; }
-void AudioRedirector::SetLoopbackSampleRate(ma_uint32 sampleRate) { internal::loopback::sampleRate = sampleRate; }
+ma_format AudioRedirector::GetLoopbackFormat() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::format;
+}
+ma_format AudioRedirector::GetLoopbackPlaybackFormat() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::playbackFormat;
+}
+ma_uint32 AudioRedirector::GetLoopbackSampleRate() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::sampleRate;
+}
+
+void AudioRedirector::SetLoopbackFormat(ma_format format) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::format = internal::loopback::playbackFormat = format;
+}
+void AudioRedirector::SetLoopbackPlaybackFormat(ma_format format) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::playbackFormat = format;
+}
+void AudioRedirector::SetLoopbackSampleRate(ma_uint32 sampleRate) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::sampleRate = sampleRate;
+}
+
+ma_uint32 AudioRedirector::GetLoopbackChannels() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::channels;
+}
+ma_uint32 AudioRedirector::GetLoopbackPlaybackChannels() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::playbackChannels;
+}
+
+void AudioRedirector::SetLoopbackChannels(ma_uint32 channels) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::channels = internal::loopback::playbackChannels = std::clamp<ma_uint32>(channels, 1, MaxChannels);
+}
+void AudioRedirector::SetLoopbackPlaybackChannels(ma_uint32 channels) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::playbackChannels = std::clamp<ma_uint32>(channels, 1, MaxChannels);
+}
+
+void AudioRedirector::SetLoopbackRouting(const std::vector<ChannelRoute> &routes) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::routing = routes;
+}
+std::vector<ChannelRoute> AudioRedirector::GetLoopbackRouting() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::routing;
+}
 
-ma_format AudioRedirector::GetDuplexFormat() { return internal::duplex::format; }
-ma_uint32 AudioRedirector::GetDuplexSampleRate() { return internal::duplex::sampleRate; }
+void AudioRedirector::SetLoopbackAutoFormat(bool enabled) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::autoFormat = enabled;
+}
+bool AudioRedirector::IsLoopbackAutoFormat() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::autoFormat;
+}
+
+ma_uint32 AudioRedirector::GetLoopbackLatency() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::latencyMs;
+}
+ma_uint32 AudioRedirector::GetLoopbackEffectiveLatency() { return internal::loopbackRoute.load()->jitterBuffer.GetCurrentLatency(); }
+
+double AudioRedirector::GetLoopbackDriftPpm() { return internal::loopbackRoute.load()->driftEstimator.GetDriftPpm(); }
+
+void AudioRedirector::SetLoopbackLatency(ma_uint32 latencyMs) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::latencyMs = latencyMs;
+    for (internal::LoopbackRoute &route : internal::loopbackRoutes) {
+        route.jitterBuffer.SetTargetLatency(latencyMs); // Applies to a running redirect as well
+    }
+}
 
-void AudioRedirector::SetDuplexFormat(ma_format format) { internal::duplex::format = format; }
-void AudioRedirector::SetDuplexSampleRate(ma_uint32 sampleRate) { internal::loopback::sampleRate = sampleRate; }
+ma_format AudioRedirector::GetDuplexFormat() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::format;
+}
+ma_format AudioRedirector::GetDuplexPlaybackFormat() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::playbackFormat;
+}
+ma_uint32 AudioRedirector::GetDuplexSampleRate() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::sampleRate;
+}
+
+void AudioRedirector::SetDuplexFormat(ma_format format) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::format = internal::duplex::playbackFormat = format;
+}
+void AudioRedirector::SetDuplexPlaybackFormat(ma_format format) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::playbackFormat = format;
+}
+void AudioRedirector::SetDuplexSampleRate(ma_uint32 sampleRate) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::sampleRate = sampleRate;
+}
+
+ma_uint32 AudioRedirector::GetDuplexChannels() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::channels;
+}
+ma_uint32 AudioRedirector::GetDuplexPlaybackChannels() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::playbackChannels;
+}
+
+void AudioRedirector::SetDuplexChannels(ma_uint32 channels) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::channels = internal::duplex::playbackChannels = std::clamp<ma_uint32>(channels, 1, MaxChannels);
+}
+void AudioRedirector::SetDuplexPlaybackChannels(ma_uint32 channels) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::playbackChannels = std::clamp<ma_uint32>(channels, 1, MaxChannels);
+}
+
+void AudioRedirector::SetDuplexRouting(const std::vector<ChannelRoute> &routes) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::routing = routes;
+}
+std::vector<ChannelRoute> AudioRedirector::GetDuplexRouting() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::routing;
+}
+
+void AudioRedirector::SetDuplexAutoFormat(bool enabled) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::autoFormat = enabled;
+}
+bool AudioRedirector::IsDuplexAutoFormat() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::autoFormat;
+}
+
+void AudioRedirector::SetLoopbackPeriodConfig(const PeriodConfig &config) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::period = config;
+}
+PeriodConfig AudioRedirector::GetLoopbackPeriodConfig() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::period;
+}
+void AudioRedirector::SetDuplexPeriodConfig(const PeriodConfig &config) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::period = config;
+}
+PeriodConfig AudioRedirector::GetDuplexPeriodConfig() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::period;
+}
+
+void AudioRedirector::SetLoopbackResampler(ResamplerQuality quality) {
+    std::lock_guard lock(internal::loopback::mutex);
+    internal::loopback::resampler = quality;
+}
+ResamplerQuality AudioRedirector::GetLoopbackResampler() {
+    std::lock_guard lock(internal::loopback::mutex);
+    return internal::loopback::resampler;
+}
+void AudioRedirector::SetDuplexResampler(ResamplerQuality quality) {
+    std::lock_guard lock(internal::duplex::mutex);
+    internal::duplex::resampler = quality;
+}
+ResamplerQuality AudioRedirector::GetDuplexResampler() {
+    std::lock_guard lock(internal::duplex::mutex);
+    return internal::duplex::resampler;
+}
 
 Result<AudioDevices, Error> AudioRedirector::GetAudioDevices() { 
     AudioDevices devices = { nullptr, 0, nullptr, 0 };
@@ -73,40 +537,125 @@ Result<AudioDevices, Error> AudioRedirector::GetAudioDevices() {
     return devices;
 }
 
-Result<float, Error> AudioRedirector::GetPlaybackVolume() {
-    float volume = 0.0f;
-    ma_result result = ma_device_get_master_volume(
-        &internal::playbackDevice, &volume
-    );
-    if (result != MA_SUCCESS) {
-        return Error(std::format(
-            "Failed to get playback device volume ({}).",
-            ma::convert::to_string(result)
-        ));
+const ma_context *AudioRedirector::GetContext() { return &internal::context; }
+
+std::string AudioRedirector::GetDeviceIdString(const ma_device_id &id) {
+    switch (internal::context.backend) {
+        case ma_backend_wasapi: {
+            // Endpoint IDs are plain ASCII ({0.0.0.00000000}.{guid}), stored as UTF-16.
+            std::string str;
+            for (const ma_wchar_win32 *p = id.wasapi; *p != 0 && p < id.wasapi + 64; ++p) {
+                str.push_back(*p < 0x80 ? static_cast<char>(*p) : '?');
+            }
+            return str;
+        }
+        case ma_backend_coreaudio: return std::string(id.coreaudio, strnlen(id.coreaudio, sizeof(id.coreaudio)));
+        case ma_backend_pulseaudio: return std::string(id.pulse, strnlen(id.pulse, sizeof(id.pulse)));
+        case ma_backend_alsa: return std::string(id.alsa, strnlen(id.alsa, sizeof(id.alsa)));
+        case ma_backend_winmm: return std::to_string(id.winmm);
+        case ma_backend_jack: return std::to_string(id.jack);
+        case ma_backend_custom: return std::string(id.custom.s, strnlen(id.custom.s, sizeof(id.custom.s))); // VirtualBackend endpoint name
+        default: return std::to_string(id.nullbackend);
     }
-    return volume;
+}
+
+ma_uint64 AudioRedirector::GetLoopbackFramesPlayed() {
+    return internal::loopbackFramesBase.load(std::memory_order_relaxed) +
+        internal::loopbackRoute.load()->framesPlayed.load(std::memory_order_relaxed);
+}
+
+ma_uint64 AudioRedirector::GetDuplexFramesPlayed() {
+    return internal::duplexFramesBase.load(std::memory_order_relaxed) +
+        internal::duplexRoute.load()->framesPlayed.load(std::memory_order_relaxed);
+}
+
+// Volume is applied by a gain stage inside the data callbacks, so setting it is a single
+// atomic store and works whether or not a redirect is running. Both route slots get it, so
+// a route built by a reconfiguration starts at the current volume.
+
+Result<float, Error> AudioRedirector::GetPlaybackVolume() {
+    return internal::loopbackRoute.load()->gain.GetTarget();
 }
 
 ma_result AudioRedirector::SetPlaybackVolume(float volume) {
-    return ma_device_set_master_volume(&internal::playbackDevice, volume);
+    if (volume < 0.0f) return MA_INVALID_ARGS;
+    for (internal::LoopbackRoute &route : internal::loopbackRoutes) route.gain.SetTarget(volume);
+    return MA_SUCCESS;
 }
 
 Result<float, Error> AudioRedirector::GetDuplexVolume() {
-    float volume = 0.0f;
-    ma_result result = ma_device_get_master_volume(
-        &internal::duplexDevice, &volume
-    );
-    if (result != MA_SUCCESS) {
-        return Error(std::format(
-            "Failed to get duplex device volume ({}).",
-            ma::convert::to_string(result)
-        ));
-    }
-    return volume;
+    return internal::duplexRoute.load()->gain.GetTarget();
 }
 
 ma_result AudioRedirector::SetDuplexVolume(float volume) {
-    return ma_device_set_master_volume(&internal::duplexDevice, volume);
+    if (volume < 0.0f) return MA_INVALID_ARGS;
+    for (internal::DuplexRoute &route : internal::duplexRoutes) route.gain.SetTarget(volume);
+    return MA_SUCCESS;
+}
+
+void AudioRedirector::SetLimiterEnabled(bool enabled) { internal::limiter::enabled = enabled; }
+bool AudioRedirector::IsLimiterEnabled() { return internal::limiter::enabled; }
+
+void AudioRedirector::SetLimiterLookahead(ma_uint32 lookaheadMs) {
+    internal::limiter::lookaheadMs = std::clamp(lookaheadMs, Limiter::MinLookaheadMs, Limiter::MaxLookaheadMs);
+}
+ma_uint32 AudioRedirector::GetLimiterLookahead() { return internal::limiter::lookaheadMs; }
+
+void AudioRedirector::SetLimiterRelease(ma_uint32 releaseMs) {
+    internal::limiter::releaseMs = releaseMs;
+    for (internal::LoopbackRoute &route : internal::loopbackRoutes) {
+        route.limiter.SetRelease(releaseMs); // Applies to a running redirect as well
+    }
+    for (internal::DuplexRoute &route : internal::duplexRoutes) {
+        route.limiter.SetRelease(releaseMs);
+    }
+}
+ma_uint32 AudioRedirector::GetLimiterRelease() { return internal::limiter::releaseMs; }
+
+LimiterStats AudioRedirector::GetPlaybackLimiterStats() {
+    const internal::LoopbackRoute &route = *internal::loopbackRoute.load();
+    if (!route.limiterActive) return LimiterStats{0.0, 0.0f};
+    return LimiterStats{
+        1000.0 * route.limiter.GetLatencyFrames() / route.sampleRate,
+        route.limiter.GetGainReductionDb()
+    };
+}
+
+LimiterStats AudioRedirector::GetDuplexLimiterStats() {
+    const internal::DuplexRoute &route = *internal::duplexRoute.load();
+    if (!route.limiterActive) return LimiterStats{0.0, 0.0f};
+    return LimiterStats{
+        1000.0 * route.limiter.GetLatencyFrames() / route.sampleRate,
+        route.limiter.GetGainReductionDb()
+    };
+}
+
+RouteConversions AudioRedirector::GetLoopbackConversions() {
+    std::lock_guard lock(internal::conversionsMutex);
+    return internal::loopbackRoute.load()->conversions;
+}
+
+RouteConversions AudioRedirector::GetDuplexConversions() {
+    std::lock_guard lock(internal::conversionsMutex);
+    return internal::duplexRoute.load()->conversions;
+}
+
+RedirectorStats AudioRedirector::GetStats() {
+    const internal::LoopbackRoute &loopback = *internal::loopbackRoute.load();
+    const internal::DuplexRoute &duplex = *internal::duplexRoute.load();
+    RedirectorStats stats = {
+        loopback.loopbackMonitor.Snapshot(),
+        loopback.playbackMonitor.Snapshot(),
+        duplex.monitor.Snapshot(),
+        internal::loopbackSupervisor.Snapshot(),
+        internal::duplexSupervisor.Snapshot()
+    };
+
+    // Zero while stopped: an uninitialized device is cleared.
+    stats.loopbackCapture.periodFrames = loopback.loopbackDevice.capture.internalPeriodSizeInFrames;
+    stats.loopbackPlayback.periodFrames = loopback.playbackDevice.playback.internalPeriodSizeInFrames;
+    stats.duplex.periodFrames = duplex.device.playback.internalPeriodSizeInFrames;
+    return stats;
 }
 
 // ============================================================================
@@ -116,7 +665,12 @@ ma_result AudioRedirector::SetDuplexVolume(float volume) {
 
 ResultVoid AudioRedirector::Initialize()
 {
-    ma_result result = ma_context_init(nullptr, 0, nullptr, &internal::context);
+    return Initialize(nullptr, 0, nullptr);
+}
+
+ResultVoid AudioRedirector::Initialize(const ma_backend *backends, ma_uint32 backendCount, const ma_context_config *config)
+{
+    ma_result result = ma_context_init(backends, backendCount, config, &internal::context);
 
     if (result != MA_SUCCESS) {
         return Error(std::format(
@@ -125,6 +679,7 @@ ResultVoid AudioRedirector::Initialize()
         ));
     }
 
+    internal::start_supervisor();
     return std::monostate{};
 }
 
@@ -132,6 +687,9 @@ ResultVoid AudioRedirector::Uninitialize()
 {
     StopLoopbackRedirect(); // Ensure devices are stopped and uninitialized
     StopDuplexRedirect();
+    StopFanOutRedirect();
+    StopMixerRedirect();
+    internal::stop_supervisor();
 
     ma_result result = ma_context_uninit(&internal::context);
     if (result != MA_SUCCESS) {
@@ -144,9 +702,718 @@ ResultVoid AudioRedirector::Uninitialize()
     return std::monostate{};
 }
 
+ResultVoid AudioRedirector::InstallCrashHandler(const std::string &path)
+{
+    return internal::install_crash_handler(path);
+}
+
 ResultVoid AudioRedirector::StartLoopbackRedirect(const ma_device_id *loopbackId, const ma_device_id *playbackId)
 {
-    ma_result result = internal::init_loopback_device(loopbackId);
+    std::lock_guard lock(internal::loopbackSupervisor.mutex);
+    internal::LoopbackRoute &route = *internal::loopbackRoute.load();
+
+    route.loopbackId = loopbackId ? std::optional(*loopbackId) : std::nullopt;
+    route.playbackId = playbackId ? std::optional(*playbackId) : std::nullopt;
+    route.fade.SetTarget(1.0f); // Audible from the first frame
+
+    internal::loopbackFramesBase.store(0, std::memory_order_relaxed);
+
+    ResultVoid result = internal::start_loopback_route(route);
+    if (!result) return result;
+
+    internal::loopbackSupervisor.Reset();
+    internal::loopbackSupervisor.enabled.store(true);
+    return result;
+}
+
+ResultVoid AudioRedirector::StopLoopbackRedirect()
+{
+    internal::loopbackSupervisor.enabled.store(false); // No recovery from here on
+    std::lock_guard lock(internal::loopbackSupervisor.mutex);
+    internal::recording::loopbackTap.Stop();
+
+    // A failed reconfiguration leaves nothing behind, but stop both slots to be safe.
+    for (internal::LoopbackRoute &route : internal::loopbackRoutes) {
+        ResultVoid result = internal::stop_loopback_route(route);
+        if (!result) return result;
+    }
+
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::StartDuplexRedirect(const ma_device_id *captureId, const ma_device_id *playbackId)
+{
+    std::lock_guard lock(internal::duplexSupervisor.mutex);
+    internal::DuplexRoute &route = *internal::duplexRoute.load();
+
+    ResultVoid result = internal::stop_duplex_route(route);
+    if (!result) return result;
+
+    route.captureId = captureId ? std::optional(*captureId) : std::nullopt;
+    route.playbackId = playbackId ? std::optional(*playbackId) : std::nullopt;
+    route.fade.SetTarget(1.0f);
+
+    internal::duplexFramesBase.store(0, std::memory_order_relaxed);
+
+    result = internal::start_duplex_route(route);
+    if (!result) return result;
+
+    internal::duplexSupervisor.Reset();
+    internal::duplexSupervisor.enabled.store(true);
+    return result;
+}
+
+ResultVoid AudioRedirector::StopDuplexRedirect()
+{
+    internal::duplexSupervisor.enabled.store(false);
+    std::lock_guard lock(internal::duplexSupervisor.mutex);
+    internal::recording::duplexTap.Stop();
+
+    for (internal::DuplexRoute &route : internal::duplexRoutes) {
+        ResultVoid result = internal::stop_duplex_route(route);
+        if (!result) return result;
+    }
+
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::StartLoopbackRecording(const std::string &path)
+{
+    std::lock_guard lock(internal::loopbackSupervisor.mutex);
+    if (!internal::loopbackSupervisor.enabled.load()) return Error("Start the loopback redirect before recording it.");
+
+    const internal::LoopbackRoute &route = *internal::loopbackRoute.load();
+    ma_result result = internal::recording::loopbackTap.Start(path.c_str(), route.format, route.channels, route.sampleRate);
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to start recording to '{}' ({}).", path, ma::convert::to_string(result)));
+    }
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::StopLoopbackRecording()
+{
+    std::lock_guard lock(internal::loopbackSupervisor.mutex);
+    ma_result result = internal::recording::loopbackTap.Stop();
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to write the recording ({}).", ma::convert::to_string(result)));
+    }
+    return std::monostate{};
+}
+
+RecordingStats AudioRedirector::GetLoopbackRecordingStats() { return internal::recording::loopbackTap.GetStats(); }
+
+ResultVoid AudioRedirector::StartDuplexRecording(const std::string &path)
+{
+    std::lock_guard lock(internal::duplexSupervisor.mutex);
+    if (!internal::duplexSupervisor.enabled.load()) return Error("Start the duplex redirect before recording it.");
+
+    const internal::DuplexRoute &route = *internal::duplexRoute.load();
+    ma_result result = internal::recording::duplexTap.Start(path.c_str(), route.format, route.channels, route.sampleRate);
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to start recording to '{}' ({}).", path, ma::convert::to_string(result)));
+    }
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::StopDuplexRecording()
+{
+    std::lock_guard lock(internal::duplexSupervisor.mutex);
+    ma_result result = internal::recording::duplexTap.Stop();
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to write the recording ({}).", ma::convert::to_string(result)));
+    }
+    return std::monostate{};
+}
+
+RecordingStats AudioRedirector::GetDuplexRecordingStats() { return internal::recording::duplexTap.GetStats(); }
+
+ResultVoid AudioRedirector::ReconfigureLoopbackRedirect()
+{
+    std::lock_guard lock(internal::loopbackSupervisor.mutex);
+    auto report = internal::swap_loopback_route(internal::loopbackRoute.load()->playbackId);
+    if (!report) return report.error();
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::ReconfigureDuplexRedirect()
+{
+    std::lock_guard lock(internal::duplexSupervisor.mutex);
+    auto report = internal::swap_duplex_route(internal::duplexRoute.load()->playbackId);
+    if (!report) return report.error();
+    return std::monostate{};
+}
+
+Result<SwitchReport, Error> AudioRedirector::SwitchLoopbackOutput(const ma_device_id *playbackId)
+{
+    std::lock_guard lock(internal::loopbackSupervisor.mutex);
+    return internal::swap_loopback_route(playbackId ? std::optional(*playbackId) : std::nullopt);
+}
+
+Result<SwitchReport, Error> AudioRedirector::SwitchDuplexOutput(const ma_device_id *playbackId)
+{
+    std::lock_guard lock(internal::duplexSupervisor.mutex);
+    return internal::swap_duplex_route(playbackId ? std::optional(*playbackId) : std::nullopt);
+}
+
+// Make-before-break: the next route is built and started in the spare slot while the running
+// one keeps playing; once it plays audio, the two crossfade and the old route is torn down.
+Result<SwitchReport, Error> internal::swap_loopback_route(const std::optional<ma_device_id> &playbackId)
+{
+    LoopbackRoute &current = *loopbackRoute.load();
+    LoopbackRoute &next = &current == &loopbackRoutes[0] ? loopbackRoutes[1] : loopbackRoutes[0];
+
+    if (!is_running(&current.playbackDevice)) {
+        return Error("No loopback redirect is running.");
+    }
+
+    const double startNs = pipeline_time_ns();
+
+    next.loopbackId = current.loopbackId;
+    next.playbackId = playbackId;
+    next.fade.SetTarget(0.0f); // Silent until the crossfade
+
+    ResultVoid result = start_loopback_route(next);
+    if (!result) return result.error();
+
+    // The new route pre-rolls its jitter buffer before it has anything to play.
+    const bool flowing = wait_until([&]() {
+        return next.framesPlayed.load(std::memory_order_relaxed) > 0;
+    }, reconfigure::startTimeoutMs + AudioRedirector::GetLoopbackLatency());
+
+    if (!flowing) {
+        stop_loopback_route(next);
+        return Error("The new loopback route produced no audio; kept the running one.");
+    }
+
+    const double readyNs = pipeline_time_ns();
+    current.switchTimes.Arm();
+    next.switchTimes.Arm();
+
+    // Both fades start at their device's next callback; the counters continue from the old route.
+    next.fade.SetTarget(1.0f);
+    current.fade.SetTarget(0.0f);
+    loopbackFramesBase.fetch_add(
+        (ma_int64)current.framesPlayed.load(std::memory_order_relaxed) - (ma_int64)next.framesPlayed.load(std::memory_order_relaxed),
+        std::memory_order_relaxed
+    );
+    loopbackRoute.store(&next);
+
+    wait_until([&]() {
+        return current.fade.GetCurrent() == 0.0f && next.fade.GetCurrent() == 1.0f;
+    }, reconfigure::crossfadeMs + 500);
+
+    const SwitchReport report = make_switch_report(startNs, readyNs, current.switchTimes, next.switchTimes);
+    result = stop_loopback_route(current);
+    if (!result) return result.error();
+    return report;
+}
+
+Result<SwitchReport, Error> internal::swap_duplex_route(const std::optional<ma_device_id> &playbackId)
+{
+    DuplexRoute &current = *duplexRoute.load();
+    DuplexRoute &next = &current == &duplexRoutes[0] ? duplexRoutes[1] : duplexRoutes[0];
+
+    if (!is_running(&current.device)) {
+        return Error("No duplex redirect is running.");
+    }
+
+    const double startNs = pipeline_time_ns();
+
+    next.captureId = current.captureId;
+    next.playbackId = playbackId;
+    next.fade.SetTarget(0.0f);
+
+    ResultVoid result = start_duplex_route(next);
+    if (!result) return result.error();
+
+    const bool flowing = wait_until([&]() {
+        return next.framesPlayed.load(std::memory_order_relaxed) > 0;
+    }, reconfigure::startTimeoutMs);
+
+    if (!flowing) {
+        stop_duplex_route(next);
+        return Error("The new duplex route produced no audio; kept the running one.");
+    }
+
+    const double readyNs = pipeline_time_ns();
+    current.switchTimes.Arm();
+    next.switchTimes.Arm();
+
+    next.fade.SetTarget(1.0f);
+    current.fade.SetTarget(0.0f);
+    duplexFramesBase.fetch_add(
+        (ma_int64)current.framesPlayed.load(std::memory_order_relaxed) - (ma_int64)next.framesPlayed.load(std::memory_order_relaxed),
+        std::memory_order_relaxed
+    );
+    duplexRoute.store(&next);
+
+    wait_until([&]() {
+        return current.fade.GetCurrent() == 0.0f && next.fade.GetCurrent() == 1.0f;
+    }, reconfigure::crossfadeMs + 500);
+
+    const SwitchReport report = make_switch_report(startNs, readyNs, current.switchTimes, next.switchTimes);
+    result = stop_duplex_route(current);
+    if (!result) return result.error();
+    return report;
+}
+
+SwitchReport internal::make_switch_report(double startNs, double readyNs, const SwitchTimes &outgoing, const SwitchTimes &incoming)
+{
+    // Positive when the new route was heard before the old one went quiet.
+    const double overlapNs = outgoing.audibleUntilNs.load(std::memory_order_relaxed) - incoming.firstAudibleNs.load(std::memory_order_relaxed);
+
+    SwitchReport report = {};
+    report.prepareMs = (readyNs - startNs) / 1e6;
+    report.crossfadeMs = reconfigure::crossfadeMs;
+    report.overlapMs = std::max(overlapNs, 0.0) / 1e6;
+    report.gapMs = std::max(-overlapNs, 0.0) / 1e6;
+    return report;
+}
+
+// Callback time: the virtual clock under VirtualBackend (which runs faster than real time), else the wall clock.
+double internal::pipeline_time_ns()
+{
+    if (VirtualBackend::IsActive(&internal::context)) {
+        return VirtualBackend::GetTimeSeconds(&internal::context) * 1e9;
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void internal::SwitchTimes::Arm()
+{
+    firstAudibleNs.store(0.0, std::memory_order_relaxed);
+    audibleUntilNs.store(0.0, std::memory_order_relaxed);
+    armed.store(true, std::memory_order_release);
+}
+
+void internal::SwitchTimes::Record(bool audible, ma_uint32 frameCount, ma_uint32 sampleRate)
+{
+    if (!audible || !armed.load(std::memory_order_acquire)) return;
+
+    const double now = pipeline_time_ns();
+    if (firstAudibleNs.load(std::memory_order_relaxed) == 0.0) firstAudibleNs.store(now, std::memory_order_relaxed);
+    audibleUntilNs.store(now + 1e9 * frameCount / sampleRate, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Recovery
+// ============================================================================
+
+void internal::start_supervisor()
+{
+    recovery::quit = false;
+    recovery::thread = std::thread([]() {
+        auto logged = std::chrono::steady_clock::now();
+
+        std::unique_lock lock(recovery::mutex);
+        while (!recovery::wake.wait_for(lock, std::chrono::milliseconds(recovery::pollMs), []() { return recovery::quit; })) {
+            lock.unlock();
+            supervise_loopback();
+            supervise_duplex();
+
+            if (std::chrono::steady_clock::now() - logged >= std::chrono::milliseconds(events::logIntervalMs)) {
+                log_events(nullptr);
+                logged = std::chrono::steady_clock::now();
+            }
+            lock.lock();
+        }
+    });
+}
+
+void internal::stop_supervisor()
+{
+    if (!recovery::thread.joinable()) return;
+    {
+        std::lock_guard lock(recovery::mutex);
+        recovery::quit = true;
+    }
+    recovery::wake.notify_all();
+    recovery::thread.join();
+
+    log_events(nullptr); // The rest, up to the last stop
+}
+
+void internal::supervise_loopback()
+{
+    Supervisor &supervisor = loopbackSupervisor;
+    std::lock_guard lock(supervisor.mutex);
+    if (!supervisor.enabled.load()) return;
+
+    LoopbackRoute &route = *loopbackRoute.load();
+    const ma_device &playback = route.playbackDevice;
+    const double periodNs = 1e9 * playback.playback.internalPeriodSizeInFrames / std::max(playback.playback.internalSampleRate, 1u);
+    const double now = pipeline_time_ns();
+    const bool wasRecovering = supervisor.recovering;
+
+    if (!supervisor.Due(
+        &route, route.playbackMonitor.GetCallbacks(), route.firstCallbackNs.load(std::memory_order_relaxed),
+        is_running(&route.loopbackDevice) && is_running(&route.playbackDevice), periodNs, now
+    )) {
+        return;
+    }
+    if (!wasRecovering) log_events("loopback route failed");
+
+    // Reopen in the same slot; the frame count carries on from what the lost route played.
+    stop_loopback_route(route);
+    loopbackFramesBase.fetch_add((ma_int64)route.framesPlayed.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    route.fade.SetTarget(1.0f);
+
+    supervisor.Attempted((bool)start_loopback_route(route), now);
+}
+
+void internal::supervise_duplex()
+{
+    Supervisor &supervisor = duplexSupervisor;
+    std::lock_guard lock(supervisor.mutex);
+    if (!supervisor.enabled.load()) return;
+
+    DuplexRoute &route = *duplexRoute.load();
+    const ma_device &device = route.device;
+    const double periodNs = 1e9 * device.playback.internalPeriodSizeInFrames / std::max(device.playback.internalSampleRate, 1u);
+    const double now = pipeline_time_ns();
+    const bool wasRecovering = supervisor.recovering;
+
+    if (!supervisor.Due(
+        &route, route.monitor.GetCallbacks(), route.firstCallbackNs.load(std::memory_order_relaxed),
+        is_running(&route.device), periodNs, now
+    )) {
+        return;
+    }
+    if (!wasRecovering) log_events("duplex route failed");
+
+    stop_duplex_route(route);
+    duplexFramesBase.fetch_add((ma_int64)route.framesPlayed.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    route.fade.SetTarget(1.0f);
+
+    supervisor.Attempted((bool)start_duplex_route(route), now);
+}
+
+// Notifications of a route being stopped on purpose, or of the spare slot, are not losses.
+void internal::notification_callback_loopback(const ma_device_notification *pNotification)
+{
+    const LoopbackRoute *route = (const LoopbackRoute*)pNotification->pDevice->pUserData;
+    if (route != loopbackRoute.load() || route->closing.load()) return;
+    loopbackSupervisor.Notify(pNotification->type);
+}
+
+void internal::notification_callback_duplex(const ma_device_notification *pNotification)
+{
+    const DuplexRoute *route = (const DuplexRoute*)pNotification->pDevice->pUserData;
+    if (route != duplexRoute.load() || route->closing.load()) return;
+    duplexSupervisor.Notify(pNotification->type);
+}
+
+void internal::Supervisor::Reset()
+{
+    lostNs.store(0.0);
+    watched = nullptr;
+    recovering = reopened = false;
+    backoffMs = 0;
+
+    for (std::atomic<ma_uint32> *counter : {&deviceLosses, &stalls, &reroutes, &recoveries, &failedAttempts}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    down.store(false, std::memory_order_relaxed);
+    lastRecoveryMs.store(0.0, std::memory_order_relaxed);
+    maxRecoveryMs.store(0.0, std::memory_order_relaxed);
+}
+
+void internal::Supervisor::Notify(ma_device_notification_type type)
+{
+    if (!enabled.load()) return;
+
+    switch (type) {
+        case ma_device_notification_type_stopped:
+        case ma_device_notification_type_interruption_began: {
+            // Only the first report of a loss counts; the backoff retries pick the route up
+            // again once an interruption has ended.
+            double expected = 0.0;
+            lostNs.compare_exchange_strong(expected, pipeline_time_ns());
+            break;
+        }
+        case ma_device_notification_type_rerouted:
+            // The backend already moved the stream to the new default device.
+            reroutes.fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            break;
+    }
+}
+
+bool internal::Supervisor::Due(const void *route, ma_uint64 callbacks, double firstCallbackNs, bool running, double periodNs, double nowNs)
+{
+    if (route != watched) {
+        // First tick of this redirect, or a swap moved it to the other slot.
+        watched = route;
+        lastCallbacks = callbacks;
+        lastProgressNs = nowNs;
+    }
+
+    if (reopened && firstCallbackNs > 0.0) {
+        const double recoveryMs = std::max(firstCallbackNs - detectedNs, 0.0) / 1e6;
+        recoveries.fetch_add(1, std::memory_order_relaxed);
+        lastRecoveryMs.store(recoveryMs, std::memory_order_relaxed);
+        maxRecoveryMs.store(std::max(maxRecoveryMs.load(std::memory_order_relaxed), recoveryMs), std::memory_order_relaxed);
+        events::recorder.Record(FlightRecorder::Event::Recovered, source, (ma_uint32)(recoveryMs * 1000.0));
+        down.store(false, std::memory_order_relaxed);
+        reopened = false;
+        backoffMs = 0;
+    }
+
+    if (!recovering) {
+        if (callbacks != lastCallbacks) {
+            lastCallbacks = callbacks;
+            lastProgressNs = nowNs;
+        }
+
+        const double stallNs = std::max(recovery::stallPeriods * periodNs, recovery::minStallMs * 1e6);
+        const double lost = lostNs.exchange(0.0);
+        double detected = nowNs;
+
+        if (lost > 0.0 || !running) {
+            // Not every backend notifies, so a device found stopped counts as lost too.
+            deviceLosses.fetch_add(1, std::memory_order_relaxed);
+            events::recorder.Record(FlightRecorder::Event::DeviceLost, source);
+            if (lost > 0.0) detected = lost;
+        } else if (nowNs - lastProgressNs > stallNs) {
+            stalls.fetch_add(1, std::memory_order_relaxed);
+            events::recorder.Record(FlightRecorder::Event::Stall, source, (ma_uint32)((nowNs - lastProgressNs) / 1e6));
+            detected = lastProgressNs + stallNs;
+        } else {
+            return false;
+        }
+
+        // A route lost again before its first callback is still the same outage.
+        if (!down.load(std::memory_order_relaxed)) {
+            detectedNs = detected;
+            backoffMs = 0;
+            down.store(true, std::memory_order_relaxed);
+        }
+        recovering = true;
+        reopened = false;
+        nextAttemptNs = nowNs;
+    }
+
+    return nowNs >= nextAttemptNs;
+}
+
+void internal::Supervisor::Attempted(bool success, double nowNs)
+{
+    if (success) {
+        recovering = false;
+        reopened = true;
+        lastCallbacks = 0;
+        lastProgressNs = nowNs;
+        return;
+    }
+
+    failedAttempts.fetch_add(1, std::memory_order_relaxed);
+    backoffMs = backoffMs == 0 ? recovery::firstBackoffMs : std::min(2 * backoffMs, recovery::maxBackoffMs);
+    nextAttemptNs = nowNs + backoffMs * 1e6;
+    events::recorder.Record(FlightRecorder::Event::ReopenFailed, source, backoffMs);
+}
+
+RecoveryStats internal::Supervisor::Snapshot() const
+{
+    RecoveryStats stats = {};
+    stats.deviceLosses = deviceLosses.load(std::memory_order_relaxed);
+    stats.stalls = stalls.load(std::memory_order_relaxed);
+    stats.reroutes = reroutes.load(std::memory_order_relaxed);
+    stats.recoveries = recoveries.load(std::memory_order_relaxed);
+    stats.failedAttempts = failedAttempts.load(std::memory_order_relaxed);
+    stats.recovering = down.load(std::memory_order_relaxed);
+    stats.lastRecoveryMs = lastRecoveryMs.load(std::memory_order_relaxed);
+    stats.maxRecoveryMs = maxRecoveryMs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ============================================================================
+// Flight recorder
+// ============================================================================
+
+// Callback thread: a volume change is recorded once, when the callback first applies it, to
+// the route's recorder; offline routes have none.
+void internal::record_volume(FlightRecorder *recorder, float &recorded, float volume, FlightRecorder::Source source)
+{
+    if (volume == recorded) return;
+    recorded = volume;
+    if (recorder) recorder->Record(FlightRecorder::Event::Volume, source, std::bit_cast<ma_uint32>(volume));
+}
+
+const FlightRecorder &internal::event_recorder()
+{
+    return events::recorder;
+}
+
+// Decode the events recorded since the last call into one log message; with a failure, even
+// when there are none, so the log shows what led up to it.
+void internal::log_events(const char *failure)
+{
+    std::lock_guard lock(events::mutex);
+
+    std::vector<FlightRecorder::Entry> entries;
+    ma_uint64 cursor = events::cursor.load();
+    const ma_uint64 lost = events::recorder.Read(cursor, entries);
+    events::cursor.store(cursor);
+
+    if (entries.empty() && lost == 0 && failure == nullptr) return;
+
+    std::string message = failure ? std::format("Audio events before the {}:", failure) : "Audio events:";
+    if (lost > 0) message += std::format("\n{} events overwritten before they were logged", lost);
+
+    char line[160];
+    for (const FlightRecorder::Entry &entry : entries) {
+        FlightRecorder::Format(entry, line, sizeof(line));
+        message += '\n';
+        message += line;
+    }
+
+    if (failure) {
+        Log::Warning("{}", message);
+    } else {
+        Log::Info("{}", message);
+    }
+}
+
+// Async-signal-safe: the events not logged yet are formatted one at a time into a static
+// buffer and written straight to the crash file. The log cursor and its lock are left alone,
+// as the crash may hold them, and so is the log writer thread, which may be the one that crashed.
+void internal::log_events_on_crash(const char *cause)
+{
+    if (crash::entered.exchange(true)) return;
+
+    write_crash("Crashed (");
+    write_crash(cause);
+    write_crash("). Audio events not logged yet:\n");
+
+    ma_uint64 cursor = events::cursor.load();
+    ma_uint64 lost = 0;
+    FlightRecorder::Entry entry;
+    while (events::recorder.ReadNext(cursor, entry, lost)) {
+        size_t length = FlightRecorder::Format(entry, crash::line, sizeof(crash::line) - 1);
+        crash::line[length++] = '\n';
+        write_crash(crash::line, length);
+    }
+
+    if (lost > 0) {
+        const char *end = std::to_chars(crash::line, std::end(crash::line), lost).ptr;
+        write_crash(crash::line, end - crash::line);
+        write_crash(" events overwritten before they were logged\n");
+    }
+}
+
+void internal::write_crash(const char *text, size_t length)
+{
+#ifdef _WIN32
+    DWORD written = 0;
+    WriteFile(crash::file, text, (DWORD)length, &written, nullptr);
+#else
+    while (length > 0) {
+        const ssize_t written = ::write(crash::file, text, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+        text += written;
+        length -= (size_t)written;
+    }
+#endif
+}
+
+void internal::write_crash(const char *text)
+{
+    write_crash(text, std::strlen(text));
+}
+
+ResultVoid internal::install_crash_handler(const std::string &path)
+{
+    static std::mutex mutex;
+    std::lock_guard lock(mutex);
+
+    static constexpr auto cause_of = [](int signal) {
+        return signal == SIGSEGV ? "segmentation fault" :
+            signal == SIGILL ? "illegal instruction" :
+            signal == SIGFPE ? "arithmetic exception" : "abort";
+    };
+
+#ifdef _WIN32
+    if (crash::file != INVALID_HANDLE_VALUE) return Error("The crash handler is already installed.");
+    crash::file = CreateFileA(
+        path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (crash::file == INVALID_HANDLE_VALUE) {
+        return WinErr(GetLastError(), std::format("Failed to open the crash log '{}'.", path));
+    }
+
+    // Log the events, then chain; the CRT resets a handler to SIG_DFL as it calls it.
+    const auto on_signal = [](int signal) {
+        log_events_on_crash(cause_of(signal));
+        const size_t index = std::find(std::begin(crash::signals), std::end(crash::signals), signal) - std::begin(crash::signals);
+        void (*previous)(int) = crash::previous[index];
+        if (previous != SIG_DFL && previous != SIG_IGN && previous != SIG_ERR && previous != nullptr) {
+            previous(signal);
+            return;
+        }
+        std::raise(signal);
+    };
+    for (size_t i = 0; i < std::size(crash::signals); ++i) {
+        crash::previous[i] = std::signal(crash::signals[i], on_signal);
+    }
+
+    // Structured exceptions (access violations and the like) do not raise signals on Windows.
+    crash::previousFilter = SetUnhandledExceptionFilter([](EXCEPTION_POINTERS *pInfo) -> LONG {
+        char cause[32] = "exception 0x";
+        *std::to_chars(cause + 12, std::end(cause) - 1, (ma_uint32)pInfo->ExceptionRecord->ExceptionCode, 16).ptr = '\0';
+        log_events_on_crash(cause);
+        return crash::previousFilter ? crash::previousFilter(pInfo) : EXCEPTION_CONTINUE_SEARCH;
+    });
+#else
+    if (crash::file >= 0) return Error("The crash handler is already installed.");
+    crash::file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (crash::file < 0) {
+        return Error(std::format("Failed to open the crash log '{}' ({}).", path, std::strerror(errno)));
+    }
+
+    // Log the events, then chain to the previous handler. With none, the default action ends
+    // the process once this handler returns and the signal is unblocked.
+    struct sigaction action = {};
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    action.sa_sigaction = [](int signal, siginfo_t *pInfo, void *pContext) {
+        log_events_on_crash(cause_of(signal));
+        const size_t index = std::find(std::begin(crash::signals), std::end(crash::signals), signal) - std::begin(crash::signals);
+        const struct sigaction &previous = crash::previous[index];
+        if ((previous.sa_flags & SA_SIGINFO) && previous.sa_sigaction != nullptr) {
+            previous.sa_sigaction(signal, pInfo, pContext);
+            return;
+        }
+        if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(signal);
+            return;
+        }
+        struct sigaction fallback = {};
+        fallback.sa_handler = SIG_DFL;
+        sigemptyset(&fallback.sa_mask);
+        sigaction(signal, &fallback, nullptr);
+        raise(signal);
+    };
+    for (size_t i = 0; i < std::size(crash::signals); ++i) {
+        sigaction(crash::signals[i], &action, &crash::previous[i]);
+    }
+#endif
+
+    return std::monostate{};
+}
+
+ResultVoid internal::start_loopback_route(LoopbackRoute &route)
+{
+    route.closing.store(false);
+    internal::latch_loopback_format(route);
+
+    // A recording keeps the format it started in; a route in another one completes its file.
+    if (!recording::loopbackTap.Accepts(route.format, route.channels, route.sampleRate)) {
+        recording::loopbackTap.Stop();
+        Log::Warning("Stopped the loopback recording: the redirect changed its stream format.");
+    }
+    ma_result result = internal::init_loopback_device(route);
 
     if (result != MA_SUCCESS) {
         return Error(std::format(
@@ -155,29 +1422,21 @@ ResultVoid AudioRedirector::StartLoopbackRedirect(const ma_device_id *loopbackId
         ));
     }
 
-    result = internal::init_playback_device(playbackId);
+    result = internal::init_playback_device(route);
 
     if (result != MA_SUCCESS) {
-        ma_device_uninit(&internal::loopbackDevice);
+        ma_device_uninit(&route.loopbackDevice);
         return Error(std::format(
             "Failed to initialize playback device ({}).",
             ma::convert::to_string(result)
         ));
     }
 
-    // Init ring buffer (1 second at 48kHz, stereo)
-    result = ma_pcm_rb_init(
-        internal::loopback::format,
-        internal::loopback::channels,
-        internal::loopback::sampleRate,  // bufferSizeInFrames
-        nullptr,                         // let miniaudio allocate the buffer
-        nullptr,                         // use default allocator for buffer
-        &internal::ringBuffer
-    );
+    result = internal::init_loopback_pipeline(route);
 
     if (result != MA_SUCCESS) {
-        ma_device_uninit(&internal::loopbackDevice);
-        ma_device_uninit(&internal::playbackDevice);
+        ma_device_uninit(&route.loopbackDevice);
+        ma_device_uninit(&route.playbackDevice);
 
         return Error(std::format(
             "Failed to initialize ring buffer ({}).",
@@ -185,13 +1444,14 @@ ResultVoid AudioRedirector::StartLoopbackRedirect(const ma_device_id *loopbackId
         ));
     }
 
-    const ma_result loopback_result = ma_device_start(&internal::loopbackDevice);
-    const ma_result playback_result = ma_device_start(&internal::playbackDevice);
+    const ma_result loopback_result = ma_device_start(&route.loopbackDevice);
+    const ma_result playback_result = ma_device_start(&route.playbackDevice);
 
     if (loopback_result != MA_SUCCESS || playback_result != MA_SUCCESS) {
-        ma_device_uninit(&internal::loopbackDevice);
-        ma_device_uninit(&internal::playbackDevice);
-        ma_pcm_rb_uninit(&internal::ringBuffer);
+        route.closing.store(true); // The device that did start stops with the uninit
+        ma_device_uninit(&route.loopbackDevice);
+        ma_device_uninit(&route.playbackDevice);
+        internal::uninit_loopback_pipeline(route);
 
         return Error(std::format(
             "Failed to start {} device ({}).",
@@ -200,17 +1460,26 @@ ResultVoid AudioRedirector::StartLoopbackRedirect(const ma_device_id *loopbackId
         );
     }
 
+    internal::publish_conversions(route);
+    events::recorder.Record(FlightRecorder::Event::Started, FlightRecorder::Source::LoopbackRoute);
     return std::monostate{};
 }
 
-ResultVoid AudioRedirector::StopLoopbackRedirect()
+ResultVoid internal::stop_loopback_route(LoopbackRoute &route)
 {
+    route.switchTimes.armed.store(false, std::memory_order_relaxed);
+    route.closing.store(true);
+    {
+        std::lock_guard lock(internal::conversionsMutex);
+        route.conversions = {};
+    }
+
     /* Stop and Uninitialize loopback device */
 
-    ma_device_state device_state = ma_device_get_state(&internal::loopbackDevice);
+    ma_device_state device_state = ma_device_get_state(&route.loopbackDevice);
 
     if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
-        ma_result result = ma_device_stop(&internal::loopbackDevice);
+        ma_result result = ma_device_stop(&route.loopbackDevice);
         if (result != MA_SUCCESS) {
             return Error(std::format(
                 "Failed to stop input device ({}).",
@@ -220,15 +1489,15 @@ ResultVoid AudioRedirector::StopLoopbackRedirect()
     }
 
     if (device_state != ma_device_state_uninitialized) {
-        ma_device_uninit(&internal::loopbackDevice);
+        ma_device_uninit(&route.loopbackDevice);
     }
 
     /* Stop and Uninitialize playback device */
 
-    device_state = ma_device_get_state(&internal::playbackDevice);
+    device_state = ma_device_get_state(&route.playbackDevice);
 
     if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
-        ma_result result = ma_device_stop(&internal::playbackDevice);
+        ma_result result = ma_device_stop(&route.playbackDevice);
         if (result != MA_SUCCESS) {
             return Error(std::format(
                 "Failed to stop playback device ({}).",
@@ -238,40 +1507,29 @@ ResultVoid AudioRedirector::StopLoopbackRedirect()
     }
 
     if (device_state != ma_device_state_uninitialized) {
-        ma_device_uninit(&internal::playbackDevice);
-    }  
-    
+        ma_device_uninit(&route.playbackDevice);
+        events::recorder.Record(FlightRecorder::Event::Stopped, FlightRecorder::Source::LoopbackRoute);
+    }
+
     /* Uninitialize Ring buffer */
 
-    if (&internal::ringBuffer != nullptr && &internal::ringBuffer.rb != nullptr) {
-        ma_pcm_rb_uninit(&internal::ringBuffer);
-    }
+    internal::uninit_loopback_pipeline(route);
 
     return std::monostate{};
 }
 
-ResultVoid AudioRedirector::StartDuplexRedirect(const ma_device_id *captureId, const ma_device_id *playbackId)
+ResultVoid internal::start_duplex_route(DuplexRoute &route)
 {
-    ma_device_state device_state = ma_device_state_uninitialized;
-    if (internal::duplexDevice.pContext != nullptr) {
-        device_state = ma_device_get_state(&internal::duplexDevice);
-    }
-
-    if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
-        ma_result result = ma_device_stop(&internal::duplexDevice);
-        if (result != MA_SUCCESS) {
-            return Error(std::format(
-                "Failed to stop duplex device ({}).",
-                ma::convert::to_string(result)
-            ));
-        }
-    }
+    route.closing.store(false);
+    internal::latch_duplex_format(route);
 
-    if (device_state != ma_device_state_uninitialized) {
-        ma_device_uninit(&internal::duplexDevice);
+    if (!recording::duplexTap.Accepts(route.format, route.channels, route.sampleRate)) {
+        recording::duplexTap.Stop();
+        Log::Warning("Stopped the duplex recording: the redirect changed its stream format.");
     }
+    internal::init_duplex_pipeline(route);
 
-    ma_result result = internal::init_duplex_device(captureId, playbackId);
+    ma_result result = internal::init_duplex_device(route);
 
     if (result != MA_SUCCESS) {
         return Error(std::format(
@@ -280,10 +1538,10 @@ ResultVoid AudioRedirector::StartDuplexRedirect(const ma_device_id *captureId, c
         ));
     }
 
-    result = ma_device_start(&internal::duplexDevice);
+    result = ma_device_start(&route.device);
 
     if (result != MA_SUCCESS) {
-        ma_device_uninit(&internal::duplexDevice);
+        ma_device_uninit(&route.device);
 
         return Error(std::format(
             "Failed to start duplex device ({}).",
@@ -291,15 +1549,24 @@ ResultVoid AudioRedirector::StartDuplexRedirect(const ma_device_id *captureId, c
         ));
     }
 
+    internal::publish_conversions(route);
+    events::recorder.Record(FlightRecorder::Event::Started, FlightRecorder::Source::DuplexRoute);
     return std::monostate{};
 }
 
-ResultVoid AudioRedirector::StopDuplexRedirect()
+ResultVoid internal::stop_duplex_route(DuplexRoute &route)
 {
-    ma_device_state device_state = ma_device_get_state(&internal::duplexDevice);
+    route.switchTimes.armed.store(false, std::memory_order_relaxed);
+    route.closing.store(true);
+    {
+        std::lock_guard lock(internal::conversionsMutex);
+        route.conversions = {};
+    }
+
+    ma_device_state device_state = ma_device_get_state(&route.device);
 
     if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
-        ma_result result = ma_device_stop(&internal::duplexDevice);
+        ma_result result = ma_device_stop(&route.device);
         if (result != MA_SUCCESS) {
             return Error(std::format(
                 "Failed to stop duplex device ({}).",
@@ -309,96 +1576,618 @@ ResultVoid AudioRedirector::StopDuplexRedirect()
     }
 
     if (device_state != ma_device_state_uninitialized) {
-        ma_device_uninit(&internal::duplexDevice);
+        ma_device_uninit(&route.device);
+        events::recorder.Record(FlightRecorder::Event::Stopped, FlightRecorder::Source::DuplexRoute);
     }
 
     return std::monostate{};
 }
 
-ma_result internal::init_loopback_device(const ma_device_id *id) {
+bool internal::is_running(ma_device *device) {
+    const ma_device_state device_state = ma_device_get_state(device);
+    return device_state == ma_device_state_started || device_state == ma_device_state_starting;
+}
+
+bool internal::wait_until(const std::function<bool()> &condition, ma_uint32 timeoutMs) {
+    // Pipeline time is the virtual clock on VirtualBackend, which may run far ahead of the wall clock.
+    const bool isVirtual = VirtualBackend::IsActive(&internal::context);
+    const bool manualClock = VirtualBackend::IsManual(&internal::context);
+    const auto now = [&]() {
+        return isVirtual
+            ? VirtualBackend::GetTimeSeconds(&internal::context)
+            : std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    const double deadline = now() + timeoutMs / 1000.0;
+
+    while (!condition()) {
+        if (now() >= deadline) return condition();
+
+        if (manualClock) {
+            // With no device running the clock cannot move, and nothing can change.
+            const double before = now();
+            if (VirtualBackend::Advance(&internal::context, 0.001) <= before) return condition();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return true;
+}
+
+ma_result internal::init_loopback_pipeline() {
+    latch_loopback_format(*internal::loopbackRoute.load());
+    return init_loopback_pipeline(*internal::loopbackRoute.load());
+}
+
+void internal::uninit_loopback_pipeline() {
+    uninit_loopback_pipeline(*internal::loopbackRoute.load());
+}
+
+void internal::init_duplex_pipeline() {
+    latch_duplex_format(*internal::duplexRoute.load());
+    init_duplex_pipeline(*internal::duplexRoute.load());
+}
+
+// Shared-mode native format of each device, as far as the backend reports it. Each side keeps
+// its own sample format and channel count, which the redirect converts through f32 and routes
+// (or copies) anyway; the rate follows the source, so the capture side never converts and the
+// playback device's converter handles any resampling.
+internal::StreamFormat internal::negotiate_format(
+    ma_device_type sourceType, const std::optional<ma_device_id> &sourceId,
+    const std::optional<ma_device_id> &playbackId, const StreamFormat &settings
+) {
+    struct Native {
+        ma_format format = ma_format_unknown; // Unknown or 0 where the backend leaves it open
+        ma_uint32 channels = 0;
+        ma_uint32 sampleRate = 0;
+    };
+
+    const auto query = [](ma_device_type type, const std::optional<ma_device_id> &id) {
+        Native native;
+        ma_device_info info;
+        if (ma_context_get_device_info(&context, type, id ? &id.value() : nullptr, &info) != MA_SUCCESS) return native;
+
+        for (ma_uint32 i = 0; i < info.nativeDataFormatCount; ++i) {
+            const auto &dataFormat = info.nativeDataFormats[i];
+            if (dataFormat.flags & MA_DATA_FORMAT_FLAG_EXCLUSIVE_MODE) continue; // Devices open shared
+            native = {dataFormat.format, dataFormat.channels, dataFormat.sampleRate};
+            break;
+        }
+        return native;
+    };
+
+    // Loopback captures what a playback device renders, so that is the device to ask.
+    const Native source = query(sourceType == ma_device_type_loopback ? ma_device_type_playback : sourceType, sourceId);
+    const Native playback = query(ma_device_type_playback, playbackId);
+
+    StreamFormat negotiated = settings;
+    if (source.format != ma_format_unknown) negotiated.format = source.format;
+    if (playback.format != ma_format_unknown) negotiated.playbackFormat = playback.format;
+
+    // Where one side does not report a count it takes the other's, so nothing is routed.
+    const ma_uint32 sourceChannels = source.channels != 0 ? source.channels : playback.channels;
+    const ma_uint32 playbackChannels = playback.channels != 0 ? playback.channels : source.channels;
+    if (sourceChannels != 0) negotiated.channels = std::min(sourceChannels, AudioRedirector::MaxChannels);
+    if (playbackChannels != 0) negotiated.playbackChannels = std::min(playbackChannels, AudioRedirector::MaxChannels);
+
+    if (source.sampleRate != 0) negotiated.sampleRate = source.sampleRate;
+    else if (playback.sampleRate != 0) negotiated.sampleRate = playback.sampleRate;
+
+    return negotiated;
+}
+
+void internal::latch_loopback_format(LoopbackRoute &route) {
+    std::unique_lock lock(internal::loopback::mutex);
+    const StreamFormat settings = {
+        internal::loopback::format, internal::loopback::playbackFormat,
+        internal::loopback::channels, internal::loopback::playbackChannels, internal::loopback::sampleRate
+    };
+    route.negotiated = internal::loopback::autoFormat;
+    lock.unlock(); // Negotiating queries the devices
+    const StreamFormat format = route.negotiated
+        ? negotiate_format(ma_device_type_loopback, route.loopbackId, route.playbackId, settings)
+        : settings;
+
+    route.format = format.format;
+    route.playbackFormat = format.playbackFormat;
+    route.channels = format.channels;
+    route.playbackChannels = format.playbackChannels;
+    route.sampleRate = format.sampleRate;
+}
+
+void internal::latch_duplex_format(DuplexRoute &route) {
+    std::unique_lock lock(internal::duplex::mutex);
+    const StreamFormat settings = {
+        internal::duplex::format, internal::duplex::playbackFormat,
+        internal::duplex::channels, internal::duplex::playbackChannels, internal::duplex::sampleRate
+    };
+    route.negotiated = internal::duplex::autoFormat;
+    lock.unlock(); // Negotiating queries the devices
+    const StreamFormat format = route.negotiated
+        ? negotiate_format(ma_device_type_capture, route.captureId, route.playbackId, settings)
+        : settings;
+
+    route.format = format.format;
+    route.playbackFormat = format.playbackFormat;
+    route.channels = format.channels;
+    route.playbackChannels = format.playbackChannels;
+    route.sampleRate = format.sampleRate;
+}
+
+StreamConversion internal::stream_conversion(const ma_device &device, ma_device_type side) {
+    const bool capture = side == ma_device_type_capture;
+    StreamConversion conversion = {};
+
+    conversion.deviceFormat = capture ? device.capture.internalFormat : device.playback.internalFormat;
+    conversion.deviceChannels = capture ? device.capture.internalChannels : device.playback.internalChannels;
+    conversion.deviceSampleRate = capture ? device.capture.internalSampleRate : device.playback.internalSampleRate;
+    conversion.format = capture ? device.capture.format : device.playback.format;
+    conversion.channels = capture ? device.capture.channels : device.playback.channels;
+    conversion.sampleRate = device.sampleRate;
+
+    conversion.convertsFormat = conversion.format != conversion.deviceFormat;
+    conversion.convertsChannels = conversion.channels != conversion.deviceChannels;
+    conversion.resamples = conversion.sampleRate != conversion.deviceSampleRate;
+
+    // The backend user data of a polyphase resampler is its quality.
+    conversion.resampler = ResamplerQuality::Linear;
+    if (device.resampling.algorithm == ma_resample_algorithm_custom) {
+        switch (*static_cast<const PolyphaseResampler::Quality *>(device.resampling.pBackendUserData)) {
+            case PolyphaseResampler::Quality::Low: conversion.resampler = ResamplerQuality::Low; break;
+            case PolyphaseResampler::Quality::Medium: conversion.resampler = ResamplerQuality::Medium; break;
+            case PolyphaseResampler::Quality::High: conversion.resampler = ResamplerQuality::High; break;
+        }
+    }
+    return conversion;
+}
+
+// Called once the route's devices started, before anything re-inits them.
+void internal::publish_conversions(LoopbackRoute &route) {
+    RouteConversions conversions = {};
+    conversions.running = true;
+
+    // The ring holds the capture format; playback reads it through f32 for the gain and limiter.
+    conversions.negotiated = route.negotiated;
+    conversions.capture = stream_conversion(route.loopbackDevice, ma_device_type_capture);
+    conversions.playback = stream_conversion(route.playbackDevice, ma_device_type_playback);
+    conversions.convertsSamples = route.format != ma_format_f32 || route.playbackFormat != ma_format_f32;
+    conversions.routing = ChannelMatrix::to_string(route.routing.GetKind());
+
+    std::lock_guard lock(conversionsMutex);
+    route.conversions = conversions;
+}
+
+void internal::publish_conversions(DuplexRoute &route) {
+    RouteConversions conversions = {};
+    conversions.running = true;
+
+    // At unity gain the callback copies between the two sides, converting only if they differ
+    // or are routed.
+    conversions.negotiated = route.negotiated;
+    conversions.capture = stream_conversion(route.device, ma_device_type_capture);
+    conversions.playback = stream_conversion(route.device, ma_device_type_playback);
+    conversions.convertsSamples = route.format != route.playbackFormat || !route.routing.IsIdentity();
+    conversions.routing = ChannelMatrix::to_string(route.routing.GetKind());
+
+    std::lock_guard lock(conversionsMutex);
+    route.conversions = conversions;
+}
+
+// Linear keeps miniaudio's resampler; the rest plug the polyphase one into the data converter.
+void internal::set_resampler(ma_resampler_config &config, ResamplerQuality quality) {
+    PolyphaseResampler::Quality tier;
+    switch (quality) {
+        case ResamplerQuality::Low: tier = PolyphaseResampler::Quality::Low; break;
+        case ResamplerQuality::Medium: tier = PolyphaseResampler::Quality::Medium; break;
+        case ResamplerQuality::High: tier = PolyphaseResampler::Quality::High; break;
+        default: return;
+    }
+
+    config.algorithm = ma_resample_algorithm_custom;
+    config.pBackendVTable = PolyphaseResampler::BackendVTable();
+    config.pBackendUserData = PolyphaseResampler::BackendUserData(tier);
+}
+
+void internal::build_routing(
+    ChannelMatrix &matrix, ma_uint32 inputChannels, ma_uint32 outputChannels, const ChannelRoute *routes, size_t routeCount
+) {
+    if (routeCount == 0) {
+        matrix.SetDefault(inputChannels, outputChannels);
+        return;
+    }
+
+    std::vector<float> gains((size_t)inputChannels * outputChannels, 0.0f);
+    for (size_t i = 0; i < routeCount; ++i) {
+        if (routes[i].input >= inputChannels || routes[i].output >= outputChannels) continue;
+        gains[(size_t)routes[i].output * inputChannels + routes[i].input] += routes[i].gain;
+    }
+    matrix.Set(inputChannels, outputChannels, gains.data());
+}
+
+ma_result internal::init_loopback_pipeline(LoopbackRoute &route) {
+    uninit_loopback_pipeline(route); // Re-init from a clean state; the formats are latched already
+
+    ma_uint32 latencyMs;
+    {
+        std::lock_guard lock(internal::loopback::mutex);
+        latencyMs = internal::loopback::latencyMs;
+        build_routing(
+            route.routing, route.channels, route.playbackChannels,
+            internal::loopback::routing.data(), internal::loopback::routing.size()
+        );
+    }
+
+    // Init ring buffer, sized for the largest latency the jitter buffer may grow to
+    ma_result result = route.ringBuffer.Init(
+        ma_get_bytes_per_frame(route.format, route.channels),
+        JitterBuffer::CapacityFor(route.sampleRate, latencyMs)
+    );
+    if (result != MA_SUCCESS) return result;
+
+    route.jitterBuffer.Reset(route.sampleRate, latencyMs);
+    route.driftEstimator.Reset(route.sampleRate);
+    route.resampler.Reset(route.channels, internal::loopback::chunkFrames);
+    route.unrouted.assign(route.routing.IsIdentity() ? 0 : (size_t)internal::loopback::chunkFrames * route.channels, 0.0f);
+    route.scratch.assign((size_t)internal::loopback::chunkFrames * route.playbackChannels, 0.0f);
+    route.gain.Reset(route.sampleRate);
+    route.fade.SetRamp(GainStage::Ramp::Linear);
+    route.fade.Reset(route.sampleRate, internal::reconfigure::crossfadeMs);
+    route.framesPlayed.store(0, std::memory_order_relaxed);
+    route.firstCallbackNs.store(0.0, std::memory_order_relaxed);
+    route.loopbackMonitor.Reset(route.sampleRate);
+    route.playbackMonitor.Reset(route.sampleRate);
+    route.loopbackMonitor.SetRecorder(&events::recorder, FlightRecorder::Source::LoopbackCapture);
+    route.playbackMonitor.SetRecorder(&events::recorder, FlightRecorder::Source::LoopbackPlayback);
+    route.recordedVolume = route.gain.GetTarget();
+    route.limiterActive = internal::limiter::enabled;
+    route.limiter.Reset(
+        route.sampleRate, route.playbackChannels,
+        internal::limiter::lookaheadMs, internal::limiter::releaseMs
+    );
+
+    return MA_SUCCESS;
+}
+
+void internal::uninit_loopback_pipeline(LoopbackRoute &route) {
+    if (route.ringBuffer.IsInitialized()) {
+        route.ringBuffer.Uninit();
+    }
+}
+
+void internal::init_duplex_pipeline(DuplexRoute &route) {
+    {
+        std::lock_guard lock(internal::duplex::mutex);
+        build_routing(
+            route.routing, route.channels, route.playbackChannels,
+            internal::duplex::routing.data(), internal::duplex::routing.size()
+        );
+    }
+    route.unrouted.assign(route.routing.IsIdentity() ? 0 : (size_t)internal::duplex::chunkFrames * route.channels, 0.0f);
+    route.scratch.assign((size_t)internal::duplex::chunkFrames * route.playbackChannels, 0.0f);
+    route.gain.Reset(route.sampleRate);
+    route.fade.SetRamp(GainStage::Ramp::Linear);
+    route.fade.Reset(route.sampleRate, internal::reconfigure::crossfadeMs);
+    route.framesPlayed.store(0, std::memory_order_relaxed);
+    route.firstCallbackNs.store(0.0, std::memory_order_relaxed);
+    route.monitor.Reset(route.sampleRate);
+    route.monitor.SetRecorder(&events::recorder, FlightRecorder::Source::Duplex);
+    route.recordedVolume = route.gain.GetTarget();
+    route.limiterActive = internal::limiter::enabled;
+    route.limiter.Reset(
+        route.sampleRate, route.playbackChannels,
+        internal::limiter::lookaheadMs, internal::limiter::releaseMs
+    );
+}
+
+internal::OfflineRoute *internal::create_offline_route(ma_device_type sourceType, const StreamFormat &format) {
+    auto offline = std::make_unique<OfflineRoute>();
+    offline->device.capture.format = format.format;
+    offline->device.capture.channels = format.channels;
+    offline->device.playback.format = format.playbackFormat;
+    offline->device.playback.channels = format.playbackChannels;
+    offline->device.sampleRate = format.sampleRate;
+
+    // As the Start*Redirect functions build a route, but nothing goes to the flight recorder:
+    // these are not live callbacks.
+    if (sourceType == ma_device_type_loopback) {
+        offline->loopback = std::make_unique<LoopbackRoute>();
+        LoopbackRoute &route = *offline->loopback;
+        route.format = format.format;
+        route.playbackFormat = format.playbackFormat;
+        route.channels = format.channels;
+        route.playbackChannels = format.playbackChannels;
+        route.sampleRate = format.sampleRate;
+        route.gain.SetTarget(internal::loopbackRoute.load()->gain.GetTarget());
+        route.fade.SetTarget(1.0f);
+
+        if (init_loopback_pipeline(route) != MA_SUCCESS) return nullptr;
+        route.loopbackMonitor.SetRecorder(nullptr, FlightRecorder::Source::LoopbackCapture);
+        route.playbackMonitor.SetRecorder(nullptr, FlightRecorder::Source::LoopbackPlayback);
+        offline->device.pUserData = &route;
+    } else {
+        offline->duplex = std::make_unique<DuplexRoute>();
+        DuplexRoute &route = *offline->duplex;
+        route.format = format.format;
+        route.playbackFormat = format.playbackFormat;
+        route.channels = format.channels;
+        route.playbackChannels = format.playbackChannels;
+        route.sampleRate = format.sampleRate;
+        route.gain.SetTarget(internal::duplexRoute.load()->gain.GetTarget());
+        route.fade.SetTarget(1.0f);
+
+        init_duplex_pipeline(route);
+        route.monitor.SetRecorder(nullptr, FlightRecorder::Source::Duplex);
+        offline->device.pUserData = &route;
+    }
+
+    return offline.release();
+}
+
+void internal::destroy_offline_route(OfflineRoute *route) {
+    if (route != nullptr && route->loopback) uninit_loopback_pipeline(*route->loopback);
+    delete route;
+}
+
+void internal::offline_process(OfflineRoute *route, void *pOutput, const void *pInput, ma_uint32 frameCount) {
+    if (route->loopback) {
+        data_callback_loopback(&route->device, nullptr, pInput, frameCount);
+        data_callback_playback(&route->device, pOutput, nullptr, frameCount);
+    } else {
+        data_callback_duplex(&route->device, pOutput, pInput, frameCount);
+    }
+}
+
+ma_result internal::init_loopback_device(LoopbackRoute &route) {
     // --- Configure loopback capture ---
     ma_device_config config = ma_device_config_init(ma_device_type_loopback);
-    config.capture.pDeviceID = id;
-    config.capture.format = internal::loopback::format;
-    config.capture.channels = internal::loopback::channels;
-    config.sampleRate = internal::loopback::sampleRate;
+    config.capture.pDeviceID = route.loopbackId ? &route.loopbackId.value() : nullptr;
+    config.capture.format = route.format;
+    config.capture.channels = route.channels;
+    config.sampleRate = route.sampleRate;
+    {
+        std::lock_guard lock(internal::loopback::mutex);
+        config.periodSizeInFrames = internal::loopback::period.periodSizeInFrames;
+        config.periods = internal::loopback::period.periods;
+        config.performanceProfile = internal::loopback::period.performanceProfile;
+        internal::set_resampler(config.resampling, internal::loopback::resampler);
+    }
     config.dataCallback = internal::data_callback_loopback;
+    config.notificationCallback = internal::notification_callback_loopback;
+    config.pUserData = &route;
 
-    return ma_device_init(&internal::context, &config, &internal::loopbackDevice);
+    return ma_device_init(&internal::context, &config, &route.loopbackDevice);
 }
 
-ma_result internal::init_playback_device(const ma_device_id *id) {
+ma_result internal::init_playback_device(LoopbackRoute &route) {
     // --- Configure playback ---
     ma_device_config config = ma_device_config_init(ma_device_type_playback);
-    config.playback.pDeviceID = id;
-    config.playback.format = internal::loopback::format;
-    config.playback.channels = internal::loopback::channels;
-    config.sampleRate = internal::loopback::sampleRate;
+    config.playback.pDeviceID = route.playbackId ? &route.playbackId.value() : nullptr;
+    config.playback.format = route.playbackFormat;
+    config.playback.channels = route.playbackChannels;
+    config.sampleRate = route.sampleRate;
+    {
+        std::lock_guard lock(internal::loopback::mutex);
+        config.periodSizeInFrames = internal::loopback::period.periodSizeInFrames;
+        config.periods = internal::loopback::period.periods;
+        config.performanceProfile = internal::loopback::period.performanceProfile;
+        internal::set_resampler(config.resampling, internal::loopback::resampler);
+    }
     config.dataCallback = internal::data_callback_playback;
+    config.notificationCallback = internal::notification_callback_loopback;
+    config.pUserData = &route;
 
-    return ma_device_init(&internal::context, &config, &internal::playbackDevice);
+    return ma_device_init(&internal::context, &config, &route.playbackDevice);
 }
 
-ma_result internal::init_duplex_device(const ma_device_id *captureId, const ma_device_id *playbackId) {
+ma_result internal::init_duplex_device(DuplexRoute &route) {
     // --- Configure duplex ---
     ma_device_config config = ma_device_config_init(ma_device_type_duplex);
-    config.capture.pDeviceID = captureId;
-    config.playback.pDeviceID = playbackId;
-    config.capture.format = internal::duplex::format;
-    config.capture.channels = internal::duplex::channels;
-    config.playback.format = internal::duplex::format;
-    config.playback.channels = internal::duplex::channels;
-    config.sampleRate = internal::duplex::sampleRate;
+    config.capture.pDeviceID = route.captureId ? &route.captureId.value() : nullptr;
+    config.playback.pDeviceID = route.playbackId ? &route.playbackId.value() : nullptr;
+    config.capture.format = route.format;
+    config.capture.channels = route.channels;
+    config.playback.format = route.playbackFormat;
+    config.playback.channels = route.playbackChannels;
+    config.sampleRate = route.sampleRate;
+    {
+        std::lock_guard lock(internal::duplex::mutex);
+        config.periodSizeInFrames = internal::duplex::period.periodSizeInFrames;
+        config.periods = internal::duplex::period.periods;
+        config.performanceProfile = internal::duplex::period.performanceProfile;
+        internal::set_resampler(config.resampling, internal::duplex::resampler);
+    }
     config.dataCallback = internal::data_callback_duplex;
+    config.notificationCallback = internal::notification_callback_duplex;
+    config.pUserData = &route;
 
-    return ma_device_init(&internal::context, &config, &internal::duplexDevice);
+    return ma_device_init(&internal::context, &config, &route.device);
 }
 
 void internal::data_callback_duplex(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
 {
-    /* Assert that the playback and capture sides use the same format and channel count. */
-    assert(pDevice->capture.format == pDevice->playback.format && "Format mismatch");
-    assert(pDevice->capture.channels == pDevice->playback.channels && "Channel count mismatch");
+    /* Benchmarks drive the callback with a bare device; it then runs the active route. */
+    DuplexRoute &route = pDevice->pUserData != nullptr ? *(DuplexRoute*)pDevice->pUserData : *internal::duplexRoute.load();
+
+    /* The routing maps the capture channels onto the playback channels; the sample format may differ per side. */
+    assert(pDevice->capture.channels == route.routing.GetInputChannels() && "Capture channel count mismatch");
+    assert(pDevice->playback.channels == route.routing.GetOutputChannels() && "Playback channel count mismatch");
+
+    const ma_format captureFormat = pDevice->capture.format;
+    const ma_format playbackFormat = pDevice->playback.format;
+    const ma_uint32 captureChannels = pDevice->capture.channels;
+    const ma_uint32 playbackChannels = pDevice->playback.channels;
+    const auto start = route.monitor.Begin();
+
+    if (route.firstCallbackNs.load(std::memory_order_relaxed) == 0.0) {
+        route.firstCallbackNs.store(pipeline_time_ns(), std::memory_order_relaxed);
+    }
+    route.framesPlayed.fetch_add(frameCount, std::memory_order_relaxed);
+    record_volume(route.monitor.GetRecorder(), route.recordedVolume, route.gain.GetTarget(), FlightRecorder::Source::Duplex);
 
-    /* Since the format and channel count are the same for both input and output which means we can just memcpy(). */
-    memcpy(pOutput, pInput, frameCount * ma_get_bytes_per_frame(pDevice->capture.format, pDevice->capture.channels));
+    /* Only the active route records; the outgoing one of a crossfade plays on unrecorded. */
+    if (&route == internal::duplexRoute.load(std::memory_order_relaxed)) {
+        recording::duplexTap.Push(pInput, frameCount, captureFormat, captureChannels, pDevice->sampleRate);
+    }
+
+    /* At unity gain without the limiter or routing this is a straight conversion (a memcpy() when the formats match). */
+    if (route.gain.IsUnity() && route.fade.IsUnity() && !route.limiterActive && route.routing.IsIdentity()) {
+        SampleConvert::Convert(pOutput, playbackFormat, pInput, captureFormat, (size_t)frameCount * captureChannels);
+        route.switchTimes.Record(true, frameCount, route.sampleRate);
+        route.monitor.End(start, frameCount, frameCount);
+        return;
+    }
+
+    const ma_uint32 totalFrames = frameCount;
+    const float fadeBefore = route.fade.GetCurrent();
+
+    /* Otherwise go through f32 for the routing, the gain ramp, the limiter and the crossfade. */
+    const ma_uint8* pIn = (const ma_uint8*)pInput;
+    ma_uint8* pOut = (ma_uint8*)pOutput;
+    while (frameCount > 0) {
+        const ma_uint32 chunk = std::min(frameCount, internal::duplex::chunkFrames);
+        const size_t samplesIn = (size_t)chunk * captureChannels;
+        const size_t samplesOut = (size_t)chunk * playbackChannels;
+
+        if (route.routing.IsIdentity()) {
+            SampleConvert::Convert(route.scratch.data(), ma_format_f32, pIn, captureFormat, samplesIn);
+        } else {
+            SampleConvert::Convert(route.unrouted.data(), ma_format_f32, pIn, captureFormat, samplesIn);
+            route.routing.Process(route.scratch.data(), route.unrouted.data(), chunk);
+        }
+        route.gain.Process(route.scratch.data(), chunk, playbackChannels);
+        if (route.limiterActive) {
+            route.limiter.Process(route.scratch.data(), chunk);
+        }
+        if (!route.fade.IsUnity()) {
+            route.fade.Process(route.scratch.data(), chunk, playbackChannels);
+        }
+        SampleConvert::Convert(pOut, playbackFormat, route.scratch.data(), ma_format_f32, samplesOut);
+
+        pIn += samplesIn * ma_get_bytes_per_sample(captureFormat);
+        pOut += samplesOut * ma_get_bytes_per_sample(playbackFormat);
+        frameCount -= chunk;
+    }
+
+    route.switchTimes.Record(fadeBefore > 0.0f || route.fade.GetCurrent() > 0.0f, totalFrames, route.sampleRate);
+    route.monitor.End(start, totalFrames, totalFrames);
+}
+
+// Benchmarks drive the loopback callbacks with a bare device; they then run the active route.
+internal::LoopbackRoute &internal::route_of(LoopbackRoute *route) {
+    return route != nullptr ? *route : *internal::loopbackRoute.load();
 }
 
 // Loopback -> write to RB
 void internal::data_callback_loopback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
 {
-    (void)pDevice; (void)pOutput;
+    (void)pOutput;
+    LoopbackRoute &route = route_of((LoopbackRoute*)pDevice->pUserData);
+    const auto start = route.loopbackMonitor.Begin();
+
+    // Frames that do not fit are dropped; the jitter buffer keeps the ring well below full, and
+    // widens its target when it was not.
+    const ma_uint32 written = route.ringBuffer.Write(pInput, frameCount);
+    route.jitterBuffer.AddDroppedFrames(frameCount - written);
+
+    // Only the active route records; the outgoing one of a crossfade plays on unrecorded.
+    if (&route == internal::loopbackRoute.load(std::memory_order_relaxed)) {
+        recording::loopbackTap.Push(pInput, frameCount, route.format, route.channels, route.sampleRate);
+    }
+    route.loopbackMonitor.End(start, frameCount, written, frameCount - written);
+}
 
-    float* pWrite = nullptr;
-    ma_uint32 framesToWrite = frameCount; // in/out
+// Playback -> read from RB, resample to track the loopback clock, route the channels, convert to the device format
+void internal::data_callback_playback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pInput;
+    LoopbackRoute &route = route_of((LoopbackRoute*)pDevice->pUserData);
+
+    const ma_format format = route.playbackFormat;
+    const ma_uint32 channels = route.playbackChannels;
+    const ma_uint32 bytesPerFrame = ma_get_bytes_per_frame(format, channels);
+    const auto start = route.playbackMonitor.Begin();
+    const ma_uint32 totalFrames = frameCount;
+    const float fadeBefore = route.fade.GetCurrent();
+    ma_uint32 totalRendered = 0;
+
+    // The supervisor times a recovery to here.
+    if (route.firstCallbackNs.load(std::memory_order_relaxed) == 0.0) {
+        route.firstCallbackNs.store(pipeline_time_ns(), std::memory_order_relaxed);
+    }
+    record_volume(route.playbackMonitor.GetRecorder(), route.recordedVolume, route.gain.GetTarget(), FlightRecorder::Source::LoopbackPlayback);
+
+    ma_uint8* pOut = (ma_uint8*)pOutput;
+    while (frameCount > 0) {
+        const ma_uint32 chunk = std::min(frameCount, internal::loopback::chunkFrames);
+        ma_uint32 rendered;
+        if (route.routing.IsIdentity()) {
+            rendered = internal::render_playback_chunk(route, route.scratch.data(), chunk);
+        } else {
+            rendered = internal::render_playback_chunk(route, route.unrouted.data(), chunk);
+            route.routing.Process(route.scratch.data(), route.unrouted.data(), rendered);
+        }
+        route.framesPlayed.fetch_add(rendered, std::memory_order_relaxed);
+        totalRendered += rendered;
+
+        // Pad any unfilled output with silence; the limiter needs a continuous timeline.
+        std::fill(
+            route.scratch.begin() + (size_t)rendered * channels,
+            route.scratch.begin() + (size_t)chunk * channels, 0.0f
+        );
+
+        route.gain.Process(route.scratch.data(), rendered, channels);
+        if (route.limiterActive) {
+            route.limiter.Process(route.scratch.data(), chunk);
+        }
+        if (!route.fade.IsUnity()) {
+            route.fade.Process(route.scratch.data(), chunk, channels);
+        }
+
+        SampleConvert::Convert(pOut, format, route.scratch.data(), ma_format_f32, (size_t)chunk * channels);
 
-    if (ma_pcm_rb_acquire_write(&internal::ringBuffer, &framesToWrite, (void**)&pWrite) == MA_SUCCESS && framesToWrite > 0) {
-        const size_t bytesPerFrame = ma_get_bytes_per_frame(internal::loopback::format, internal::loopback::channels);
-        memcpy(pWrite, pInput, (size_t)(framesToWrite * bytesPerFrame));
-        ma_pcm_rb_commit_write(&internal::ringBuffer, framesToWrite);
+        pOut += (size_t)chunk * bytesPerFrame;
+        frameCount -= chunk;
     }
+
+    // Frames not rendered were padded with silence: the pre-roll, or an underrun.
+    route.switchTimes.Record(totalRendered > 0 && (fadeBefore > 0.0f || route.fade.GetCurrent() > 0.0f), totalFrames, route.sampleRate);
+    route.playbackMonitor.End(start, totalFrames, totalRendered);
 }
 
-// Playback -> read from RB
-void internal::data_callback_playback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+// Pull one block through jitter buffer -> drift resampler; returns the frames rendered as f32.
+ma_uint32 internal::render_playback_chunk(LoopbackRoute &route, float* pOutput, ma_uint32 frameCount)
 {
-    (void)pDevice; (void)pInput;
+    const ma_uint32 framesAvailable = route.ringBuffer.AvailableRead();
 
-    float* pRead = nullptr;
-    ma_uint32 framesToRead = frameCount; // in/out
-    const size_t bytesPerFrame = ma_get_bytes_per_frame(internal::loopback::format, internal::loopback::channels);
+    // Steer the resampling step from the fill level, but not while pre-rolling (no steady state yet).
+    if (!route.jitterBuffer.IsPrerolling()) {
+        route.resampler.SetStep(route.driftEstimator.Update(
+            framesAvailable, route.jitterBuffer.GetTargetFrames(), frameCount
+        ));
+    }
 
-    size_t bytesFilled = 0;
-    if (ma_pcm_rb_acquire_read(&internal::ringBuffer, &framesToRead, (void**)&pRead) == MA_SUCCESS && framesToRead > 0) {
-        const size_t bytes = (size_t)(framesToRead * bytesPerFrame);
-        memcpy(pOutput, pRead, bytes);
-        ma_pcm_rb_commit_read(&internal::ringBuffer, framesToRead);
-        bytesFilled = bytes;
+    // Let the jitter buffer keep the ring fill level near the target latency.
+    const ma_uint32 framesNeeded = route.resampler.InputFramesFor(frameCount);
+    const JitterBuffer::Decision decision = route.jitterBuffer.Process(framesAvailable, framesNeeded);
+    FlightRecorder *recorder = route.playbackMonitor.GetRecorder(); // Null on an offline route
+    if (decision.framesToSkip > 0) {
+        route.ringBuffer.Skip(decision.framesToSkip);
+        if (recorder) recorder->Record(FlightRecorder::Event::RingTrimmed, FlightRecorder::Source::LoopbackPlayback, decision.framesToSkip);
+    }
+    if (recorder && decision.underrun) {
+        recorder->Record(FlightRecorder::Event::ShortRead, FlightRecorder::Source::LoopbackPlayback, decision.framesToRead, framesNeeded);
     }
 
-    // Pad any unfilled output with silence.
-    const size_t totalBytes = (size_t)frameCount * bytesPerFrame;
-    if (bytesFilled < totalBytes) {
-        memset((ma_uint8*)pOutput + bytesFilled, 0, totalBytes - bytesFilled);
+    // Read into the resampler as f32; the ring hands out both segments around the wrap point at once.
+    const SpscRing::Segments segments = route.ringBuffer.AcquireRead(decision.framesToRead);
+    for (int i = 0; i < 2; ++i) {
+        SampleConvert::Convert(
+            route.resampler.InputBuffer(), ma_format_f32,
+            segments.pData[i], route.format,
+            (size_t)segments.frames[i] * route.channels
+        );
+        route.resampler.CommitInput(segments.frames[i]);
     }
+    route.ringBuffer.CommitRead(segments.Total());
+
+    return route.resampler.Process(pOutput, frameCount);
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+#include <vector>
 #include "miniaudio.h"
 #include "Result.hpp"
 #include "Error.hpp"
@@ -11,26 +13,353 @@ struct AudioDevices {
 	ma_uint32 captureDeviceCount;
 };
 
+// One gain of a channel routing matrix: how much of a source channel goes to a playback channel.
+struct ChannelRoute {
+	ma_uint32 input;  // Source channel, from 0
+	ma_uint32 output; // Playback channel, from 0
+	float gain;
+};
+
+struct FanOutTarget {
+	const ma_device_id *playbackId;
+	ma_uint32 sampleRate;       // 0 to follow the source sample rate
+	float volume;
+	ma_uint32 channels;         // 0 to follow the source channel count
+	const ChannelRoute *routes; // Routing from the source channels; null for the default routing
+	ma_uint32 routeCount;
+};
+
+struct MixerSource {
+	ma_device_type type; // ma_device_type_capture or ma_device_type_loopback
+	const ma_device_id *deviceId;
+	float volume;
+};
+
+struct MixerCost {
+	double lastMicros;    // Mix time of the most recent playback callback
+	double averageMicros; // Moving average of the mix time
+	double peakMicros;    // Worst mix time since the mixer started
+	double loadPercent;   // Average mix time relative to the callback period
+};
+
+struct LimiterStats {
+	double latencyMs;      // Delay added by the limiter lookahead; 0 when the limiter is off
+	float gainReductionDb; // Gain reduction in the most recent callback
+};
+
+// Callback durations and intervals are also kept as log2 histograms: bucket 0 counts
+// [0, 1) us, bucket i counts [2^(i-1), 2^i) us and the last bucket everything longer.
+constexpr ma_uint32 CallbackHistogramBuckets = 20;
+
+struct CallbackStats {
+	ma_uint64 callbacks;
+	ma_uint64 framesRequested;    // Frames the device asked for or handed over
+	ma_uint64 framesDelivered;    // Frames of audio passed on
+	ma_uint64 underruns;          // Callbacks padded with silence after audio started flowing
+	ma_uint64 underrunFrames;
+	ma_uint64 overruns;           // Callbacks that dropped frames (the ring was full)
+	ma_uint64 overrunFrames;
+	ma_uint64 lateCallbacks;      // Callbacks that took longer than the audio they handled
+	double lastMicros;            // Duration of the most recent callback
+	double averageMicros;         // Moving average of the duration
+	double peakMicros;            // Longest callback since the redirect started
+	double p99Micros;             // 99th percentile duration, to histogram resolution
+	double averageIntervalMicros; // Moving average of the time between callbacks
+	double peakIntervalMicros;
+	double p99IntervalMicros;
+	double loadPercent;           // DSP load: average duration relative to the audio it handles
+	double peakLoadPercent;
+	ma_uint32 periodFrames;       // Device period the backend settled on
+	ma_uint32 durationHistogram[CallbackHistogramBuckets];
+	ma_uint32 intervalHistogram[CallbackHistogramBuckets];
+};
+
+// Automatic recovery of one redirect path. A device that stops without being asked to (e.g.
+// unplugged) or whose callbacks stall is reopened on the same devices, retrying with backoff.
+struct RecoveryStats {
+	ma_uint32 deviceLosses;   // Devices that stopped on their own or were interrupted
+	ma_uint32 stalls;         // Watchdog: no playback callback for several periods
+	ma_uint32 reroutes;       // Streams the backend moved to a new default device itself
+	ma_uint32 recoveries;     // Reopened routes whose callbacks run again
+	ma_uint32 failedAttempts; // Reopens that failed (device still gone), retried with backoff
+	bool recovering;          // Down right now, between detection and recovery
+	double lastRecoveryMs;    // Time to recovery: detection to the reopened route's first callback
+	double maxRecoveryMs;
+};
+
+struct RedirectorStats {
+	CallbackStats loopbackCapture;  // Loopback device, writing the ring
+	CallbackStats loopbackPlayback; // Playback device, reading the ring
+	CallbackStats duplex;
+	RecoveryStats loopbackRecovery;
+	RecoveryStats duplexRecovery;
+};
+
+// A recording of what a redirect receives from its source (StartLoopbackRecording()). Only
+// the active route records: during a crossfade the incoming route's frames go to the file,
+// and the outgoing route's are neither written nor counted as dropped.
+struct RecordingStats {
+	bool recording;
+	ma_uint64 framesWritten;  // In the file
+	ma_uint64 framesDropped;  // The buffer was full (the disk fell behind), or after a failure
+	double bufferPeakPercent; // Highest buffer fill the writer found
+	bool failed;              // A file write failed or the stream changed format; later frames are dropped
+};
+
+// An offline render of a WAV file through a redirect path (RenderDuplexFile()).
+struct RenderReport {
+	ma_format inputFormat;      // Of the input file
+	ma_uint32 inputChannels;
+	ma_uint32 inputSampleRate;
+	bool convertsInput;         // The file went through a data converter to reach the capture side
+	ma_format format;           // Capture side of the pipeline
+	ma_uint32 channels;
+	ma_format playbackFormat;   // Playback side of the pipeline, and the output file's format
+	ma_uint32 playbackChannels;
+	ma_uint32 sampleRate;
+	ma_uint32 periodFrames;     // Frames per callback
+	ma_uint64 framesIn;         // Read from the input file
+	ma_uint64 framesOut;        // Written to the output file
+	double callbackSeconds;     // Spent in the data callbacks
+	double totalSeconds;        // Including the input conversion and the file writes
+	double realtimeFactor;      // Seconds of output rendered per second of totalSeconds
+};
+
+struct SwitchReport {
+	double prepareMs;   // Opening, starting and pre-rolling the new route while the old one played
+	double crossfadeMs;
+	double overlapMs;   // Both routes audible: the old one fading out while the new one fades in
+	double gapMs;       // Silence between the old route's last audible frame and the new one's first
+};
+
+struct LatencyReport {
+	ma_uint32 markersSent;
+	ma_uint32 markersDetected;
+	double minMs;
+	double meanMs;
+	double p50Ms;
+	double p95Ms;
+	double p99Ms;
+	double maxMs;
+	std::vector<double> latenciesMs; // One per detected marker, in arrival order
+};
+
+// Device buffering of a redirect path, handed to miniaudio when its devices open. Zeros leave
+// the size and count to the backend (10 ms periods, 3 of them, with the low latency profile).
+// The low latency profile lets WASAPI shared mode go below the engine period (IAudioClient3).
+struct PeriodConfig {
+	ma_uint32 periodSizeInFrames = 0;
+	ma_uint32 periods = 0;
+	ma_performance_profile performanceProfile = ma_performance_profile_low_latency;
+};
+
+struct PeriodTrial {
+	ma_uint32 requestedFrames; // Period size asked for; 0 for the backend default
+	ma_uint32 playbackFrames;  // Period the playback device got
+	ma_uint32 captureFrames;   // Period the capture or loopback device got
+	ma_uint64 xruns;           // Underruns and overruns while it was observed
+	ma_uint64 lateCallbacks;   // Callbacks longer than their period while it was observed
+	bool late;                 // There was at least one
+	bool failed;               // The device failed, stalled or did not open with it
+	bool stable;
+};
+
+struct PeriodTuneReport {
+	PeriodConfig config;             // Smallest stable configuration; left applied
+	std::vector<PeriodTrial> trials; // In the order tried
+};
+
+// Sample rate converter in the devices' data converters, used where a device runs at another
+// rate than the redirect. Linear is miniaudio's own, with its default low-pass; the others are
+// the PolyphaseResampler tiers.
+enum class ResamplerQuality {
+	Linear,
+	Low,
+	Medium,
+	High
+};
+
+// One device of a running redirect: the format the device runs at (its shared-mode mix format)
+// and the one the redirect exchanges with it. miniaudio converts between the two in the
+// device's data converter; the flags say which of its stages are active.
+struct StreamConversion {
+	ma_format deviceFormat;
+	ma_uint32 deviceChannels;
+	ma_uint32 deviceSampleRate;
+	ma_format format;
+	ma_uint32 channels;
+	ma_uint32 sampleRate;
+	bool convertsFormat;
+	bool convertsChannels;
+	bool resamples;
+	ResamplerQuality resampler; // What resamples, when it does
+};
+
+struct RouteConversions {
+	bool running;
+	bool negotiated;          // Picked from the devices' native formats (auto format mode)
+	StreamConversion capture; // The loopback or capture device
+	StreamConversion playback;
+	bool convertsSamples;     // The redirect converts sample formats between the two sides itself
+	const char *routing;      // ChannelMatrix kind of the redirect's channel routing ("identity", ...)
+};
+
 using ResultVoid = Result<std::monostate, Error>;
 
 namespace AudioRedirector {
 	ResultVoid Initialize();
+	// Initialize on specific backends, e.g. ma_backend_custom with VirtualBackend::ContextConfig().
+	ResultVoid Initialize(const ma_backend *backends, ma_uint32 backendCount, const ma_context_config *config);
 	ResultVoid Uninitialize();
 
+	// Opt-in, once, from the application's main: on SIGSEGV, SIGILL, SIGFPE or SIGABRT (and
+	// unhandled structured exceptions on Windows) the audio events not logged yet are appended
+	// to the file at path, opened here, before the crash goes on to the handler installed
+	// before this one. The handler only formats into a static buffer and writes the file.
+	ResultVoid InstallCrashHandler(const std::string &path);
+
 	ResultVoid StartLoopbackRedirect(const ma_device_id *loopbackId, const ma_device_id *playbackId);
 	ResultVoid StartDuplexRedirect(const ma_device_id *captureId, const ma_device_id *playbackId);
 
 	ResultVoid StopLoopbackRedirect(); // Stop and uninitialize loopback and playback devices.
 	ResultVoid StopDuplexRedirect();   // Stop and uninitialize duplex device.
 
+	// A started loopback or duplex redirect is kept running until it is stopped: when one of its
+	// devices stops on its own (device notifications) or its playback callbacks miss several
+	// periods (a watchdog), a background thread reopens it on the same devices, retrying with
+	// a backoff that doubles up to 2 s while they stay unavailable. See RecoveryStats.
+
+	// Apply the current format and sample rate settings to a running redirect without a gap.
+	// The devices are reopened with the new settings beside the running ones, which keep
+	// playing meanwhile; once the new route plays audio the two crossfade over 20 ms and the
+	// old one is torn down. Blocks until done; on failure the running route is left untouched.
+	ResultVoid ReconfigureLoopbackRedirect();
+	ResultVoid ReconfigureDuplexRedirect();
+
+	// Move a running redirect to another playback device the same way: the new device is opened
+	// and started while the old one keeps playing, then the stream crossfades over. The report
+	// times the switch at callback resolution; gapMs stays 0 as long as the two overlap.
+	Result<SwitchReport, Error> SwitchLoopbackOutput(const ma_device_id *playbackId);
+	Result<SwitchReport, Error> SwitchDuplexOutput(const ma_device_id *playbackId);
+
+	// Redirect one capture or loopback device to any number of playback devices at once.
+	// The source uses the loopback settings (duplex settings for a capture source); each
+	// target gets its own read cursor, sample rate, volume and drift correction.
+	ResultVoid StartFanOutRedirect(
+		ma_device_type sourceType, const ma_device_id *sourceId, const FanOutTarget *targets, ma_uint32 targetCount
+	);
+	ResultVoid StopFanOutRedirect(); // Stop and uninitialize the source and all target devices.
+
+	ma_result SetFanOutVolume(ma_uint32 index, float volume);
+	double GetFanOutDriftPpm(ma_uint32 index);
+
+	// Mix several capture and/or loopback devices into one playback device. The mix runs at
+	// the loopback settings; each source is resampled and drift-locked onto that clock.
+	ResultVoid StartMixerRedirect(const MixerSource *sources, ma_uint32 sourceCount, const ma_device_id *playbackId);
+	ResultVoid StopMixerRedirect(); // Stop and uninitialize the playback and all source devices.
+
+	ma_result SetMixerVolume(ma_uint32 index, float volume);
+	MixerCost GetMixerCost();
+
+	// Device period size, count and performance profile of each path. They apply when the
+	// devices next open: on start, reconfiguration, output switch or recovery.
+	void SetLoopbackPeriodConfig(const PeriodConfig &config);
+	PeriodConfig GetLoopbackPeriodConfig();
+	void SetDuplexPeriodConfig(const PeriodConfig &config);
+	PeriodConfig GetDuplexPeriodConfig();
+
+	// Resampler of each path's devices, Medium by default. Applies when the devices next open.
+	void SetLoopbackResampler(ResamplerQuality quality);
+	ResamplerQuality GetLoopbackResampler();
+	void SetDuplexResampler(ResamplerQuality quality);
+	ResamplerQuality GetDuplexResampler();
+
+	// Record what the loopback or duplex redirect receives from its source device to a WAV
+	// file, in the format the source is opened at. The callback copies each block into a
+	// buffer of 2 s, which a background thread writes out in 64 KiB blocks; when the disk
+	// falls behind, frames are dropped and counted instead of holding up the audio. A redirect
+	// reopened at another format or channel count is not recorded until recording restarts.
+	// Requires a running redirect; stopping the redirect stops the recording.
+	ResultVoid StartLoopbackRecording(const std::string &path);
+	ResultVoid StopLoopbackRecording();
+	RecordingStats GetLoopbackRecordingStats();
+	ResultVoid StartDuplexRecording(const std::string &path);
+	ResultVoid StopDuplexRecording();
+	RecordingStats GetDuplexRecordingStats();
+
+	// Render a WAV file through the loopback or duplex path as fast as the CPU allows, without
+	// devices: the file stands in for the source device and the output file for the playback
+	// device. The path's data callbacks run on a route of their own, built from the same
+	// settings (formats, channels and routing, rate, volume, limiter) and fed in periods of the
+	// configured size, so the output matches what the playback device would be handed live bit
+	// for bit. The input is memory-mapped; where its format, channel count or rate differs from
+	// the capture side, it is converted as a capture device's converter would, with the path's
+	// resampler. In auto format mode both sides take the file's format instead. The loopback
+	// path starts with its jitter buffer pre-roll and is run on for as long after the input
+	// ends. Runs beside a live redirect.
+	Result<RenderReport, Error> RenderLoopbackFile(const std::string &inputPath, const std::string &outputPath);
+	Result<RenderReport, Error> RenderDuplexFile(const std::string &inputPath, const std::string &outputPath);
+
+	// Find the smallest stable period for the running redirect's devices. Each step halves the
+	// period the playback device got, applies it with the gapless reconfiguration and watches
+	// the redirect for observeMs of pipeline time. It stops at the first step with an xrun, a
+	// callback longer than its period, a device failure, or no smaller period from the backend,
+	// and keeps the last stable step. Blocks until done.
+	Result<PeriodTuneReport, Error> TuneLoopbackPeriod(ma_uint32 observeMs = 2000);
+	Result<PeriodTuneReport, Error> TuneDuplexPeriod(ma_uint32 observeMs = 2000);
+
+	// Measure the loopback path end to end. Runs the loopback redirect, plays a marker every
+	// intervalMs on the loopback source device, and detects it on a loopback capture of the
+	// playback device; the latency is the time from the marker leaving to it arriving there.
+	// Both ends are timed at the endpoints: the marker device's playback buffer (period size
+	// times periods) and the probe's capture buffer are taken off the callback times, so what
+	// remains is the redirect's own capture, jitter buffer and playback buffering.
+	// The two devices must differ. Blocks until markerCount markers arrived or timed out.
+	Result<LatencyReport, Error> MeasureLoopbackLatency(
+		const ma_device_id *loopbackId, const ma_device_id *playbackId, ma_uint32 markerCount = 20, ma_uint32 intervalMs = 250
+	);
+
 	Result<AudioDevices, Error> GetAudioDevices();
 
+	// The miniaudio context, for backend-specific queries (e.g. VirtualBackend::GetTimeSeconds).
+	const ma_context *GetContext();
+
+	// Printable form of a device ID for the active backend (e.g. the WASAPI endpoint ID).
+	std::string GetDeviceIdString(const ma_device_id &id);
+
+	// Frames delivered to the playback device since the redirect started, excluding the
+	// silence played while pre-rolling or underrunning. Safe from any thread.
+	ma_uint64 GetLoopbackFramesPlayed();
+	ma_uint64 GetDuplexFramesPlayed();
+
+	// Volumes are linear gains (boost above 1.0) applied in the data callbacks with a short
+	// ramp; setting one is a single atomic store and persists across redirect restarts.
 	Result<float, Error> GetPlaybackVolume();
 	ma_result SetPlaybackVolume(float volume);
 
 	Result<float, Error> GetDuplexVolume();
 	ma_result SetDuplexVolume(float volume);
 
+	// True-peak lookahead limiter after the volume stage of the loopback and duplex paths, off
+	// by default. Enabling and the lookahead apply on the next start or reconfiguration; the
+	// release applies immediately.
+	void SetLimiterEnabled(bool enabled);
+	bool IsLimiterEnabled();
+
+	void SetLimiterLookahead(ma_uint32 lookaheadMs);
+	ma_uint32 GetLimiterLookahead();
+
+	void SetLimiterRelease(ma_uint32 releaseMs);
+	ma_uint32 GetLimiterRelease();
+
+	LimiterStats GetPlaybackLimiterStats();
+	LimiterStats GetDuplexLimiterStats();
+
+	// Callback timing and flow counters of the loopback and duplex paths, recorded lock-free
+	// in the data callbacks and reset when a redirect starts or is reconfigured. The recovery
+	// counters cover the redirect since it was started. Safe from any thread.
+	RedirectorStats GetStats();
+
 	constexpr ma_format Formats[] = {
 		ma_format_f32,
 		ma_format_s32,
@@ -51,15 +380,70 @@ namespace AudioRedirector {
 		192000,
 	};
 
-	ma_format GetLoopbackFormat();
+	ma_format GetLoopbackFormat();         // Loopback capture side
+	ma_format GetLoopbackPlaybackFormat(); // Playback side
 	ma_uint32 GetLoopbackSampleRate();
 
-	void SetLoopbackFormat(ma_format format);
+	void SetLoopbackFormat(ma_format format);         // Sets both sides; override the playback side after
+	void SetLoopbackPlaybackFormat(ma_format format);
 	void SetLoopbackSampleRate(ma_uint32 sampleRate);
 
-	ma_format GetDuplexFormat();
+	// Channel counts of each side, 1 to MaxChannels; stereo by default.
+	constexpr ma_uint32 MaxChannels = 32;
+
+	ma_uint32 GetLoopbackChannels();         // Loopback capture side
+	ma_uint32 GetLoopbackPlaybackChannels(); // Playback side
+
+	void SetLoopbackChannels(ma_uint32 channels);         // Sets both sides; override the playback side after
+	void SetLoopbackPlaybackChannels(ma_uint32 channels);
+
+	// Routing matrix from the source channels to the playback channels, applied in the
+	// playback callback: each route adds a source channel to a playback channel at its gain,
+	// and routes to the same pair add up. Empty (the default) routes by channel position:
+	// matching positions pass through, mono goes to every speaker, and a smaller layout gets a
+	// downmix. Routes outside the channel counts are ignored. Applies when the devices next open.
+	void SetLoopbackRouting(const std::vector<ChannelRoute> &routes);
+	std::vector<ChannelRoute> GetLoopbackRouting();
+
+	// Auto format mode: open each device at its native sample format and channel count, and
+	// both at the native sample rate of the source device, in place of the settings above. When
+	// the two devices agree nothing is converted; when they do not, the playback device's
+	// converter alone resamples and the routing matrix maps the channels. Anything a backend
+	// does not report falls back to the settings. Applies when the devices next open.
+	void SetLoopbackAutoFormat(bool enabled);
+	bool IsLoopbackAutoFormat();
+
+	// What the running loopback route converts, and where, as published when it started.
+	RouteConversions GetLoopbackConversions();
+
+	ma_uint32 GetLoopbackLatency();          // Requested target latency in milliseconds.
+	ma_uint32 GetLoopbackEffectiveLatency(); // Current adaptive target; grows after underruns.
+
+	// Target ring latency (pre-roll) in milliseconds; applies to a running redirect too.
+	void SetLoopbackLatency(ma_uint32 latencyMs);
+
+	// Measured clock offset between the loopback and playback devices, in ppm.
+	// Positive when the loopback device runs faster; compensated by resampling on playback.
+	double GetLoopbackDriftPpm();
+
+	ma_format GetDuplexFormat();         // Capture side
+	ma_format GetDuplexPlaybackFormat(); // Playback side
 	ma_uint32 GetDuplexSampleRate();
 
-	void SetDuplexFormat(ma_format format);
+	void SetDuplexFormat(ma_format format);         // Sets both sides; override the playback side after
+	void SetDuplexPlaybackFormat(ma_format format);
 	void SetDuplexSampleRate(ma_uint32 sampleRate);
+
+	ma_uint32 GetDuplexChannels();         // Capture side
+	ma_uint32 GetDuplexPlaybackChannels(); // Playback side
+
+	void SetDuplexChannels(ma_uint32 channels);         // Sets both sides; override the playback side after
+	void SetDuplexPlaybackChannels(ma_uint32 channels);
+
+	void SetDuplexRouting(const std::vector<ChannelRoute> &routes); // As SetLoopbackRouting()
+	std::vector<ChannelRoute> GetDuplexRouting();
+
+	void SetDuplexAutoFormat(bool enabled); // As SetLoopbackAutoFormat(), the capture device being the source
+	bool IsDuplexAutoFormat();
+	RouteConversions GetDuplexConversions();
 }; // namespace AudioRedirector
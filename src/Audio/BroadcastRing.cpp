@@ -0,0 +1,69 @@
+#include "BroadcastRing.hpp"
+#include <cstring>
+#include <algorithm>
+
+ma_result BroadcastRing::Init(ma_uint32 bytesPerFrame, ma_uint32 minCapacityFrames) {
+	ma_uint32 capacity = 1;
+	while (capacity < minCapacityFrames) capacity <<= 1;
+
+	m_data = static_cast<ma_uint8 *>(ma_aligned_malloc(static_cast<size_t>(capacity) * bytesPerFrame, 64, nullptr));
+	if (m_data == nullptr) return MA_OUT_OF_MEMORY;
+
+	std::memset(m_data, 0, static_cast<size_t>(capacity) * bytesPerFrame);
+	m_bytesPerFrame = bytesPerFrame;
+	m_capacity = capacity;
+	m_mask = capacity - 1;
+	m_reserved.store(0, std::memory_order_relaxed);
+	m_written.store(0, std::memory_order_relaxed);
+	return MA_SUCCESS;
+}
+
+void BroadcastRing::Uninit() {
+	ma_aligned_free(m_data, nullptr);
+	m_data = nullptr;
+	m_capacity = 0;
+}
+
+void BroadcastRing::Write(const void *pFrames, ma_uint32 frameCount) {
+	const ma_uint8 *pSrc = static_cast<const ma_uint8 *>(pFrames);
+	ma_uint64 cursor = m_written.load(std::memory_order_relaxed);
+
+	// Never write more than one ring's worth per block; only the newest frames would survive anyway.
+	if (frameCount > m_capacity) {
+		pSrc += static_cast<size_t>(frameCount - m_capacity) * m_bytesPerFrame;
+		frameCount = m_capacity;
+	}
+
+	// Announce the range first so readers can detect that their data is being overwritten.
+	m_reserved.store(cursor + frameCount, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	while (frameCount > 0) {
+		const ma_uint32 offset = static_cast<ma_uint32>(cursor) & m_mask;
+		const ma_uint32 frames = std::min(frameCount, m_capacity - offset);
+		std::memcpy(m_data + static_cast<size_t>(offset) * m_bytesPerFrame, pSrc, static_cast<size_t>(frames) * m_bytesPerFrame);
+
+		pSrc += static_cast<size_t>(frames) * m_bytesPerFrame;
+		cursor += frames;
+		frameCount -= frames;
+	}
+
+	m_written.store(cursor, std::memory_order_release);
+}
+
+ma_uint32 BroadcastRing::Peek(ma_uint64 cursor, ma_uint32 frameCount, const void **ppFrames) const {
+	const ma_uint64 written = GetWriteCursor();
+	if (cursor >= written) return 0;
+
+	const ma_uint32 offset = static_cast<ma_uint32>(cursor) & m_mask;
+	const ma_uint64 available = written - cursor;
+	const ma_uint32 frames = static_cast<ma_uint32>(std::min<ma_uint64>({frameCount, available, m_capacity - offset}));
+
+	*ppFrames = m_data + static_cast<size_t>(offset) * m_bytesPerFrame;
+	return frames;
+}
+
+bool BroadcastRing::IsIntact(ma_uint64 cursor) const {
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return m_reserved.load(std::memory_order_relaxed) <= cursor + m_capacity;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <atomic>
+#include "miniaudio.h"
+
+// Single-writer, multi-reader ring of PCM frames. The writer copies each block in once and
+// never waits for readers; every reader keeps its own cursor (an absolute frame index) and
+// validates after reading that the writer has not lapped the region it just read.
+class BroadcastRing {
+public:
+	ma_result Init(ma_uint32 bytesPerFrame, ma_uint32 minCapacityFrames); // capacity is rounded up to a power of two
+	void Uninit();
+
+	// Writer side: copy frames in and publish them to all readers. Never blocks.
+	void Write(const void *pFrames, ma_uint32 frameCount);
+
+	// Absolute index one past the last published frame.
+	ma_uint64 GetWriteCursor() const { return m_written.load(std::memory_order_acquire); }
+
+	// Contiguous frames readable at cursor (stops at the wrap point); returns the count.
+	ma_uint32 Peek(ma_uint64 cursor, ma_uint32 frameCount, const void **ppFrames) const;
+
+	// True if the frames from cursor onwards were not overwritten while being read.
+	bool IsIntact(ma_uint64 cursor) const;
+
+	ma_uint32 GetCapacity() const { return m_capacity; }
+
+private:
+	ma_uint8 *m_data = nullptr;
+	ma_uint32 m_bytesPerFrame = 0;
+	ma_uint32 m_capacity = 0; // frames, power of two
+	ma_uint32 m_mask = 0;
+
+	alignas(64) std::atomic<ma_uint64> m_reserved = 0; // frames the writer may be overwriting
+	alignas(64) std::atomic<ma_uint64> m_written = 0;  // frames fully written
+};
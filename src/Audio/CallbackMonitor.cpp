@@ -0,0 +1,146 @@
+#include "CallbackMonitor.hpp"
+#include <bit>
+#include <algorithm>
+
+// Weight of the newest callback in the moving averages (the same smoothing as the mixer cost).
+static constexpr double kAverageWeight = 0.05;
+
+// Upper edge of a histogram bucket in microseconds; the last bucket is open ended.
+static double bucket_edge(ma_uint32 bucket) {
+	return (double)(1ull << bucket);
+}
+
+// Value below which a fraction p of the recorded samples fall, to bucket resolution.
+static double percentile(const ma_uint32 *histogram, double p) {
+	ma_uint64 total = 0;
+	for (ma_uint32 i = 0; i < CallbackHistogramBuckets; ++i) total += histogram[i];
+	if (total == 0) return 0.0;
+
+	const ma_uint64 rank = (ma_uint64)(p * total + 0.5);
+	ma_uint64 seen = 0;
+	for (ma_uint32 i = 0; i < CallbackHistogramBuckets; ++i) {
+		seen += histogram[i];
+		if (seen >= rank && histogram[i] > 0) return bucket_edge(i);
+	}
+	return bucket_edge(CallbackHistogramBuckets - 1);
+}
+
+void CallbackMonitor::Reset(ma_uint32 sampleRate) {
+	m_sampleRate = sampleRate;
+	m_lastStart = {};
+	m_flowing = false;
+
+	for (Counter *counter : {
+		&m_callbacks, &m_framesRequested, &m_framesDelivered,
+		&m_underruns, &m_underrunFrames, &m_overruns, &m_overrunFrames, &m_lateCallbacks
+	}) {
+		counter->store(0, std::memory_order_relaxed);
+	}
+	for (std::atomic<double> *value : {
+		&m_lastMicros, &m_averageMicros, &m_peakMicros,
+		&m_averageIntervalMicros, &m_peakIntervalMicros, &m_averageLoad, &m_peakLoad
+	}) {
+		value->store(0.0, std::memory_order_relaxed);
+	}
+	for (ma_uint32 i = 0; i < CallbackHistogramBuckets; ++i) {
+		m_durations[i].store(0, std::memory_order_relaxed);
+		m_intervals[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+CallbackMonitor::Clock::time_point CallbackMonitor::Begin() {
+	return Clock::now();
+}
+
+void CallbackMonitor::End(Clock::time_point start, ma_uint32 framesRequested, ma_uint32 framesDelivered, ma_uint32 framesDropped) {
+	const double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+	// --- Flow ---
+	add(m_callbacks, 1);
+	add(m_framesRequested, framesRequested);
+	add(m_framesDelivered, framesDelivered);
+
+	if (framesDropped > 0) {
+		add(m_overruns, 1);
+		add(m_overrunFrames, framesDropped);
+		if (m_recorder) m_recorder->Record(FlightRecorder::Event::Overrun, m_source, framesDropped, framesRequested);
+	}
+
+	const ma_uint32 framesPadded = framesRequested - std::min(framesRequested, framesDelivered + framesDropped);
+	if (framesPadded > 0 && m_flowing) {
+		add(m_underruns, 1);
+		add(m_underrunFrames, framesPadded);
+		if (m_recorder) m_recorder->Record(FlightRecorder::Event::Underrun, m_source, framesPadded, framesRequested);
+	}
+	m_flowing = m_flowing || framesDelivered > 0;
+
+	// --- Duration and load ---
+	const double average = m_averageMicros.load(std::memory_order_relaxed);
+	m_lastMicros.store(micros, std::memory_order_relaxed);
+	m_averageMicros.store(average == 0.0 ? micros : average + kAverageWeight * (micros - average), std::memory_order_relaxed);
+	m_peakMicros.store(std::max(m_peakMicros.load(std::memory_order_relaxed), micros), std::memory_order_relaxed);
+	record(m_durations, micros);
+
+	if (framesRequested > 0) {
+		const double load = micros * m_sampleRate / (1e6 * framesRequested);
+		const double averageLoad = m_averageLoad.load(std::memory_order_relaxed);
+		m_averageLoad.store(averageLoad == 0.0 ? load : averageLoad + kAverageWeight * (load - averageLoad), std::memory_order_relaxed);
+		m_peakLoad.store(std::max(m_peakLoad.load(std::memory_order_relaxed), load), std::memory_order_relaxed);
+
+		if (load > 1.0) {
+			add(m_lateCallbacks, 1);
+			if (m_recorder) {
+				const double periodMicros = 1e6 * framesRequested / m_sampleRate;
+				m_recorder->Record(FlightRecorder::Event::LateCallback, m_source, (ma_uint32)micros, (ma_uint32)periodMicros);
+			}
+		}
+	}
+
+	// --- Interval since the previous callback ---
+	if (m_lastStart != Clock::time_point{}) {
+		const double interval = std::chrono::duration<double, std::micro>(start - m_lastStart).count();
+		const double averageInterval = m_averageIntervalMicros.load(std::memory_order_relaxed);
+		m_averageIntervalMicros.store(
+			averageInterval == 0.0 ? interval : averageInterval + kAverageWeight * (interval - averageInterval),
+			std::memory_order_relaxed
+		);
+		m_peakIntervalMicros.store(std::max(m_peakIntervalMicros.load(std::memory_order_relaxed), interval), std::memory_order_relaxed);
+		record(m_intervals, interval);
+	}
+	m_lastStart = start;
+}
+
+void CallbackMonitor::record(std::atomic<ma_uint32> *histogram, double micros) {
+	// Bucket 0 holds [0, 1) us and bucket i holds [2^(i-1), 2^i) us.
+	const ma_uint64 whole = micros > 0.0 ? (ma_uint64)micros : 0;
+	const ma_uint32 bucket = std::min((ma_uint32)std::bit_width(whole), CallbackHistogramBuckets - 1);
+	histogram[bucket].store(histogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+CallbackStats CallbackMonitor::Snapshot() const {
+	CallbackStats stats = {};
+	stats.callbacks = m_callbacks.load(std::memory_order_relaxed);
+	stats.framesRequested = m_framesRequested.load(std::memory_order_relaxed);
+	stats.framesDelivered = m_framesDelivered.load(std::memory_order_relaxed);
+	stats.underruns = m_underruns.load(std::memory_order_relaxed);
+	stats.underrunFrames = m_underrunFrames.load(std::memory_order_relaxed);
+	stats.overruns = m_overruns.load(std::memory_order_relaxed);
+	stats.overrunFrames = m_overrunFrames.load(std::memory_order_relaxed);
+	stats.lateCallbacks = m_lateCallbacks.load(std::memory_order_relaxed);
+
+	stats.lastMicros = m_lastMicros.load(std::memory_order_relaxed);
+	stats.averageMicros = m_averageMicros.load(std::memory_order_relaxed);
+	stats.peakMicros = m_peakMicros.load(std::memory_order_relaxed);
+	stats.averageIntervalMicros = m_averageIntervalMicros.load(std::memory_order_relaxed);
+	stats.peakIntervalMicros = m_peakIntervalMicros.load(std::memory_order_relaxed);
+	stats.loadPercent = 100.0 * m_averageLoad.load(std::memory_order_relaxed);
+	stats.peakLoadPercent = 100.0 * m_peakLoad.load(std::memory_order_relaxed);
+
+	for (ma_uint32 i = 0; i < CallbackHistogramBuckets; ++i) {
+		stats.durationHistogram[i] = m_durations[i].load(std::memory_order_relaxed);
+		stats.intervalHistogram[i] = m_intervals[i].load(std::memory_order_relaxed);
+	}
+	stats.p99Micros = std::min(percentile(stats.durationHistogram, 0.99), stats.peakMicros);
+	stats.p99IntervalMicros = std::min(percentile(stats.intervalHistogram, 0.99), stats.peakIntervalMicros);
+	return stats;
+}
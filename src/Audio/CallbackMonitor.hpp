@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include "miniaudio.h"
+#include "AudioRedirector.hpp"
+#include "FlightRecorder.hpp"
+
+// Timing and flow counters for one data callback, recorded from inside the callback.
+//
+// Begin() and End() bracket the callback: End() records its duration, the interval since the
+// previous callback (both into log2 microsecond histograms), the frames asked for, delivered
+// and dropped, and the DSP load (duration relative to the time the frames represent), counting
+// the callbacks whose load exceeded 1. Frames
+// neither delivered nor dropped were padded with silence; once audio has started flowing that
+// is an underrun, before it is the pre-roll. Dropped frames are an overrun.
+//
+// There is one writer, so every counter is a relaxed atomic updated with a load and a store:
+// no locks, no read-modify-write and no allocation on the callback thread. Snapshot() is safe
+// from any thread; its fields may straddle two callbacks but each one is whole.
+//
+// With a recorder set, every underrun, overrun and callback longer than its period is also
+// recorded there as an event.
+class CallbackMonitor {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Clear all counters; the device must not be running.
+	void Reset(ma_uint32 sampleRate);
+	void SetRecorder(FlightRecorder *recorder, FlightRecorder::Source source) { m_recorder = recorder; m_source = source; }
+	FlightRecorder *GetRecorder() const { return m_recorder; } // Null for a route nobody monitors
+
+	// --- Callback thread ---
+	Clock::time_point Begin();
+	void End(Clock::time_point start, ma_uint32 framesRequested, ma_uint32 framesDelivered, ma_uint32 framesDropped = 0);
+
+	// --- Any thread ---
+	CallbackStats Snapshot() const;
+	ma_uint64 GetCallbacks() const { return m_callbacks.load(std::memory_order_relaxed); }
+
+private:
+	using Counter = std::atomic<ma_uint64>;
+
+	static void add(Counter &counter, ma_uint64 value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+	static void record(std::atomic<ma_uint32> *histogram, double micros);
+
+	ma_uint32 m_sampleRate = 48000;
+	Clock::time_point m_lastStart = {};
+	bool m_flowing = false; // audio delivered at least once; earlier padding is the pre-roll
+	FlightRecorder *m_recorder = nullptr;
+	FlightRecorder::Source m_source = FlightRecorder::Source::LoopbackCapture;
+
+	Counter m_callbacks = 0;
+	Counter m_framesRequested = 0;
+	Counter m_framesDelivered = 0;
+	Counter m_underruns = 0;
+	Counter m_underrunFrames = 0;
+	Counter m_overruns = 0;
+	Counter m_overrunFrames = 0;
+	Counter m_lateCallbacks = 0;
+
+	std::atomic<double> m_lastMicros = 0.0;
+	std::atomic<double> m_averageMicros = 0.0;
+	std::atomic<double> m_peakMicros = 0.0;
+	std::atomic<double> m_averageIntervalMicros = 0.0;
+	std::atomic<double> m_peakIntervalMicros = 0.0;
+	std::atomic<double> m_averageLoad = 0.0;
+	std::atomic<double> m_peakLoad = 0.0;
+
+	std::atomic<ma_uint32> m_durations[CallbackHistogramBuckets] = {};
+	std::atomic<ma_uint32> m_intervals[CallbackHistogramBuckets] = {};
+};
@@ -0,0 +1,359 @@
+#include "ChannelMatrix.hpp"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define CHANNEL_MATRIX_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define CHANNEL_MATRIX_NEON
+#endif
+
+static constexpr float kMinus3dB = 0.70710678f;
+
+namespace {
+	enum class Side
+	{
+		Left,
+		Right,
+		Center,
+		Lfe,
+		Other
+	};
+
+	Side side_of(ma_channel position) {
+		switch (position) {
+			case MA_CHANNEL_FRONT_LEFT:
+			case MA_CHANNEL_FRONT_LEFT_CENTER:
+			case MA_CHANNEL_BACK_LEFT:
+			case MA_CHANNEL_SIDE_LEFT:
+			case MA_CHANNEL_TOP_FRONT_LEFT:
+			case MA_CHANNEL_TOP_BACK_LEFT:
+				return Side::Left;
+			case MA_CHANNEL_FRONT_RIGHT:
+			case MA_CHANNEL_FRONT_RIGHT_CENTER:
+			case MA_CHANNEL_BACK_RIGHT:
+			case MA_CHANNEL_SIDE_RIGHT:
+			case MA_CHANNEL_TOP_FRONT_RIGHT:
+			case MA_CHANNEL_TOP_BACK_RIGHT:
+				return Side::Right;
+			case MA_CHANNEL_MONO:
+			case MA_CHANNEL_FRONT_CENTER:
+			case MA_CHANNEL_BACK_CENTER:
+			case MA_CHANNEL_TOP_CENTER:
+			case MA_CHANNEL_TOP_FRONT_CENTER:
+			case MA_CHANNEL_TOP_BACK_CENTER:
+				return Side::Center;
+			case MA_CHANNEL_LFE:
+				return Side::Lfe;
+			default:
+				return Side::Other;
+		}
+	}
+}
+
+bool ChannelMatrix::Set(ma_uint32 inputChannels, ma_uint32 outputChannels, const float *pGains) {
+	if (inputChannels == 0 || outputChannels == 0) return false;
+	if (inputChannels > MaxChannels || outputChannels > MaxChannels) return false;
+
+	m_inputChannels = inputChannels;
+	m_outputChannels = outputChannels;
+	m_gains.assign(pGains, pGains + (size_t)inputChannels * outputChannels);
+
+	// Classify, and build the tables of the kind's kernel.
+	bool identity = inputChannels == outputChannels;
+	bool sparse = true;
+	for (ma_uint32 o = 0; o < outputChannels; ++o) {
+		ma_uint32 taps = 0;
+		for (ma_uint32 i = 0; i < inputChannels; ++i) {
+			const float gain = GetGain(o, i);
+			if (gain != (i == o ? 1.0f : 0.0f)) identity = false;
+			if (gain != 0.0f) ++taps;
+		}
+		if (taps > 2) sparse = false;
+	}
+	const bool swap = inputChannels == 2 && outputChannels == 2
+		&& GetGain(0, 0) == 0.0f && GetGain(0, 1) == 1.0f && GetGain(1, 0) == 1.0f && GetGain(1, 1) == 0.0f;
+
+	m_taps.clear();
+	m_columns.clear();
+
+	if (identity) {
+		m_kind = Kind::Identity;
+	} else if (swap) {
+		m_kind = Kind::Swap;
+	} else if (sparse) {
+		m_kind = Kind::Sparse;
+		m_taps.assign(outputChannels, Taps{{0, 0}, {0.0f, 0.0f}});
+		for (ma_uint32 o = 0; o < outputChannels; ++o) {
+			ma_uint32 tap = 0;
+			for (ma_uint32 i = 0; i < inputChannels; ++i) {
+				if (GetGain(o, i) == 0.0f) continue;
+				m_taps[o].input[tap] = i;
+				m_taps[o].gain[tap] = GetGain(o, i);
+				++tap;
+			}
+		}
+	} else {
+		m_kind = Kind::Dense;
+		m_stride = (outputChannels + 3) & ~3u;
+		m_columns.assign((size_t)m_stride * inputChannels, 0.0f);
+		for (ma_uint32 i = 0; i < inputChannels; ++i) {
+			for (ma_uint32 o = 0; o < outputChannels; ++o) m_columns[(size_t)i * m_stride + o] = GetGain(o, i);
+			// A stereo output runs two frames per vector; its gains are repeated for the second.
+			if (outputChannels == 2) {
+				m_columns[(size_t)i * m_stride + 2] = GetGain(0, i);
+				m_columns[(size_t)i * m_stride + 3] = GetGain(1, i);
+			}
+		}
+	}
+	return true;
+}
+
+bool ChannelMatrix::SetDefault(ma_uint32 inputChannels, ma_uint32 outputChannels) {
+	if (inputChannels == 0 || outputChannels == 0) return false;
+	if (inputChannels > MaxChannels || outputChannels > MaxChannels) return false;
+
+	ma_channel in[MaxChannels];
+	ma_channel out[MaxChannels];
+	ma_channel_map_init_standard(ma_standard_channel_map_default, in, MaxChannels, inputChannels);
+	ma_channel_map_init_standard(ma_standard_channel_map_default, out, MaxChannels, outputChannels);
+
+	std::vector<float> gains((size_t)inputChannels * outputChannels, 0.0f);
+	const auto gain = [&](ma_uint32 o, ma_uint32 i) -> float & { return gains[(size_t)o * inputChannels + i]; };
+	const auto find = [&](ma_channel position) {
+		return (ma_uint32)(std::find(out, out + outputChannels, position) - out);
+	};
+
+	if (inputChannels == outputChannels) {
+		for (ma_uint32 c = 0; c < inputChannels; ++c) gain(c, c) = 1.0f;
+	} else if (inputChannels == 1) {
+		for (ma_uint32 o = 0; o < outputChannels; ++o) gain(o, 0) = out[o] == MA_CHANNEL_LFE ? 0.0f : 1.0f;
+	} else if (outputChannels == 1) {
+		const auto heard = (ma_uint32)std::count_if(in, in + inputChannels, [](ma_channel c) { return c != MA_CHANNEL_LFE; });
+		for (ma_uint32 i = 0; i < inputChannels; ++i) gain(0, i) = in[i] == MA_CHANNEL_LFE ? 0.0f : 1.0f / heard;
+	} else {
+		const ma_uint32 left = find(MA_CHANNEL_FRONT_LEFT);
+		const ma_uint32 right = find(MA_CHANNEL_FRONT_RIGHT);
+		const ma_uint32 center = find(MA_CHANNEL_FRONT_CENTER);
+
+		for (ma_uint32 i = 0; i < inputChannels; ++i) {
+			const ma_uint32 same = find(in[i]);
+			if (same < outputChannels) {
+				gain(same, i) = 1.0f;
+				continue;
+			}
+
+			// Positions the output lacks fold into the front; the LFE and aux channels are dropped.
+			switch (side_of(in[i])) {
+				case Side::Left:
+					if (left < outputChannels) gain(left, i) = kMinus3dB;
+					break;
+				case Side::Right:
+					if (right < outputChannels) gain(right, i) = kMinus3dB;
+					break;
+				case Side::Center:
+					if (center < outputChannels) {
+						gain(center, i) = 1.0f;
+					} else {
+						if (left < outputChannels) gain(left, i) = kMinus3dB;
+						if (right < outputChannels) gain(right, i) = kMinus3dB;
+					}
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	return Set(inputChannels, outputChannels, gains.data());
+}
+
+// ============================================================================
+// Kernels
+// ============================================================================
+
+void ChannelMatrix::Process(float *pOut, const float *pIn, ma_uint32 frameCount) const {
+	const ma_uint32 inChannels = m_inputChannels;
+	const ma_uint32 outChannels = m_outputChannels;
+
+	switch (m_kind) {
+		case Kind::Identity: {
+			std::memcpy(pOut, pIn, (size_t)frameCount * inChannels * sizeof(float));
+			break;
+		}
+
+		case Kind::Swap: {
+			const size_t count = (size_t)frameCount * 2;
+			size_t i = 0;
+#if defined(CHANNEL_MATRIX_SSE)
+			for (; i + 8 <= count; i += 8) {
+				const __m128 a = _mm_loadu_ps(pIn + i);
+				const __m128 b = _mm_loadu_ps(pIn + i + 4);
+				_mm_storeu_ps(pOut + i, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+				_mm_storeu_ps(pOut + i + 4, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)));
+			}
+#elif defined(CHANNEL_MATRIX_NEON)
+			for (; i + 8 <= count; i += 8) {
+				vst1q_f32(pOut + i, vrev64q_f32(vld1q_f32(pIn + i)));
+				vst1q_f32(pOut + i + 4, vrev64q_f32(vld1q_f32(pIn + i + 4)));
+			}
+#endif
+			for (; i < count; i += 2) {
+				const float l = pIn[i];
+				pOut[i] = pIn[i + 1];
+				pOut[i + 1] = l;
+			}
+			break;
+		}
+
+		case Kind::Sparse: {
+			ma_uint32 frame = 0;
+
+			// Stereo to stereo (a channel to both sides, a balance) works on two frames per
+			// vector: each output is the left input spread over the frame times its gain, plus
+			// the right input likewise.
+			if (inChannels == 2 && outChannels == 2) {
+				const float gl0 = GetGain(0, 0), gl1 = GetGain(1, 0);
+				const float gr0 = GetGain(0, 1), gr1 = GetGain(1, 1);
+#if defined(CHANNEL_MATRIX_SSE)
+				const __m128 left = _mm_setr_ps(gl0, gl1, gl0, gl1);
+				const __m128 right = _mm_setr_ps(gr0, gr1, gr0, gr1);
+				for (; frame + 2 <= frameCount; frame += 2) {
+					const __m128 x = _mm_loadu_ps(pIn + frame * 2);
+					const __m128 l = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0));
+					const __m128 r = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1));
+					_mm_storeu_ps(pOut + frame * 2, _mm_add_ps(_mm_mul_ps(l, left), _mm_mul_ps(r, right)));
+				}
+#elif defined(CHANNEL_MATRIX_NEON)
+				const float32x4_t left = {gl0, gl1, gl0, gl1};
+				const float32x4_t right = {gr0, gr1, gr0, gr1};
+				for (; frame + 2 <= frameCount; frame += 2) {
+					const float32x4x2_t split = vtrnq_f32(vld1q_f32(pIn + frame * 2), vld1q_f32(pIn + frame * 2)); // L L L' L', R R R' R'
+					vst1q_f32(pOut + frame * 2, vmlaq_f32(vmulq_f32(split.val[0], left), split.val[1], right));
+				}
+#endif
+			}
+
+			// Mono to stereo is the common upmix; it is an interleave of the input with itself.
+			if (inChannels == 1 && outChannels == 2 && m_taps[0].gain[1] == 0.0f && m_taps[1].gain[1] == 0.0f) {
+				const float g0 = m_taps[0].gain[0];
+				const float g1 = m_taps[1].gain[0];
+#if defined(CHANNEL_MATRIX_SSE)
+				const __m128 gains = _mm_setr_ps(g0, g1, g0, g1);
+				for (; frame + 4 <= frameCount; frame += 4) {
+					const __m128 x = _mm_loadu_ps(pIn + frame);
+					_mm_storeu_ps(pOut + frame * 2 + 0, _mm_mul_ps(_mm_unpacklo_ps(x, x), gains));
+					_mm_storeu_ps(pOut + frame * 2 + 4, _mm_mul_ps(_mm_unpackhi_ps(x, x), gains));
+				}
+#elif defined(CHANNEL_MATRIX_NEON)
+				const float32x4_t gains = {g0, g1, g0, g1};
+				for (; frame + 4 <= frameCount; frame += 4) {
+					const float32x4x2_t pairs = vzipq_f32(vld1q_f32(pIn + frame), vld1q_f32(pIn + frame));
+					vst1q_f32(pOut + frame * 2 + 0, vmulq_f32(pairs.val[0], gains));
+					vst1q_f32(pOut + frame * 2 + 4, vmulq_f32(pairs.val[1], gains));
+				}
+#endif
+			}
+
+			const Taps *taps = m_taps.data();
+			for (; frame < frameCount; ++frame) {
+				const float *in = pIn + (size_t)frame * inChannels;
+				float *out = pOut + (size_t)frame * outChannels;
+				for (ma_uint32 o = 0; o < outChannels; ++o) {
+					out[o] = in[taps[o].input[0]] * taps[o].gain[0] + in[taps[o].input[1]] * taps[o].gain[1];
+				}
+			}
+			break;
+		}
+
+		case Kind::Dense: {
+			const float *columns = m_columns.data();
+			const ma_uint32 stride = m_stride;
+			ma_uint32 frame = 0;
+
+#if defined(CHANNEL_MATRIX_SSE) || defined(CHANNEL_MATRIX_NEON)
+			// A downmix to stereo fills half a vector per frame; run two frames per vector instead.
+			if (outChannels == 2) {
+				for (; frame + 2 <= frameCount; frame += 2) {
+					const float *in0 = pIn + (size_t)frame * inChannels;
+					const float *in1 = in0 + inChannels;
+	#if defined(CHANNEL_MATRIX_SSE)
+					__m128 acc = _mm_setzero_ps();
+					for (ma_uint32 i = 0; i < inChannels; ++i) {
+						const __m128 x = _mm_unpacklo_ps(_mm_set1_ps(in0[i]), _mm_set1_ps(in1[i])); // a b a b
+						acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 0, 0)), _mm_loadu_ps(columns + (size_t)i * stride)));
+					}
+					_mm_storeu_ps(pOut + frame * 2, acc);
+	#else
+					float32x4_t acc = vdupq_n_f32(0.0f);
+					for (ma_uint32 i = 0; i < inChannels; ++i) {
+						const float32x4_t x = vcombine_f32(vdup_n_f32(in0[i]), vdup_n_f32(in1[i]));
+						acc = vmlaq_f32(acc, x, vld1q_f32(columns + (size_t)i * stride));
+					}
+					vst1q_f32(pOut + frame * 2, acc);
+	#endif
+				}
+			}
+#endif
+
+			for (; frame < frameCount; ++frame) {
+				const float *in = pIn + (size_t)frame * inChannels;
+				float *out = pOut + (size_t)frame * outChannels;
+
+#if defined(CHANNEL_MATRIX_SSE) || defined(CHANNEL_MATRIX_NEON)
+				// Four outputs at a time: each input broadcast against its column of gains.
+				for (ma_uint32 o = 0; o < outChannels; o += 4) {
+	#if defined(CHANNEL_MATRIX_SSE)
+					__m128 acc = _mm_setzero_ps();
+					for (ma_uint32 i = 0; i < inChannels; ++i) {
+						acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(in[i]), _mm_loadu_ps(columns + (size_t)i * stride + o)));
+					}
+					if (o + 4 <= outChannels) {
+						_mm_storeu_ps(out + o, acc);
+						continue;
+					}
+					float rest[4];
+					_mm_storeu_ps(rest, acc);
+	#else
+					float32x4_t acc = vdupq_n_f32(0.0f);
+					for (ma_uint32 i = 0; i < inChannels; ++i) {
+						acc = vmlaq_n_f32(acc, vld1q_f32(columns + (size_t)i * stride + o), in[i]);
+					}
+					if (o + 4 <= outChannels) {
+						vst1q_f32(out + o, acc);
+						continue;
+					}
+					float rest[4];
+					vst1q_f32(rest, acc);
+	#endif
+					std::memcpy(out + o, rest, (outChannels - o) * sizeof(float));
+				}
+#else
+				for (ma_uint32 o = 0; o < outChannels; ++o) {
+					float sum = 0.0f;
+					for (ma_uint32 i = 0; i < inChannels; ++i) sum += in[i] * columns[(size_t)i * stride + o];
+					out[o] = sum;
+				}
+#endif
+			}
+			break;
+		}
+	}
+}
+
+const char *ChannelMatrix::to_string(Kind kind) {
+	switch (kind) {
+		case Kind::Identity:
+			return "identity";
+		case Kind::Swap:
+			return "swap";
+		case Kind::Sparse:
+			return "sparse";
+		case Kind::Dense:
+			return "dense";
+		default:
+			return "unknown";
+	}
+}
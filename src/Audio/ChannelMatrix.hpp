@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include "miniaudio.h"
+
+// Channel routing between interleaved f32 buffers: output channel o gets the sum over input
+// channels i of in[i] * gain(o, i).
+//
+// The matrix is classified once when it is set, and Process() runs the kernel of its kind:
+// Identity is a memcpy, Swap exchanges the two channels of a stereo stream with a vector
+// shuffle, Sparse (at most two inputs per output: channel picks, mono to both sides, a
+// swap of two of many) reads only those inputs, and Dense accumulates one vector of output
+// gains per input channel. SSE on x86, NEON on ARM, scalar otherwise, as in MixKernels.
+class ChannelMatrix {
+public:
+	static constexpr ma_uint32 MaxChannels = 32;
+
+	enum class Kind
+	{
+		Identity,
+		Swap,
+		Sparse,
+		Dense
+	};
+
+	// outputChannels rows of inputChannels gains. False when a count is 0 or above MaxChannels.
+	bool Set(ma_uint32 inputChannels, ma_uint32 outputChannels, const float *pGains);
+
+	// Route by channel position in miniaudio's standard channel maps: matching positions
+	// pass through, mono goes to every speaker but the LFE, a mono output averages the
+	// inputs, and a downmix folds centre, side and back channels into the front pair at -3 dB.
+	bool SetDefault(ma_uint32 inputChannels, ma_uint32 outputChannels);
+
+	// pOut holds frameCount frames of output channels; it must not overlap pIn.
+	void Process(float *pOut, const float *pIn, ma_uint32 frameCount) const;
+
+	Kind GetKind() const { return m_kind; }
+	bool IsIdentity() const { return m_kind == Kind::Identity; }
+	ma_uint32 GetInputChannels() const { return m_inputChannels; }
+	ma_uint32 GetOutputChannels() const { return m_outputChannels; }
+	float GetGain(ma_uint32 output, ma_uint32 input) const { return m_gains[(size_t)output * m_inputChannels + input]; }
+
+	static const char *to_string(Kind kind);
+
+private:
+	struct Taps {
+		ma_uint32 input[2]; // Unused taps read input 0 at gain 0
+		float gain[2];
+	};
+
+	ma_uint32 m_inputChannels = 2;
+	ma_uint32 m_outputChannels = 2;
+	Kind m_kind = Kind::Identity;
+	std::vector<float> m_gains = {1.0f, 0.0f, 0.0f, 1.0f}; // Row-major, as set
+	std::vector<Taps> m_taps;                               // Sparse: one per output channel
+	std::vector<float> m_columns;                           // Dense: per input, the output gains padded to m_stride
+	ma_uint32 m_stride = 0;
+};
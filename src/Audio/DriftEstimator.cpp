@@ -0,0 +1,43 @@
+#include "DriftEstimator.hpp"
+#include <algorithm>
+
+// Loop constants, in ppm per second of fill error (and per second squared for the integral).
+// Critically damped with a ~100 s settling time; fast enough for crystal drift, slow enough
+// that the correction never becomes an audible pitch change.
+static constexpr double kProportionalGain = 2.0e4;
+static constexpr double kIntegralGain = 1.0e2;
+static constexpr double kSmoothingSeconds = 2.0; // time constant of the fill level filter
+
+void DriftEstimator::Reset(ma_uint32 sampleRate) {
+	m_sampleRate = sampleRate;
+	m_smoothedFill = -1.0;
+	m_integralPpm = 0.0;
+	m_step = 1.0;
+	m_driftPpm.store(0.0, std::memory_order_relaxed);
+}
+
+double DriftEstimator::Update(ma_uint32 fillFrames, ma_uint32 targetFrames, ma_uint32 frameCount) {
+	const double dt = static_cast<double>(frameCount) / m_sampleRate;
+
+	if (m_smoothedFill < 0.0) {
+		m_smoothedFill = fillFrames;
+	} else {
+		const double alpha = std::min(dt / kSmoothingSeconds, 1.0);
+		m_smoothedFill += alpha * (fillFrames - m_smoothedFill);
+	}
+
+	const double error = (m_smoothedFill - targetFrames) / m_sampleRate; // seconds
+
+	m_integralPpm = std::clamp(m_integralPpm + kIntegralGain * error * dt, -MaxCorrectionPpm, MaxCorrectionPpm);
+	const double correctionPpm = std::clamp(
+		m_integralPpm + kProportionalGain * error, -MaxCorrectionPpm, MaxCorrectionPpm
+	);
+
+	m_step = 1.0 + correctionPpm * 1e-6;
+	m_driftPpm.store(m_integralPpm, std::memory_order_relaxed);
+	return m_step;
+}
+
+double DriftEstimator::GetDriftPpm() const {
+	return m_driftPpm.load(std::memory_order_relaxed);
+}
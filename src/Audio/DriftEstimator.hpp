@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include "miniaudio.h"
+
+// Estimates the clock offset between a ring writer and reader from the ring fill level and
+// turns it into a resampling step for the reader. A PI loop on the smoothed fill error: the
+// integral term converges to the actual clock offset, the proportional term pulls the fill
+// level back to the target.
+//
+// Update() must only be called from the reader; GetDriftPpm() is safe from any thread.
+class DriftEstimator {
+public:
+	static constexpr double MaxCorrectionPpm = 1000.0;
+
+	void Reset(ma_uint32 sampleRate);
+
+	// Feed one reader period; returns the step (input frames per output frame) to resample with.
+	double Update(ma_uint32 fillFrames, ma_uint32 targetFrames, ma_uint32 frameCount);
+
+	// Last computed step; 1.0 until the first Update().
+	double GetStep() const { return m_step; }
+
+	// Measured clock offset in ppm; positive when the writer runs faster than the reader.
+	double GetDriftPpm() const;
+
+private:
+	ma_uint32 m_sampleRate = 48000;
+	double m_smoothedFill = -1.0; // frames; negative until the first observation
+	double m_integralPpm = 0.0;
+	double m_step = 1.0;
+
+	std::atomic<double> m_driftPpm = 0.0;
+};
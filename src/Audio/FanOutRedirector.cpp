@@ -0,0 +1,245 @@
+#include "AudioRedirector.hpp"
+#include <format>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+
+#include "MAConvert.hpp"
+#include "AudioInternal.hpp"
+#include "BroadcastRing.hpp"
+#include "RingReader.hpp"
+#include "GainStage.hpp"
+#include "SampleConvert.hpp"
+#include "ChannelMatrix.hpp"
+
+namespace internal::fanout {
+    constexpr ma_uint32 chunkFrames = 1024; // Output side processing block size
+
+    struct Output {
+        ma_device device = {};
+        RingReader reader;                 // Own cursor, jitter buffer and drift/rate resampler
+        GainStage gain;                    // Ramped per-output volume
+        ma_uint32 channels = 2;            // Of the device
+        ChannelMatrix routing;             // Source channels -> this output's channels
+        std::vector<float> unrouted;       // f32 reader output at the source channels, unless routing is the identity
+        std::vector<float> scratch;        // f32 staging between routing and device
+    };
+
+    ma_format format = ma_format_f32;         // Source (and ring) format
+    ma_format playbackFormat = ma_format_f32; // Format of every output device
+    ma_uint32 channels = 2;                   // Source (and ring) channels
+    ma_uint32 sampleRate = 48000;
+
+    ma_device sourceDevice = {};
+    BroadcastRing ring;
+    std::vector<std::unique_ptr<Output>> outputs;
+    std::mutex mutex; // Held by Start and Stop throughout, and by the accessors into outputs
+
+    void stop();
+    void stop_and_uninit(ma_device *device);
+
+    void data_callback_source(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+    void data_callback_output(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+}; // namespace internal::fanout
+
+// ============================================================================
+// Public API accessors
+// ============================================================================
+
+ma_result AudioRedirector::SetFanOutVolume(ma_uint32 index, float volume) {
+    std::lock_guard lock(internal::fanout::mutex);
+    if (index >= internal::fanout::outputs.size()) return MA_INVALID_ARGS;
+    internal::fanout::outputs[index]->gain.SetTarget(volume);
+    return MA_SUCCESS;
+}
+
+double AudioRedirector::GetFanOutDriftPpm(ma_uint32 index) {
+    std::lock_guard lock(internal::fanout::mutex);
+    if (index >= internal::fanout::outputs.size()) return 0.0;
+    return internal::fanout::outputs[index]->reader.GetDriftPpm();
+}
+
+// ============================================================================
+// Main Implementation
+// ============================================================================
+
+ResultVoid AudioRedirector::StartFanOutRedirect(
+    ma_device_type sourceType, const ma_device_id *sourceId, const FanOutTarget *targets, ma_uint32 targetCount
+) {
+    using namespace internal::fanout;
+
+    if (sourceType != ma_device_type_capture && sourceType != ma_device_type_loopback) {
+        return Error("Fan-out source must be a capture or loopback device.");
+    }
+    if (targets == nullptr || targetCount == 0) {
+        return Error("Fan-out requires at least one playback device.");
+    }
+
+    std::lock_guard lock(mutex);
+    stop(); // Restart from a clean state if already running
+
+    const bool isLoopback = sourceType == ma_device_type_loopback;
+    format = isLoopback ? GetLoopbackFormat() : GetDuplexFormat();
+    playbackFormat = isLoopback ? GetLoopbackPlaybackFormat() : GetDuplexPlaybackFormat();
+    channels = isLoopback ? GetLoopbackChannels() : GetDuplexChannels();
+    sampleRate = isLoopback ? GetLoopbackSampleRate() : GetDuplexSampleRate();
+    const ma_uint32 latencyMs = GetLoopbackLatency();
+    const ResamplerQuality resampler = isLoopback ? GetLoopbackResampler() : GetDuplexResampler();
+
+    // --- Configure source ---
+    ma_device_config config = ma_device_config_init(sourceType);
+    config.capture.pDeviceID = sourceId;
+    config.capture.format = format;
+    config.capture.channels = channels;
+    config.sampleRate = sampleRate;
+    config.dataCallback = data_callback_source;
+
+    ma_result result = ma_device_init(&internal::context, &config, &sourceDevice);
+    if (result != MA_SUCCESS) {
+        return Error(std::format(
+            "Failed to initialize fan-out source device ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    // --- Configure outputs ---
+    for (ma_uint32 i = 0; i < targetCount; ++i) {
+        auto output = std::make_unique<Output>();
+        const ma_uint32 outputRate = targets[i].sampleRate != 0 ? targets[i].sampleRate : sampleRate;
+
+        output->channels = targets[i].channels != 0 ? std::min(targets[i].channels, MaxChannels) : channels;
+
+        output->reader.Reset(channels, sampleRate, outputRate, latencyMs, chunkFrames, resampler);
+        output->gain.SetTarget(targets[i].volume);
+        output->gain.Reset(outputRate);
+        internal::build_routing(output->routing, channels, output->channels, targets[i].routes, targets[i].routes ? targets[i].routeCount : 0);
+        output->unrouted.assign(output->routing.IsIdentity() ? 0 : (size_t)chunkFrames * channels, 0.0f);
+        output->scratch.assign((size_t)chunkFrames * output->channels, 0.0f);
+
+        ma_device_config outputConfig = ma_device_config_init(ma_device_type_playback);
+        outputConfig.playback.pDeviceID = targets[i].playbackId;
+        outputConfig.playback.format = playbackFormat;
+        outputConfig.playback.channels = output->channels;
+        outputConfig.sampleRate = outputRate;
+        outputConfig.dataCallback = data_callback_output;
+        outputConfig.pUserData = output.get();
+
+        result = ma_device_init(&internal::context, &outputConfig, &output->device);
+        if (result != MA_SUCCESS) {
+            stop();
+            return Error(std::format(
+                "Failed to initialize fan-out playback device #{} ({}).",
+                i + 1, ma::convert::to_string(result)
+            ));
+        }
+        outputs.push_back(std::move(output));
+    }
+
+    // One ring shared by every output; the source writes each block exactly once.
+    result = ring.Init(ma_get_bytes_per_frame(format, channels), JitterBuffer::CapacityFor(sampleRate, latencyMs));
+    if (result != MA_SUCCESS) {
+        stop();
+        return Error(std::format(
+            "Failed to initialize fan-out ring buffer ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    for (ma_uint32 i = 0; i < outputs.size(); ++i) {
+        result = ma_device_start(&outputs[i]->device);
+        if (result != MA_SUCCESS) {
+            stop();
+            return Error(std::format(
+                "Failed to start fan-out playback device #{} ({}).",
+                i + 1, ma::convert::to_string(result)
+            ));
+        }
+    }
+
+    result = ma_device_start(&sourceDevice);
+    if (result != MA_SUCCESS) {
+        stop();
+        return Error(std::format(
+            "Failed to start fan-out source device ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::StopFanOutRedirect()
+{
+    std::lock_guard lock(internal::fanout::mutex);
+    internal::fanout::stop();
+    return std::monostate{};
+}
+
+void internal::fanout::stop()
+{
+    // Stop the writer first so no output ever reads a ring that is being torn down.
+    stop_and_uninit(&sourceDevice);
+
+    for (auto &output : outputs) {
+        stop_and_uninit(&output->device);
+    }
+    outputs.clear();
+
+    if (ring.GetCapacity() != 0) {
+        ring.Uninit();
+    }
+}
+
+void internal::fanout::stop_and_uninit(ma_device *device) {
+    const ma_device_state device_state = ma_device_get_state(device);
+
+    if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
+        ma_device_stop(device);
+    }
+    if (device_state != ma_device_state_uninitialized) {
+        ma_device_uninit(device);
+    }
+    *device = {};
+}
+
+// Source -> write once to the shared ring; cost does not depend on the number of outputs.
+void internal::fanout::data_callback_source(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pDevice; (void)pOutput;
+    internal::fanout::ring.Write(pInput, frameCount);
+}
+
+// Output -> read from the shared ring at this output's own cursor, route to its channels
+void internal::fanout::data_callback_output(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pInput;
+
+    Output &output = *static_cast<Output*>(pDevice->pUserData);
+    const ma_uint32 outputChannels = output.channels;
+    const ma_uint32 bytesPerFrame = ma_get_bytes_per_frame(playbackFormat, outputChannels);
+
+    ma_uint8* pOut = (ma_uint8*)pOutput;
+    while (frameCount > 0) {
+        const ma_uint32 chunk = std::min(frameCount, chunkFrames);
+        ma_uint32 rendered;
+        if (output.routing.IsIdentity()) {
+            rendered = output.reader.Render(ring, format, output.scratch.data(), chunk);
+        } else {
+            rendered = output.reader.Render(ring, format, output.unrouted.data(), chunk);
+            output.routing.Process(output.scratch.data(), output.unrouted.data(), rendered);
+        }
+        output.gain.Process(output.scratch.data(), rendered, outputChannels);
+
+        SampleConvert::Convert(pOut, playbackFormat, output.scratch.data(), ma_format_f32, (size_t)rendered * outputChannels);
+
+        // Pad any unfilled output with silence.
+        if (rendered < chunk) {
+            ma_silence_pcm_frames(pOut + (size_t)rendered * bytesPerFrame, chunk - rendered, playbackFormat, outputChannels);
+        }
+
+        pOut += (size_t)chunk * bytesPerFrame;
+        frameCount -= chunk;
+    }
+}
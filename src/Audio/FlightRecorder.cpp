@@ -0,0 +1,139 @@
+#include "FlightRecorder.hpp"
+#include <cstdio>
+#include <cstring>
+#include <bit>
+#include <algorithm>
+
+static_assert(std::has_single_bit(FlightRecorder::Capacity), "Capacity must be a power of two");
+
+static const char *source_name(FlightRecorder::Source source) {
+	switch (source) {
+		case FlightRecorder::Source::LoopbackCapture: return "loopback capture";
+		case FlightRecorder::Source::LoopbackPlayback: return "loopback playback";
+		case FlightRecorder::Source::Duplex: return "duplex";
+		case FlightRecorder::Source::LoopbackRoute: return "loopback route";
+		case FlightRecorder::Source::DuplexRoute: return "duplex route";
+		default: return "unknown";
+	}
+}
+
+void FlightRecorder::Record(Event event, Source source, ma_uint32 a, ma_uint32 b) {
+	const ma_uint64 index = m_head.fetch_add(1, std::memory_order_relaxed);
+	Slot &slot = m_slots[index & (Capacity - 1)];
+
+	// A seqlock per slot: odd while the fields change, so a reader can tell a torn copy.
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch);
+	slot.timeNs.store((ma_uint64)elapsed.count(), std::memory_order_relaxed);
+	slot.kind.store((ma_uint32)event | (ma_uint32)source << 16, std::memory_order_relaxed);
+	slot.args.store((ma_uint64)a | (ma_uint64)b << 32, std::memory_order_relaxed);
+
+	slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+ma_uint64 FlightRecorder::Read(ma_uint64 &cursor, std::vector<Entry> &entries) const {
+	ma_uint64 lost = 0;
+	Entry entry;
+	while (ReadNext(cursor, entry, lost)) entries.push_back(entry);
+	return lost;
+}
+
+bool FlightRecorder::ReadNext(ma_uint64 &cursor, Entry &entry, ma_uint64 &lost) const {
+	const ma_uint64 head = m_head.load(std::memory_order_acquire);
+
+	if (head - cursor > Capacity) {
+		lost += head - Capacity - cursor;
+		cursor = head - Capacity;
+	}
+
+	for (; cursor < head; ++cursor) {
+		const Slot &slot = m_slots[cursor & (Capacity - 1)];
+		const ma_uint64 done = 2 * cursor + 2;
+
+		const ma_uint64 before = slot.sequence.load(std::memory_order_acquire);
+		if (before < done) return false; // Claimed but not written yet; picked up by the next read
+		if (before > done) {             // A writer a lap ahead got there first
+			++lost;
+			continue;
+		}
+
+		const ma_uint32 kind = slot.kind.load(std::memory_order_relaxed);
+		const ma_uint64 args = slot.args.load(std::memory_order_relaxed);
+		entry = {
+			cursor,
+			slot.timeNs.load(std::memory_order_relaxed),
+			(Event)(kind & 0xFFFF),
+			(Source)(kind >> 16),
+			(ma_uint32)args,
+			(ma_uint32)(args >> 32)
+		};
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != done) {
+			++lost;
+			continue;
+		}
+		++cursor;
+		return true;
+	}
+
+	return false;
+}
+
+size_t FlightRecorder::Format(const Entry &entry, char *buffer, size_t size) {
+	if (size == 0) return 0;
+
+	int length = std::snprintf(buffer, size, "%12.6f s  %s: ", entry.timeNs / 1e9, source_name(entry.source));
+	if (length < 0 || (size_t)length >= size) return std::strlen(buffer);
+
+	char *rest = buffer + length;
+	const size_t restSize = size - length;
+	const ma_uint32 a = entry.a;
+	const ma_uint32 b = entry.b;
+
+	switch (entry.event) {
+		case Event::Underrun:
+			length += std::snprintf(rest, restSize, "underrun, %u of %u frames padded", a, b);
+			break;
+		case Event::Overrun:
+			length += std::snprintf(rest, restSize, "overrun, %u of %u frames dropped", a, b);
+			break;
+		case Event::LateCallback:
+			length += std::snprintf(rest, restSize, "callback took %u us of a %u us period", a, b);
+			break;
+		case Event::ShortRead:
+			length += std::snprintf(rest, restSize, "short read, %u of %u frames in the ring", a, b);
+			break;
+		case Event::RingTrimmed:
+			length += std::snprintf(rest, restSize, "%u frames trimmed from the ring", a);
+			break;
+		case Event::Volume:
+			length += std::snprintf(rest, restSize, "volume %.3f", std::bit_cast<float>(a));
+			break;
+		case Event::Started:
+			length += std::snprintf(rest, restSize, "started");
+			break;
+		case Event::Stopped:
+			length += std::snprintf(rest, restSize, "stopped");
+			break;
+		case Event::DeviceLost:
+			length += std::snprintf(rest, restSize, "device lost");
+			break;
+		case Event::Stall:
+			length += std::snprintf(rest, restSize, "stalled, no callback for %u ms", a);
+			break;
+		case Event::ReopenFailed:
+			length += std::snprintf(rest, restSize, "reopen failed, retrying in %u ms", a);
+			break;
+		case Event::Recovered:
+			length += std::snprintf(rest, restSize, "recovered in %.1f ms", a / 1000.0);
+			break;
+		default:
+			length += std::snprintf(rest, restSize, "event %u (%u, %u)", (ma_uint32)entry.event, a, b);
+			break;
+	}
+
+	return std::min((size_t)length, size - 1);
+}
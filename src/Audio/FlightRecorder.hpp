@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "miniaudio.h"
+
+// Fixed-size binary event log the data callbacks can write to: xruns, short reads, volume
+// changes, overlong callbacks, and the route events around them (starts, losses, reopens).
+//
+// Record() is wait-free and constant time: one fetch_add to claim a slot, then plain atomic
+// stores, so it is safe on the audio threads and from any number of them at once. The ring
+// keeps the newest Capacity events and overwrites the oldest. Events are decoded off the audio
+// threads with Read(); each slot carries a sequence number, so a reader never sees a slot
+// half written and counts the ones overwritten before it got to them as lost.
+class FlightRecorder {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr ma_uint32 Capacity = 4096; // Power of two
+
+	enum class Event : ma_uint16 {
+		Underrun,     // a: frames padded with silence, b: frames requested
+		Overrun,      // a: frames dropped, b: frames handed over
+		LateCallback, // a: callback duration in us, b: the period it had in us
+		ShortRead,    // a: frames the ring had, b: frames the resampler needed
+		RingTrimmed,  // a: frames skipped to bring the fill level back to the target
+		Volume,       // a: the new volume as float bits
+		Started,
+		Stopped,
+		DeviceLost,
+		Stall,        // a: ms without a playback callback
+		ReopenFailed, // a: backoff until the next attempt in ms
+		Recovered,    // a: detection to first callback in us
+	};
+
+	enum class Source : ma_uint16 {
+		LoopbackCapture,
+		LoopbackPlayback,
+		Duplex,
+		LoopbackRoute, // The loopback path as a whole (supervisor events)
+		DuplexRoute,
+	};
+
+	struct Entry {
+		ma_uint64 index;  // Position in the recording, counting from 0
+		ma_uint64 timeNs; // Monotonic time since the recorder was created
+		Event event;
+		Source source;
+		ma_uint32 a;
+		ma_uint32 b;
+	};
+
+	FlightRecorder() : m_epoch(Clock::now()) {}
+
+	// --- Any thread, including the audio threads ---
+	void Record(Event event, Source source, ma_uint32 a = 0, ma_uint32 b = 0);
+
+	// --- Readers ---
+	// Append the events from cursor on to entries and advance the cursor past them. Stops at
+	// an event still being written. Returns how many were overwritten before they were read.
+	ma_uint64 Read(ma_uint64 &cursor, std::vector<Entry> &entries) const;
+	// Read() of the next event alone, without allocating, for a crash handler. Returns whether
+	// there was one; adds the events overwritten on the way to lost.
+	bool ReadNext(ma_uint64 &cursor, Entry &entry, ma_uint64 &lost) const;
+
+	ma_uint64 GetRecorded() const { return m_head.load(std::memory_order_acquire); }
+
+	// One line for an entry, e.g. "12.345678 s  loopback playback: underrun, 480 of 480 frames
+	// padded". Formats into the caller's buffer without allocating, so a crash handler can use
+	// it. Returns the length written.
+	static size_t Format(const Entry &entry, char *buffer, size_t size);
+
+private:
+	struct Slot {
+		std::atomic<ma_uint64> sequence = 0; // 2 * index + 1 while written, 2 * index + 2 once done
+		std::atomic<ma_uint64> timeNs = 0;
+		std::atomic<ma_uint32> kind = 0;     // Event | Source << 16
+		std::atomic<ma_uint64> args = 0;     // a | b << 32
+	};
+
+	Clock::time_point m_epoch;
+	std::atomic<ma_uint64> m_head = 0; // Events ever recorded
+	Slot m_slots[Capacity];
+};
@@ -0,0 +1,79 @@
+#include "FractionalResampler.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+void FractionalResampler::Reset(ma_uint32 channels, ma_uint32 maxOutputFrames, double maxStep) {
+	m_channels = channels;
+	// Room for the largest block at the largest step plus the 4-point interpolation window.
+	m_capacityFrames = static_cast<ma_uint32>(std::ceil(maxOutputFrames * maxStep)) + 4;
+	m_buffer.assign(static_cast<size_t>(m_capacityFrames) * channels, 0.0f);
+	m_frames = 1; // one frame of silent history for the first interpolation window
+	m_position = 1.0;
+	m_step = 1.0;
+}
+
+void FractionalResampler::SetStep(double step) {
+	m_step = step;
+}
+
+ma_uint32 FractionalResampler::InputFramesFor(ma_uint32 outputFrames) const {
+	if (outputFrames == 0) return 0;
+
+	// The last output sits at m_position + (n - 1) * step and reads up to two frames past it.
+	const double last = m_position + (outputFrames - 1) * m_step;
+	const ma_uint32 needed = static_cast<ma_uint32>(last) + 3;
+	const ma_uint32 frames = needed > m_frames ? needed - m_frames : 0;
+	return std::min(frames, m_capacityFrames - m_frames);
+}
+
+float *FractionalResampler::InputBuffer() {
+	return m_buffer.data() + static_cast<size_t>(m_frames) * m_channels;
+}
+
+void FractionalResampler::CommitInput(ma_uint32 frames) {
+	m_frames = std::min(m_frames + frames, m_capacityFrames);
+}
+
+ma_uint32 FractionalResampler::Process(float *pOutput, ma_uint32 outputFrames) {
+	const ma_uint32 channels = m_channels;
+	const float *x = m_buffer.data();
+
+	ma_uint32 produced = 0;
+	while (produced < outputFrames) {
+		const ma_uint32 i = static_cast<ma_uint32>(m_position);
+		if (i + 2 >= m_frames) break; // window runs past the buffered input
+
+		const float t = static_cast<float>(m_position - i);
+		const float *p0 = x + static_cast<size_t>(i - 1) * channels;
+		const float *p1 = p0 + channels;
+		const float *p2 = p1 + channels;
+		const float *p3 = p2 + channels;
+
+		for (ma_uint32 c = 0; c < channels; ++c) {
+			// Catmull-Rom form of the cubic Hermite spline.
+			const float a = -0.5f * p0[c] + 1.5f * p1[c] - 1.5f * p2[c] + 0.5f * p3[c];
+			const float b = p0[c] - 2.5f * p1[c] + 2.0f * p2[c] - 0.5f * p3[c];
+			const float d = -0.5f * p0[c] + 0.5f * p2[c];
+			pOutput[c] = ((a * t + b) * t + d) * t + p1[c];
+		}
+
+		pOutput += channels;
+		m_position += m_step;
+		++produced;
+	}
+
+	// Drop consumed frames, keeping the one frame of history the next window starts from.
+	const ma_uint32 consumed = std::min(static_cast<ma_uint32>(m_position) - 1, m_frames);
+	if (consumed > 0) {
+		std::memmove(
+			m_buffer.data(),
+			m_buffer.data() + static_cast<size_t>(consumed) * channels,
+			static_cast<size_t>(m_frames - consumed) * channels * sizeof(float)
+		);
+		m_frames -= consumed;
+		m_position -= consumed;
+	}
+
+	return produced;
+}
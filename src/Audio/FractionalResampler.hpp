@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include "miniaudio.h"
+
+// Interleaved f32 resampler with a double precision step, so ratios a fraction of a ppm
+// away from 1.0 are honored exactly. Uses 4-point cubic Hermite interpolation; the
+// interpolation history is carried across blocks, adding 1 frame of delay.
+//
+// Typical block: frames = InputFramesFor(n), write them to InputBuffer(), CommitInput(frames),
+// then Process(pOut, n).
+class FractionalResampler {
+public:
+	// Allocates room for blocks of up to maxOutputFrames; not real-time safe.
+	void Reset(ma_uint32 channels, ma_uint32 maxOutputFrames, double maxStep = 1.01);
+
+	// Input frames consumed per output frame; 1.0 is a pass-through.
+	void SetStep(double step);
+	double GetStep() const { return m_step; }
+
+	// Additional input frames needed to produce outputFrames (beyond what is buffered).
+	ma_uint32 InputFramesFor(ma_uint32 outputFrames) const;
+
+	float *InputBuffer(); // write position for new interleaved input frames
+	void CommitInput(ma_uint32 frames);
+
+	// Produce up to outputFrames; returns the number produced.
+	ma_uint32 Process(float *pOutput, ma_uint32 outputFrames);
+
+private:
+	std::vector<float> m_buffer; // [history | pending input] interleaved frames
+	ma_uint32 m_channels = 0;
+	ma_uint32 m_capacityFrames = 0;
+	ma_uint32 m_frames = 0; // frames currently held in m_buffer
+	double m_position = 1.0; // read position in frames from the start of m_buffer
+	double m_step = 1.0;
+};
@@ -0,0 +1,70 @@
+#include "GainStage.hpp"
+#include <cmath>
+#include <algorithm>
+#include "MixKernels.hpp"
+
+// Exponential ramps are drawn as linear segments of this many frames.
+static constexpr ma_uint32 kSegmentFrames = 32;
+
+// Exponential: the remaining distance shrinks by this factor (-60 dB) over the ramp time.
+static constexpr double kSettleRatio = 1e-3;
+
+// Distance to the target below which a ramp snaps onto it.
+static constexpr float kSnapDistance = 1e-5f;
+
+void GainStage::Reset(ma_uint32 sampleRate, ma_uint32 rampMs) {
+	m_rampFrames = std::max<ma_uint32>(static_cast<ma_uint32>(static_cast<ma_uint64>(sampleRate) * rampMs / 1000), 1);
+	m_decay = static_cast<float>(std::pow(kSettleRatio, static_cast<double>(kSegmentFrames) / m_rampFrames));
+
+	m_current = m_rampTarget = m_target.load(std::memory_order_relaxed);
+	m_rampRemaining = 0;
+	m_linearStep = 0.0f;
+	m_published.store(m_current, std::memory_order_relaxed);
+}
+
+void GainStage::Process(float *pBuffer, ma_uint32 frameCount, ma_uint32 channels) {
+	const float target = m_target.load(std::memory_order_relaxed);
+
+	if (m_current == target) {
+		MixScale(pBuffer, target, static_cast<size_t>(frameCount) * channels);
+		return;
+	}
+
+	ma_uint32 frame = 0;
+
+	if (m_ramp.load(std::memory_order_relaxed) == Ramp::Linear) {
+		// A new target restarts the ramp from wherever the gain is now.
+		if (target != m_rampTarget || m_rampRemaining == 0) {
+			m_rampTarget = target;
+			m_rampRemaining = m_rampFrames;
+			m_linearStep = (target - m_current) / static_cast<float>(m_rampFrames);
+		}
+
+		frame = std::min(frameCount, m_rampRemaining);
+		MixRamp(pBuffer, m_current, m_linearStep, frame, channels);
+
+		m_rampRemaining -= frame;
+		m_current = m_rampRemaining == 0 ? target : m_current + m_linearStep * static_cast<float>(frame);
+	} else {
+		m_rampRemaining = 0; // a later linear ramp starts fresh
+		while (frame < frameCount && m_current != target) {
+			const ma_uint32 n = std::min(kSegmentFrames, frameCount - frame);
+			const float decay = n == kSegmentFrames
+				? m_decay
+				: std::pow(m_decay, static_cast<float>(n) / kSegmentFrames);
+
+			float end = target + (m_current - target) * decay;
+			if (std::abs(end - target) < kSnapDistance) end = target;
+
+			MixRamp(pBuffer + static_cast<size_t>(frame) * channels, m_current, (end - m_current) / n, n, channels);
+			m_current = end;
+			frame += n;
+		}
+	}
+
+	// Hold the target for the rest of the block once the ramp has arrived.
+	if (frame < frameCount) {
+		MixScale(pBuffer + static_cast<size_t>(frame) * channels, m_current, static_cast<size_t>(frameCount - frame) * channels);
+	}
+	m_published.store(m_current, std::memory_order_relaxed);
+}
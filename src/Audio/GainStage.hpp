@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include "miniaudio.h"
+
+// Click-free f32 gain applied inside a data callback.
+//
+// The target is an atomic, so any thread can set it at any rate (e.g. every slider tick) at
+// the cost of one store. The callback glides from the current gain to the target instead of
+// stepping: Linear covers any change in a fixed ramp time; Exponential approaches the target
+// like a one-pole smoother (fast at first, then settling), approximated by short linear
+// segments so every block runs through the same vectorized ramp kernel.
+//
+// Process() must only be called from the audio callback; the setters and getters are safe
+// from any thread.
+class GainStage {
+public:
+	enum class Ramp
+	{
+		Linear,
+		Exponential
+	};
+
+	static constexpr ma_uint32 DefaultRampMs = 20;
+
+	// Snap the current gain to the target (no ramp on the first block after a reset).
+	void Reset(ma_uint32 sampleRate, ma_uint32 rampMs = DefaultRampMs);
+
+	void Process(float *pBuffer, ma_uint32 frameCount, ma_uint32 channels);
+
+	// True when Process() would leave the buffer untouched (callback thread only).
+	bool IsUnity() const { return m_current == 1.0f && GetTarget() == 1.0f; }
+
+	void SetTarget(float gain) { m_target.store(gain, std::memory_order_relaxed); }
+	float GetTarget() const { return m_target.load(std::memory_order_relaxed); }
+
+	void SetRamp(Ramp ramp) { m_ramp.store(ramp, std::memory_order_relaxed); }
+	Ramp GetRamp() const { return m_ramp.load(std::memory_order_relaxed); }
+
+	// Gain reached at the end of the last processed block.
+	float GetCurrent() const { return m_published.load(std::memory_order_relaxed); }
+
+private:
+	ma_uint32 m_rampFrames = 960;
+	float m_current = 1.0f;
+	float m_rampTarget = 1.0f;      // target the linear slope was computed for
+	ma_uint32 m_rampRemaining = 0;  // frames left in the linear ramp
+	float m_linearStep = 0.0f;      // per-frame gain increment of the linear ramp
+	float m_decay = 0.0f;           // exponential: remaining distance after one segment
+
+	std::atomic<float> m_target = 1.0f;
+	std::atomic<Ramp> m_ramp = Ramp::Exponential;
+	std::atomic<float> m_published = 1.0f;
+};
@@ -0,0 +1,119 @@
+#include "JitterBuffer.hpp"
+#include <algorithm>
+
+// Seconds without an underrun before the adaptive target is lowered one step.
+static constexpr ma_uint32 kStableSeconds = 5;
+
+void JitterBuffer::Reset(ma_uint32 sampleRate, ma_uint32 targetLatencyMs) {
+	targetLatencyMs = std::clamp(targetLatencyMs, MinLatencyMs, MaxLatencyMs);
+
+	m_sampleRate = sampleRate;
+	m_minTargetFrames = msToFrames(targetLatencyMs);
+	m_maxTargetFrames = CapacityFor(sampleRate, targetLatencyMs) / 2;
+	m_targetFrames = m_minTargetFrames;
+	m_stableFrames = 0;
+	m_prerolling = true;
+	m_droppedSeen = 0;
+
+	m_requestedMs.store(targetLatencyMs, std::memory_order_relaxed);
+	m_currentMs.store(targetLatencyMs, std::memory_order_relaxed);
+	m_underruns.store(0, std::memory_order_relaxed);
+	m_dropped.store(0, std::memory_order_relaxed);
+}
+
+JitterBuffer::Decision JitterBuffer::Process(ma_uint32 framesAvailable, ma_uint32 frameCount) {
+	// Pick up a target change requested from another thread; the ring capacity is fixed
+	// until the next Reset(), so the new target is clamped to what the ring can hold.
+	const ma_uint32 requestedFrames = std::min(
+		msToFrames(m_requestedMs.load(std::memory_order_relaxed)), m_maxTargetFrames
+	);
+	if (requestedFrames != m_minTargetFrames) {
+		m_minTargetFrames = requestedFrames;
+		m_targetFrames = requestedFrames;
+		m_stableFrames = 0;
+		publishTarget(frameCount);
+	}
+
+	// The writer dropped frames since the last period: the reader fell far enough behind to fill
+	// the ring. Allow it the same extra room as after an underrun; the trim below still brings
+	// the fill level back down to the new target.
+	const ma_uint64 dropped = m_dropped.load(std::memory_order_relaxed);
+	if (dropped != m_droppedSeen) {
+		m_droppedSeen = dropped;
+		grow(frameCount);
+	}
+
+	// The fill level can never usefully sit below one reader period.
+	const ma_uint32 target = std::max(m_targetFrames, frameCount);
+
+	if (m_prerolling) {
+		if (framesAvailable < target) {
+			return {0, 0, false}; // keep filling, output silence
+		}
+		m_prerolling = false;
+		publishTarget(frameCount); // The period is known from here
+	}
+
+	if (framesAvailable < frameCount) {
+		// Underrun: play what is left, grow the target and pre-roll up to it again.
+		m_underruns.fetch_add(1, std::memory_order_relaxed);
+		grow(frameCount);
+		m_prerolling = true;
+		return {0, framesAvailable, true};
+	}
+
+	m_stableFrames += frameCount;
+	if (m_stableFrames >= static_cast<ma_uint64>(m_sampleRate) * kStableSeconds) {
+		// Stable for a while: step the target back towards the requested latency.
+		m_targetFrames = std::max(m_targetFrames - m_targetFrames / 8, m_minTargetFrames);
+		publishTarget(frameCount);
+		m_stableFrames = 0;
+	}
+
+	// Trim back to the target once the fill level has run well above it.
+	const ma_uint32 tolerance = std::max(frameCount * 2, target / 2);
+	if (framesAvailable > target + tolerance) {
+		return {framesAvailable - target, frameCount, false};
+	}
+
+	return {0, frameCount, false};
+}
+
+void JitterBuffer::SetTargetLatency(ma_uint32 latencyMs) {
+	m_requestedMs.store(std::clamp(latencyMs, MinLatencyMs, MaxLatencyMs), std::memory_order_relaxed);
+}
+
+void JitterBuffer::AddDroppedFrames(ma_uint32 frames) {
+	if (frames > 0) m_dropped.fetch_add(frames, std::memory_order_relaxed);
+}
+
+ma_uint32 JitterBuffer::GetCurrentLatency() const {
+	return m_currentMs.load(std::memory_order_relaxed);
+}
+
+ma_uint32 JitterBuffer::GetUnderrunCount() const {
+	return m_underruns.load(std::memory_order_relaxed);
+}
+
+ma_uint32 JitterBuffer::CapacityFor(ma_uint32 sampleRate, ma_uint32 targetLatencyMs) {
+	// Allow the target to grow to 4x (bounded by MaxLatencyMs) and keep the same again as
+	// headroom so a late reader never forces the writer to drop frames.
+	const ma_uint32 maxLatencyMs = std::clamp(targetLatencyMs * 4, MinLatencyMs, MaxLatencyMs);
+	return static_cast<ma_uint32>(static_cast<ma_uint64>(sampleRate) * maxLatencyMs * 2 / 1000);
+}
+
+ma_uint32 JitterBuffer::msToFrames(ma_uint32 ms) const {
+	return static_cast<ma_uint32>(static_cast<ma_uint64>(m_sampleRate) * ms / 1000);
+}
+
+void JitterBuffer::grow(ma_uint32 frameCount) {
+	m_targetFrames = std::min(m_targetFrames + std::max(frameCount, m_targetFrames / 4), m_maxTargetFrames);
+	publishTarget(frameCount);
+	m_stableFrames = 0;
+}
+
+// Includes the one reader period the fill level is never held below.
+void JitterBuffer::publishTarget(ma_uint32 frameCount) {
+	const ma_uint32 frames = std::max(m_targetFrames, frameCount);
+	m_currentMs.store(static_cast<ma_uint32>(static_cast<ma_uint64>(frames) * 1000 / m_sampleRate), std::memory_order_relaxed);
+}
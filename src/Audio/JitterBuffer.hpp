@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include "miniaudio.h"
+
+// Latency controller between a ring writer and a ring reader. It holds playback back until the
+// ring has pre-rolled to the target fill level, raises the target after jitter on either side
+// (reader underruns, and frames the writer dropped on a full ring), lowers it again after a
+// stable period and trims the fill level whenever it runs above the target.
+//
+// All methods except SetTargetLatency(), AddDroppedFrames() and the getters must only be
+// called from the reader.
+class JitterBuffer {
+public:
+	struct Decision {
+		ma_uint32 framesToSkip; // frames to discard from the ring before reading
+		ma_uint32 framesToRead; // frames to read; the remainder of the period is silence
+		bool underrun;          // the ring ran short of the period; pre-rolling again from the next one
+	};
+
+	static constexpr ma_uint32 MinLatencyMs = 5;
+	static constexpr ma_uint32 MaxLatencyMs = 1000;
+
+	// Reset all state; the next Process() call starts pre-rolling again.
+	void Reset(ma_uint32 sampleRate, ma_uint32 targetLatencyMs);
+
+	// Decide what to do with one reader period given the frames currently in the ring.
+	Decision Process(ma_uint32 framesAvailable, ma_uint32 frameCount);
+
+	void SetTargetLatency(ma_uint32 latencyMs); // safe to call from any thread
+	void AddDroppedFrames(ma_uint32 frames);    // the writer found the ring full; any thread
+
+	ma_uint32 GetTargetFrames() const { return m_targetFrames; } // reader only
+	bool IsPrerolling() const { return m_prerolling; }           // reader only
+
+	ma_uint32 GetCurrentLatency() const; // adaptive target in milliseconds
+	ma_uint32 GetUnderrunCount() const;
+
+	// Ring capacity (in frames) needed to honor the maximum adaptive target.
+	static ma_uint32 CapacityFor(ma_uint32 sampleRate, ma_uint32 targetLatencyMs);
+
+private:
+	ma_uint32 msToFrames(ma_uint32 ms) const;
+	void grow(ma_uint32 frameCount); // One step up after jitter, bounded by m_maxTargetFrames
+	void publishTarget(ma_uint32 frameCount); // m_currentMs from the target as Process() applies it
+
+	ma_uint32 m_sampleRate = 48000;
+	ma_uint32 m_minTargetFrames = 0; // user requested floor
+	ma_uint32 m_maxTargetFrames = 0; // growth ceiling
+	ma_uint32 m_targetFrames = 0;    // current adaptive target
+	ma_uint64 m_stableFrames = 0;    // frames played since the last underrun or shrink
+	bool m_prerolling = true;
+	ma_uint64 m_droppedSeen = 0;     // m_dropped as of the last Process()
+
+	std::atomic<ma_uint32> m_requestedMs = 0;
+	std::atomic<ma_uint32> m_currentMs = 0;
+	std::atomic<ma_uint32> m_underruns = 0;
+	std::atomic<ma_uint64> m_dropped = 0;
+};
@@ -0,0 +1,184 @@
+#include "AudioRedirector.hpp"
+#include <format>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "MAConvert.hpp"
+#include "AudioInternal.hpp"
+#include "LatencyProbe.hpp"
+#include "VirtualBackend.hpp"
+
+namespace internal::latency {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr ma_uint32 channels = 2;
+
+    ma_device markerDevice = {};  // Plays markers on the loopback source device
+    ma_device probeDevice = {};   // Loopback capture of the playback device
+    LatencyProbe probe;
+    Clock::time_point epoch;
+
+    // Device buffering the callback times miss. None under VirtualBackend, whose endpoints play
+    // a period as it is rendered and hand loopback capture the period just played.
+    bool compensate = false;
+    double markerLeadNs = 0.0; // The marker device's playback buffer: written now, played this much later
+
+    double now_ns();
+    void stop_and_uninit(ma_device *device);
+    LatencyReport summarize(std::vector<double> latenciesMs, ma_uint32 sent);
+
+    void data_callback_marker(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+    void data_callback_probe(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+}; // namespace internal::latency
+
+// ============================================================================
+// Main Implementation
+// ============================================================================
+
+Result<LatencyReport, Error> AudioRedirector::MeasureLoopbackLatency(
+    const ma_device_id *loopbackId, const ma_device_id *playbackId, ma_uint32 markerCount, ma_uint32 intervalMs
+) {
+    using namespace internal::latency;
+
+    // On one device the probe would hear the marker directly, before the redirect.
+    const bool sameDevice = (loopbackId == nullptr && playbackId == nullptr) ||
+        (loopbackId != nullptr && playbackId != nullptr && GetDeviceIdString(*loopbackId) == GetDeviceIdString(*playbackId));
+    if (sameDevice) {
+        return Error("Latency measurement needs different loopback and playback devices.");
+    }
+    if (markerCount == 0) {
+        return Error("Latency measurement needs at least one marker.");
+    }
+
+    const ma_uint32 sampleRate = GetLoopbackSampleRate();
+    probe.Reset(sampleRate, (ma_uint32)((ma_uint64)sampleRate * intervalMs / 1000), markerCount);
+    epoch = Clock::now();
+    compensate = !VirtualBackend::IsActive(&internal::context);
+    markerLeadNs = 0.0;
+
+    ResultVoid started = StartLoopbackRedirect(loopbackId, playbackId);
+    if (!started) return started.error();
+
+    // The probe listens before the first marker goes out.
+    ma_device_config config = ma_device_config_init(ma_device_type_loopback);
+    config.capture.pDeviceID = playbackId;
+    config.capture.format = ma_format_f32;
+    config.capture.channels = channels;
+    config.sampleRate = sampleRate;
+    config.dataCallback = data_callback_probe;
+
+    ma_result result = ma_device_init(&internal::context, &config, &probeDevice);
+    if (result == MA_SUCCESS) result = ma_device_start(&probeDevice);
+    if (result != MA_SUCCESS) {
+        stop_and_uninit(&probeDevice);
+        StopLoopbackRedirect();
+        return Error(std::format(
+            "Failed to start latency probe device ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    config = ma_device_config_init(ma_device_type_playback);
+    config.playback.pDeviceID = loopbackId;
+    config.playback.format = ma_format_f32;
+    config.playback.channels = channels;
+    config.sampleRate = sampleRate;
+    config.dataCallback = data_callback_marker;
+
+    result = ma_device_init(&internal::context, &config, &markerDevice);
+    if (result == MA_SUCCESS && compensate) {
+        const ma_uint32 queuedFrames = markerDevice.playback.internalPeriodSizeInFrames * markerDevice.playback.internalPeriods;
+        markerLeadNs = 1e9 * queuedFrames / markerDevice.playback.internalSampleRate;
+    }
+    if (result == MA_SUCCESS) result = ma_device_start(&markerDevice);
+    if (result != MA_SUCCESS) {
+        stop_and_uninit(&markerDevice);
+        stop_and_uninit(&probeDevice);
+        StopLoopbackRedirect();
+        return Error(std::format(
+            "Failed to start latency marker device ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    // Every marker gets one interval to arrive, plus the redirect pre-roll and a second of slack.
+    internal::wait_until(
+        [&]() { return probe.GetDetected() >= markerCount; },
+        (markerCount + 1) * intervalMs + GetLoopbackLatency() + 1000
+    );
+
+    stop_and_uninit(&markerDevice);
+    stop_and_uninit(&probeDevice);
+    StopLoopbackRedirect();
+
+    if (probe.GetDetected() == 0) {
+        return Error(std::format(
+            "No marker arrived on the playback device ({} sent); check that the source device is audible to loopback capture.",
+            probe.GetSent()
+        ));
+    }
+    return summarize(probe.GetLatenciesMs(), probe.GetSent());
+}
+
+// Callback time: the virtual clock under VirtualBackend (which runs faster than real time), else the wall clock.
+double internal::latency::now_ns() {
+    if (VirtualBackend::IsActive(&internal::context)) {
+        return VirtualBackend::GetTimeSeconds(&internal::context) * 1e9;
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - epoch).count();
+}
+
+void internal::latency::stop_and_uninit(ma_device *device) {
+    const ma_device_state device_state = ma_device_get_state(device);
+
+    if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
+        ma_device_stop(device);
+    }
+    if (device_state != ma_device_state_uninitialized) {
+        ma_device_uninit(device);
+    }
+    *device = {};
+}
+
+LatencyReport internal::latency::summarize(std::vector<double> latenciesMs, ma_uint32 sent)
+{
+    LatencyReport report = {};
+    report.markersSent = sent;
+    report.markersDetected = (ma_uint32)latenciesMs.size();
+    report.latenciesMs = latenciesMs;
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    const auto percentile = [&](double p) { return latenciesMs[(size_t)(p * (latenciesMs.size() - 1) + 0.5)]; };
+
+    double total = 0.0;
+    for (const double ms : latenciesMs) total += ms;
+
+    report.minMs = latenciesMs.front();
+    report.meanMs = total / latenciesMs.size();
+    report.p50Ms = percentile(0.50);
+    report.p95Ms = percentile(0.95);
+    report.p99Ms = percentile(0.99);
+    report.maxMs = latenciesMs.back();
+    return report;
+}
+
+// Marker -> silence with a marker every interval, timed at the callback
+void internal::latency::data_callback_marker(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pDevice; (void)pInput;
+
+    // The output buffer arrives pre-silenced, so only the markers are written. The endpoint
+    // plays it once the buffers queued ahead of it have played.
+    probe.Emit((float*)pOutput, frameCount, channels, now_ns() + markerLeadNs);
+}
+
+// Probe -> scan what the playback device renders for markers
+void internal::latency::data_callback_probe(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pOutput;
+
+    // The buffer ends at the callback; its first frame was captured frameCount frames earlier.
+    const double bufferNs = compensate ? 1e9 * frameCount / pDevice->sampleRate : 0.0;
+    probe.Detect((const float*)pInput, frameCount, channels, now_ns() - bufferNs);
+}
@@ -0,0 +1,117 @@
+#include "LatencyProbe.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Barker-13: the autocorrelation sidelobes are at most 1/13 of the peak, so the match is sharp
+// and a partial overlap never looks like a marker.
+static constexpr float kBarker13[13] = {1, 1, 1, 1, 1, -1, -1, 1, 1, -1, 1, -1, 1};
+static constexpr ma_uint32 kChipFrames = LatencyProbe::MarkerFrames / 13;
+
+// Normalized correlation a window must reach to count as a marker.
+static constexpr float kThreshold = 0.85f;
+
+// Windows quieter than this (RMS relative to the marker) are skipped, so silence and
+// dither never match.
+static constexpr float kMinLevel = 0.1f;
+
+static float marker_chip(ma_uint32 frame) {
+	return kBarker13[frame / kChipFrames];
+}
+
+void LatencyProbe::Reset(ma_uint32 sampleRate, ma_uint32 intervalFrames, ma_uint32 maxResults) {
+	m_sampleRate = sampleRate;
+
+	m_intervalFrames = std::max(intervalFrames, MarkerFrames * 2);
+	m_untilNext = m_intervalFrames;
+	m_markerPos = MarkerFrames;
+	for (auto &slot : m_injectedNs) slot.store(0.0, std::memory_order_relaxed);
+	m_sent.store(0, std::memory_order_release);
+
+	m_window.fill(0.0f);
+	m_windowPos = 0;
+	m_bestScore = 0.0f;
+	m_bestNs = 0.0;
+	m_holdoff = 0;
+	m_matched = 0;
+
+	m_latenciesMs.assign(maxResults, 0.0);
+	m_detected.store(0, std::memory_order_release);
+}
+
+void LatencyProbe::Emit(float *pBuffer, ma_uint32 frameCount, ma_uint32 channels, double startNs) {
+	for (ma_uint32 i = 0; i < frameCount; ++i) {
+		if (m_untilNext == 0) {
+			const ma_uint32 sent = m_sent.load(std::memory_order_relaxed);
+			m_injectedNs[sent % kInjectionSlots].store(startNs + frameNs(i), std::memory_order_relaxed);
+			m_sent.store(sent + 1, std::memory_order_release);
+
+			m_markerPos = 0;
+			m_untilNext = m_intervalFrames;
+		}
+		--m_untilNext;
+
+		if (m_markerPos < MarkerFrames) {
+			const float sample = MarkerAmplitude * marker_chip(m_markerPos++);
+			for (ma_uint32 c = 0; c < channels; ++c) {
+				pBuffer[i * channels + c] += sample;
+			}
+		}
+	}
+}
+
+void LatencyProbe::Detect(const float *pBuffer, ma_uint32 frameCount, ma_uint32 channels, double startNs) {
+	const float minEnergy = MarkerFrames * (kMinLevel * MarkerAmplitude) * (kMinLevel * MarkerAmplitude);
+
+	for (ma_uint32 i = 0; i < frameCount; ++i) {
+		const float x = pBuffer[i * channels];
+		m_window[m_windowPos] = x;
+		m_window[m_windowPos + MarkerFrames] = x;
+		m_windowPos = (m_windowPos + 1) % MarkerFrames;
+
+		if (m_holdoff > 0) {
+			--m_holdoff;
+			continue;
+		}
+
+		// Oldest frame first: the window lines up with the marker when it has just ended.
+		const float *pWindow = m_window.data() + m_windowPos;
+		float dot = 0.0f, energy = 0.0f;
+		for (ma_uint32 k = 0; k < MarkerFrames; ++k) {
+			dot += pWindow[k] * marker_chip(k);
+			energy += pWindow[k] * pWindow[k];
+		}
+		const float score = energy > minEnergy ? dot / std::sqrt(energy * MarkerFrames) : 0.0f;
+
+		if (score >= kThreshold) {
+			// Keep climbing to the correlation peak before taking the time.
+			if (score > m_bestScore) {
+				m_bestScore = score;
+				m_bestNs = startNs + frameNs(i) - frameNs(MarkerFrames - 1); // first frame of the marker
+			}
+			continue;
+		}
+		if (m_bestScore == 0.0f) continue;
+
+		// Past the peak: pair with the latest injection that went out before the marker arrived.
+		const ma_uint32 sent = m_sent.load(std::memory_order_acquire);
+		for (ma_uint32 j = sent; j > m_matched && sent - j < kInjectionSlots; --j) {
+			const double injectedNs = m_injectedNs[(j - 1) % kInjectionSlots].load(std::memory_order_relaxed);
+			if (injectedNs > m_bestNs) continue;
+
+			const ma_uint32 detected = m_detected.load(std::memory_order_relaxed);
+			if (detected < m_latenciesMs.size()) {
+				m_latenciesMs[detected] = (m_bestNs - injectedNs) / 1e6;
+				m_detected.store(detected + 1, std::memory_order_release);
+			}
+			m_matched = j;
+			break;
+		}
+
+		m_bestScore = 0.0f;
+		m_holdoff = MarkerFrames;
+	}
+}
+
+std::vector<double> LatencyProbe::GetLatenciesMs() const {
+	return std::vector<double>(m_latenciesMs.begin(), m_latenciesMs.begin() + GetDetected());
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <vector>
+#include "miniaudio.h"
+
+// Marker injection and detection for measuring the latency of an audio path.
+//
+// Emit() mixes a short marker (a Barker-13 code, four frames per chip) into an interleaved
+// f32 stream at a fixed interval and records when each one went out. Detect() correlates
+// another stream against the marker and, for every match, stores the time since the most
+// recent injection. Markers are spaced far enough apart that each detection belongs to the
+// injection just before it, so a lost marker costs one sample instead of skewing the rest.
+//
+// Times are in nanoseconds on any clock shared by both sides (steady_clock for devices,
+// frame counts for a simulated pipeline); the caller passes the time of each buffer's first
+// frame. Emit() and Detect() may run on different threads, one thread each.
+class LatencyProbe {
+public:
+	static constexpr ma_uint32 MarkerFrames = 52;
+	static constexpr float MarkerAmplitude = 0.5f;
+
+	// intervalFrames is the spacing between markers; maxResults caps the stored latencies.
+	void Reset(ma_uint32 sampleRate, ma_uint32 intervalFrames, ma_uint32 maxResults);
+
+	// Add markers to frameCount interleaved frames (on every channel).
+	void Emit(float *pBuffer, ma_uint32 frameCount, ma_uint32 channels, double startNs);
+
+	// Scan frameCount interleaved frames (first channel) for markers.
+	void Detect(const float *pBuffer, ma_uint32 frameCount, ma_uint32 channels, double startNs);
+
+	ma_uint32 GetSent() const { return m_sent.load(std::memory_order_acquire); }
+	ma_uint32 GetDetected() const { return m_detected.load(std::memory_order_acquire); }
+
+	// Latencies measured so far, in milliseconds.
+	std::vector<double> GetLatenciesMs() const;
+
+private:
+	static constexpr ma_uint32 kInjectionSlots = 64;
+
+	double frameNs(ma_uint32 frame) const { return 1e9 * frame / m_sampleRate; }
+
+	ma_uint32 m_sampleRate = 48000;
+
+	// Emitter
+	ma_uint32 m_intervalFrames = 12000;
+	ma_uint32 m_untilNext = 0;
+	ma_uint32 m_markerPos = MarkerFrames; // == MarkerFrames when no marker is playing
+	std::array<std::atomic<double>, kInjectionSlots> m_injectedNs = {};
+	std::atomic<ma_uint32> m_sent = 0;
+
+	// Detector
+	std::array<float, MarkerFrames * 2> m_window = {}; // history, stored twice so it reads contiguously
+	ma_uint32 m_windowPos = 0;
+	float m_bestScore = 0.0f;
+	double m_bestNs = 0.0;
+	ma_uint32 m_holdoff = 0;
+	ma_uint32 m_matched = 0; // injections already paired with a detection
+
+	std::vector<double> m_latenciesMs;
+	std::atomic<ma_uint32> m_detected = 0;
+};
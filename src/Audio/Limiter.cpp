@@ -0,0 +1,170 @@
+#include "Limiter.hpp"
+#include <cmath>
+#include <algorithm>
+#include "MixKernels.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define LIMITER_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define LIMITER_NEON
+#endif
+
+// ITU-R BS.1770-4 Annex 2 4x oversampling filter, transposed to [tap][phase] so one SIMD
+// multiply-add per tap produces all four interpolated phases.
+alignas(16) static constexpr float kPhaseTaps[12][4] = {
+	{ 0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f},
+	{ 0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f},
+	{-0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f},
+	{ 0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f},
+	{-0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f},
+	{ 0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f},
+	{ 0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f},
+	{-0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f},
+	{ 0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f},
+	{-0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f},
+	{ 0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f},
+	{-0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f},
+};
+
+// The filter centre sits between taps 5 and 6: a peak shows up this many frames after the
+// input sample it belongs to, so the audio is delayed by the same amount on top of the lookahead.
+static constexpr ma_uint32 kDetectorDelay = 6;
+
+// Gain is computed and applied in blocks of this many frames.
+static constexpr ma_uint32 kBlockFrames = 256;
+
+void Limiter::Reset(ma_uint32 sampleRate, ma_uint32 channels, ma_uint32 lookaheadMs, ma_uint32 releaseMs) {
+	lookaheadMs = std::clamp(lookaheadMs, MinLookaheadMs, MaxLookaheadMs);
+
+	m_sampleRate = sampleRate;
+	m_channels = channels;
+	m_lookahead = std::max<ma_uint32>(static_cast<ma_uint32>(static_cast<ma_uint64>(sampleRate) * lookaheadMs / 1000), 1);
+	m_ceiling = std::pow(10.0f, CeilingDb / 20.0f);
+
+	m_history.assign(static_cast<size_t>(channels) * kTaps * 2, 0.0f);
+	m_historyPos = 0;
+
+	m_delayFrames = m_lookahead + kDetectorDelay;
+	m_delay.assign(static_cast<size_t>(m_delayFrames) * channels, 0.0f);
+	m_delayPos = 0;
+
+	// The minimum spans one frame more than the lookahead on each side of the detector's
+	// interpolation interval, so the moving average below never undershoots a peak.
+	m_minWindow = m_lookahead + 2;
+	ma_uint32 capacity = 1;
+	while (capacity < m_minWindow + 1) capacity <<= 1;
+	m_minValues.assign(capacity, 1.0f);
+	m_minIndices.assign(capacity, 0);
+	m_minMask = capacity - 1;
+	m_minHead = m_minTail = 0;
+	m_frameIndex = 0;
+
+	m_box.assign(m_lookahead, 1.0f);
+	m_boxPos = 0;
+	m_boxSum = m_lookahead;
+
+	m_gain = 1.0f;
+	m_appliedReleaseMs = 0;
+	m_gains.assign(kBlockFrames, 1.0f);
+
+	m_releaseMs.store(releaseMs, std::memory_order_relaxed);
+	m_latencyFrames.store(m_delayFrames, std::memory_order_relaxed);
+	m_reductionDb.store(0.0f, std::memory_order_relaxed);
+}
+
+float Limiter::detect(const float *pFrame) {
+	const ma_uint32 pos = m_historyPos;
+	m_historyPos = (m_historyPos + 1) % kTaps;
+
+	float peak = 0.0f;
+	for (ma_uint32 c = 0; c < m_channels; ++c) {
+		float *pHistory = m_history.data() + static_cast<size_t>(c) * kTaps * 2;
+		pHistory[pos] = pHistory[pos + kTaps] = pFrame[c];
+
+		// Oldest to newest sample: taps run newest-first, so walk the window backwards.
+		const float *pWindow = pHistory + pos + 1;
+
+#if defined(LIMITER_SSE)
+		__m128 acc = _mm_setzero_ps();
+		for (ma_uint32 k = 0; k < kTaps; ++k) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(pWindow[kTaps - 1 - k]), _mm_load_ps(kPhaseTaps[k])));
+		}
+		const __m128 absolute = _mm_andnot_ps(_mm_set1_ps(-0.0f), acc);
+		__m128 m = _mm_max_ps(absolute, _mm_movehl_ps(absolute, absolute));
+		m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+		peak = std::max(peak, _mm_cvtss_f32(m));
+#elif defined(LIMITER_NEON)
+		float32x4_t acc = vdupq_n_f32(0.0f);
+		for (ma_uint32 k = 0; k < kTaps; ++k) {
+			acc = vmlaq_n_f32(acc, vld1q_f32(kPhaseTaps[k]), pWindow[kTaps - 1 - k]);
+		}
+		const float32x4_t absolute = vabsq_f32(acc);
+		const float32x2_t m = vpmax_f32(vget_low_f32(absolute), vget_high_f32(absolute));
+		peak = std::max(peak, std::max(vget_lane_f32(m, 0), vget_lane_f32(m, 1)));
+#else
+		for (ma_uint32 p = 0; p < 4; ++p) {
+			float acc = 0.0f;
+			for (ma_uint32 k = 0; k < kTaps; ++k) acc += pWindow[kTaps - 1 - k] * kPhaseTaps[k][p];
+			peak = std::max(peak, std::abs(acc));
+		}
+#endif
+
+		// The sample itself, aligned with the interpolated phases.
+		peak = std::max(peak, std::abs(pWindow[kTaps - 1 - kDetectorDelay]));
+	}
+	return peak;
+}
+
+void Limiter::Process(float *pBuffer, ma_uint32 frameCount) {
+	const ma_uint32 releaseMs = m_releaseMs.load(std::memory_order_relaxed);
+	if (releaseMs != m_appliedReleaseMs) {
+		m_appliedReleaseMs = releaseMs;
+		m_releaseCoeff = 1.0f - std::exp(-1000.0f / (std::max(releaseMs, 1u) * static_cast<float>(m_sampleRate)));
+	}
+
+	float minGain = 1.0f;
+
+	for (ma_uint32 done = 0; done < frameCount;) {
+		const ma_uint32 n = std::min(kBlockFrames, frameCount - done);
+		float *pBlock = pBuffer + static_cast<size_t>(done) * m_channels;
+
+		for (ma_uint32 i = 0; i < n; ++i) {
+			float *pFrame = pBlock + static_cast<size_t>(i) * m_channels;
+
+			const float peak = detect(pFrame);
+			const float required = peak > m_ceiling ? m_ceiling / peak : 1.0f;
+
+			// Sliding minimum over the window: drop larger values from the back, expired from the front.
+			while (m_minTail != m_minHead && m_minValues[(m_minTail - 1) & m_minMask] >= required) --m_minTail;
+			m_minValues[m_minTail & m_minMask] = required;
+			m_minIndices[m_minTail & m_minMask] = m_frameIndex;
+			++m_minTail;
+			if (m_minIndices[m_minHead & m_minMask] + m_minWindow <= m_frameIndex) ++m_minHead;
+			const float windowMin = m_minValues[m_minHead & m_minMask];
+			++m_frameIndex;
+
+			// Moving average: the gain glides down over exactly the lookahead.
+			m_boxSum += windowMin - m_box[m_boxPos];
+			m_box[m_boxPos] = windowMin;
+			m_boxPos = (m_boxPos + 1) % m_lookahead;
+			const float smoothed = static_cast<float>(m_boxSum / m_lookahead);
+
+			// Attack follows the average immediately; release returns toward it exponentially.
+			m_gain = smoothed < m_gain ? smoothed : m_gain + (smoothed - m_gain) * m_releaseCoeff;
+			m_gains[i] = m_gain;
+			minGain = std::min(minGain, m_gain);
+
+			// Swap the frame with the one leaving the delay line.
+			float *pDelayed = m_delay.data() + static_cast<size_t>(m_delayPos) * m_channels;
+			for (ma_uint32 c = 0; c < m_channels; ++c) std::swap(pFrame[c], pDelayed[c]);
+			m_delayPos = (m_delayPos + 1) % m_delayFrames;
+		}
+
+		MixGainCurve(pBlock, m_gains.data(), n, m_channels);
+		done += n;
+	}
+
+	m_reductionDb.store(minGain < 1.0f ? -20.0f * std::log10(minGain) : 0.0f, std::memory_order_relaxed);
+}
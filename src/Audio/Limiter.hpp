@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include "miniaudio.h"
+
+// Lookahead brick-wall limiter on interleaved f32, keeping true peaks under a fixed ceiling.
+//
+// Peaks are detected on a 4x oversampled signal (the BS.1770 interpolation filter, evaluated
+// four phases at a time with SIMD), so inter-sample overs that a DAC or a later resampler
+// would reconstruct are caught too. The gain for each frame is the minimum required over the
+// lookahead window, smoothed by a moving average of the same length (the gain reaches the
+// required value exactly when the peak leaves the delay line) and released with a one-pole
+// return toward unity. One gain is applied to all channels, so the stereo image is kept.
+//
+// The audio is delayed by GetLatencyFrames(). Process() must only be called from the audio
+// callback; the release setter and the getters are safe from any thread.
+class Limiter {
+public:
+	static constexpr float CeilingDb = -0.1f; // true-peak ceiling, dBTP
+
+	static constexpr ma_uint32 MinLookaheadMs = 1;
+	static constexpr ma_uint32 MaxLookaheadMs = 20;
+	static constexpr ma_uint32 DefaultLookaheadMs = 5;
+	static constexpr ma_uint32 DefaultReleaseMs = 100;
+
+	// Allocates the delay line; the lookahead is fixed until the next Reset().
+	void Reset(ma_uint32 sampleRate, ma_uint32 channels, ma_uint32 lookaheadMs, ma_uint32 releaseMs);
+
+	// Limit frameCount interleaved frames in place.
+	void Process(float *pBuffer, ma_uint32 frameCount);
+
+	void SetRelease(ma_uint32 releaseMs) { m_releaseMs.store(releaseMs, std::memory_order_relaxed); }
+
+	ma_uint32 GetLatencyFrames() const { return m_latencyFrames.load(std::memory_order_relaxed); }
+	float GetGainReductionDb() const { return m_reductionDb.load(std::memory_order_relaxed); } // last block, >= 0
+
+private:
+	static constexpr ma_uint32 kTaps = 12; // per phase
+
+	float detect(const float *pFrame); // true peak of one frame across channels
+
+	ma_uint32 m_sampleRate = 48000;
+	ma_uint32 m_channels = 2;
+	ma_uint32 m_lookahead = 0; // frames
+	float m_ceiling = 1.0f;
+
+	// Oversampling filter history, per channel, stored twice so taps read contiguously.
+	std::vector<float> m_history;
+	ma_uint32 m_historyPos = 0;
+
+	// Audio delay line (interleaved frames).
+	std::vector<float> m_delay;
+	ma_uint32 m_delayFrames = 0;
+	ma_uint32 m_delayPos = 0;
+
+	// Sliding minimum of the required gain (monotonic queue).
+	std::vector<float> m_minValues;
+	std::vector<ma_uint64> m_minIndices;
+	ma_uint32 m_minMask = 0;
+	ma_uint64 m_minHead = 0, m_minTail = 0;
+	ma_uint32 m_minWindow = 0;
+	ma_uint64 m_frameIndex = 0;
+
+	// Moving average of the sliding minimum.
+	std::vector<float> m_box;
+	ma_uint32 m_boxPos = 0;
+	double m_boxSum = 0.0;
+
+	float m_gain = 1.0f;
+	ma_uint32 m_appliedReleaseMs = 0;
+	float m_releaseCoeff = 0.0f;
+	std::vector<float> m_gains; // per-frame gain of the current block
+
+	std::atomic<ma_uint32> m_releaseMs = DefaultReleaseMs;
+	std::atomic<ma_uint32> m_latencyFrames = 0;
+	std::atomic<float> m_reductionDb = 0.0f;
+};
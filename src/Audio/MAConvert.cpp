@@ -1,5 +1,6 @@
 #include "MAConvert.hpp"
 #include <array>
+#include <algorithm>
 
 /// Generic mapping between an enum type and its string representation.
 template <typename Enum>
@@ -0,0 +1,134 @@
+#include "MixKernels.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define MIX_KERNELS_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define MIX_KERNELS_NEON
+#endif
+
+void MixScale(float *pBuffer, float gain, size_t count) {
+	if (gain == 1.0f) return;
+	size_t i = 0;
+
+#if defined(MIX_KERNELS_SSE)
+	const __m128 g = _mm_set1_ps(gain);
+	for (; i + 8 <= count; i += 8) {
+		_mm_storeu_ps(pBuffer + i, _mm_mul_ps(_mm_loadu_ps(pBuffer + i), g));
+		_mm_storeu_ps(pBuffer + i + 4, _mm_mul_ps(_mm_loadu_ps(pBuffer + i + 4), g));
+	}
+#elif defined(MIX_KERNELS_NEON)
+	const float32x4_t g = vdupq_n_f32(gain);
+	for (; i + 8 <= count; i += 8) {
+		vst1q_f32(pBuffer + i, vmulq_f32(vld1q_f32(pBuffer + i), g));
+		vst1q_f32(pBuffer + i + 4, vmulq_f32(vld1q_f32(pBuffer + i + 4), g));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		pBuffer[i] *= gain;
+	}
+}
+
+void MixAccumulate(float *pDst, const float *pSrc, float gain, size_t count) {
+	size_t i = 0;
+
+#if defined(MIX_KERNELS_SSE)
+	const __m128 g = _mm_set1_ps(gain);
+	for (; i + 8 <= count; i += 8) {
+		_mm_storeu_ps(pDst + i, _mm_add_ps(_mm_loadu_ps(pDst + i), _mm_mul_ps(_mm_loadu_ps(pSrc + i), g)));
+		_mm_storeu_ps(pDst + i + 4, _mm_add_ps(_mm_loadu_ps(pDst + i + 4), _mm_mul_ps(_mm_loadu_ps(pSrc + i + 4), g)));
+	}
+#elif defined(MIX_KERNELS_NEON)
+	const float32x4_t g = vdupq_n_f32(gain);
+	for (; i + 8 <= count; i += 8) {
+		vst1q_f32(pDst + i, vmlaq_f32(vld1q_f32(pDst + i), vld1q_f32(pSrc + i), g));
+		vst1q_f32(pDst + i + 4, vmlaq_f32(vld1q_f32(pDst + i + 4), vld1q_f32(pSrc + i + 4), g));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		pDst[i] += pSrc[i] * gain;
+	}
+}
+
+void MixRamp(float *pBuffer, float gainStart, float gainStep, size_t frameCount, size_t channels) {
+	size_t frame = 0;
+
+#if defined(MIX_KERNELS_SSE) || defined(MIX_KERNELS_NEON)
+	// Mono and stereo cover four samples (four or two frames) per vector; the gain vector
+	// steps by a whole vector's worth of frames. Other layouts take the scalar path.
+	if (channels == 1 || channels == 2) {
+		const size_t framesPerVector = 4 / channels;
+		const float o1 = channels == 1 ? 1.0f : 0.0f;
+		const float o2 = channels == 1 ? 2.0f : 1.0f;
+		const float o3 = channels == 1 ? 3.0f : 1.0f;
+		const float advance = gainStep * framesPerVector;
+
+	#if defined(MIX_KERNELS_SSE)
+		__m128 g = _mm_add_ps(_mm_set1_ps(gainStart), _mm_mul_ps(_mm_set1_ps(gainStep), _mm_setr_ps(0.0f, o1, o2, o3)));
+		const __m128 d = _mm_set1_ps(advance);
+		for (; frame + framesPerVector <= frameCount; frame += framesPerVector) {
+			float *p = pBuffer + frame * channels;
+			_mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), g));
+			g = _mm_add_ps(g, d);
+		}
+	#else
+		const float offsets[4] = {0.0f, o1, o2, o3};
+		float32x4_t g = vmlaq_n_f32(vdupq_n_f32(gainStart), vld1q_f32(offsets), gainStep);
+		const float32x4_t d = vdupq_n_f32(advance);
+		for (; frame + framesPerVector <= frameCount; frame += framesPerVector) {
+			float *p = pBuffer + frame * channels;
+			vst1q_f32(p, vmulq_f32(vld1q_f32(p), g));
+			g = vaddq_f32(g, d);
+		}
+	#endif
+	}
+#endif
+
+	for (; frame < frameCount; ++frame) {
+		const float gain = gainStart + gainStep * static_cast<float>(frame);
+		for (size_t c = 0; c < channels; ++c) {
+			pBuffer[frame * channels + c] *= gain;
+		}
+	}
+}
+
+void MixGainCurve(float *pBuffer, const float *pGains, size_t frameCount, size_t channels) {
+	size_t frame = 0;
+
+#if defined(MIX_KERNELS_SSE)
+	if (channels == 1) {
+		for (; frame + 4 <= frameCount; frame += 4) {
+			_mm_storeu_ps(pBuffer + frame, _mm_mul_ps(_mm_loadu_ps(pBuffer + frame), _mm_loadu_ps(pGains + frame)));
+		}
+	} else if (channels == 2) {
+		for (; frame + 4 <= frameCount; frame += 4) {
+			const __m128 g = _mm_loadu_ps(pGains + frame);
+			float *p = pBuffer + frame * 2;
+			_mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), _mm_unpacklo_ps(g, g)));
+			_mm_storeu_ps(p + 4, _mm_mul_ps(_mm_loadu_ps(p + 4), _mm_unpackhi_ps(g, g)));
+		}
+	}
+#elif defined(MIX_KERNELS_NEON)
+	if (channels == 1) {
+		for (; frame + 4 <= frameCount; frame += 4) {
+			vst1q_f32(pBuffer + frame, vmulq_f32(vld1q_f32(pBuffer + frame), vld1q_f32(pGains + frame)));
+		}
+	} else if (channels == 2) {
+		for (; frame + 4 <= frameCount; frame += 4) {
+			const float32x4x2_t g = vzipq_f32(vld1q_f32(pGains + frame), vld1q_f32(pGains + frame));
+			float *p = pBuffer + frame * 2;
+			vst1q_f32(p, vmulq_f32(vld1q_f32(p), g.val[0]));
+			vst1q_f32(p + 4, vmulq_f32(vld1q_f32(p + 4), g.val[1]));
+		}
+	}
+#endif
+
+	for (; frame < frameCount; ++frame) {
+		for (size_t c = 0; c < channels; ++c) {
+			pBuffer[frame * channels + c] *= pGains[frame];
+		}
+	}
+}
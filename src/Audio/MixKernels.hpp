@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+
+// Vectorized f32 mixing kernels (SSE on x86, NEON on ARM, scalar otherwise).
+// Buffers need no particular alignment; count is in samples, not frames.
+
+void MixScale(float *pBuffer, float gain, size_t count);                          // buffer *= gain
+void MixAccumulate(float *pDst, const float *pSrc, float gain, size_t count);    // dst += src * gain
+
+// Interleaved buffer *= a per-frame linear ramp: frame n gets gainStart + n * gainStep.
+void MixRamp(float *pBuffer, float gainStart, float gainStep, size_t frameCount, size_t channels);
+
+// Interleaved buffer *= a per-frame gain curve: frame n gets pGains[n] on every channel.
+void MixGainCurve(float *pBuffer, const float *pGains, size_t frameCount, size_t channels);
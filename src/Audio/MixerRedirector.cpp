@@ -0,0 +1,274 @@
+#include "AudioRedirector.hpp"
+#include <format>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+#include "MAConvert.hpp"
+#include "AudioInternal.hpp"
+#include "BroadcastRing.hpp"
+#include "RingReader.hpp"
+#include "MixKernels.hpp"
+#include "GainStage.hpp"
+#include "SampleConvert.hpp"
+
+namespace internal::mixer {
+    constexpr ma_uint32 chunkFrames = 1024; // Mix block size
+
+    struct Source {
+        ma_device device = {};
+        ma_format format = ma_format_f32;
+        BroadcastRing ring;                // Written by this source's device only
+        RingReader reader;                 // Aligns the source to the output clock and rate
+        GainStage gain;                    // Ramped per-source volume
+    };
+
+    ma_format format = ma_format_f32;      // Output device format
+    ma_uint32 channels = 2;
+    ma_uint32 sampleRate = 48000;
+
+    ma_device playbackDevice = {};
+    std::vector<std::unique_ptr<Source>> sources;
+    std::vector<float> mixBuffer;          // f32 sum of all sources
+    std::vector<float> sourceBuffer;       // f32 staging for one source
+    std::mutex mutex;                      // Held by Start and Stop throughout, and by the accessors into sources
+
+    // Mix cost, written by the playback callback only
+    std::atomic<double> lastMicros = 0.0;
+    std::atomic<double> averageMicros = 0.0;
+    std::atomic<double> peakMicros = 0.0;
+    std::atomic<double> periodMicros = 0.0;
+
+    void stop();
+    void stop_and_uninit(ma_device *device);
+
+    void data_callback_source(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+    void data_callback_mix(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+}; // namespace internal::mixer
+
+// ============================================================================
+// Public API accessors
+// ============================================================================
+
+ma_result AudioRedirector::SetMixerVolume(ma_uint32 index, float volume) {
+    std::lock_guard lock(internal::mixer::mutex);
+    if (index >= internal::mixer::sources.size()) return MA_INVALID_ARGS;
+    internal::mixer::sources[index]->gain.SetTarget(volume);
+    return MA_SUCCESS;
+}
+
+MixerCost AudioRedirector::GetMixerCost() {
+    using namespace internal::mixer;
+
+    const double average = averageMicros.load(std::memory_order_relaxed);
+    const double period = periodMicros.load(std::memory_order_relaxed);
+
+    return MixerCost{
+        lastMicros.load(std::memory_order_relaxed),
+        average,
+        peakMicros.load(std::memory_order_relaxed),
+        period > 0.0 ? 100.0 * average / period : 0.0,
+    };
+}
+
+// ============================================================================
+// Main Implementation
+// ============================================================================
+
+ResultVoid AudioRedirector::StartMixerRedirect(
+    const MixerSource *mixerSources, ma_uint32 sourceCount, const ma_device_id *playbackId
+) {
+    using namespace internal::mixer;
+
+    if (mixerSources == nullptr || sourceCount == 0) {
+        return Error("Mixer requires at least one source device.");
+    }
+
+    std::lock_guard lock(mutex);
+    stop(); // Restart from a clean state if already running
+
+    // The mix runs at the loopback settings; every source is resampled onto that clock, and
+    // captured at the playback channel count (the source device's converter remixes).
+    format = GetLoopbackPlaybackFormat();
+    channels = GetLoopbackPlaybackChannels();
+    sampleRate = GetLoopbackSampleRate();
+    const ma_uint32 latencyMs = GetLoopbackLatency();
+
+    for (ma_uint32 i = 0; i < sourceCount; ++i) {
+        const MixerSource &mixerSource = mixerSources[i];
+        if (mixerSource.type != ma_device_type_capture && mixerSource.type != ma_device_type_loopback) {
+            stop();
+            return Error(std::format("Mixer source #{} must be a capture or loopback device.", i + 1));
+        }
+
+        const bool isLoopback = mixerSource.type == ma_device_type_loopback;
+        const ma_uint32 sourceRate = isLoopback ? GetLoopbackSampleRate() : GetDuplexSampleRate();
+
+        auto source = std::make_unique<Source>();
+        source->format = isLoopback ? GetLoopbackFormat() : GetDuplexFormat();
+        source->gain.SetTarget(mixerSource.volume);
+        source->gain.Reset(sampleRate); // Runs on the output clock
+
+        // Every source pre-rolls to the same target latency and is drift-locked to the
+        // output clock, which keeps their timelines aligned at the mix point.
+        source->reader.Reset(
+            channels, sourceRate, sampleRate, latencyMs, chunkFrames, isLoopback ? GetLoopbackResampler() : GetDuplexResampler()
+        );
+
+        ma_result result = source->ring.Init(
+            ma_get_bytes_per_frame(source->format, channels), JitterBuffer::CapacityFor(sourceRate, latencyMs)
+        );
+        if (result != MA_SUCCESS) {
+            stop();
+            return Error(std::format(
+                "Failed to initialize mixer ring buffer #{} ({}).",
+                i + 1, ma::convert::to_string(result)
+            ));
+        }
+
+        ma_device_config config = ma_device_config_init(mixerSource.type);
+        config.capture.pDeviceID = mixerSource.deviceId;
+        config.capture.format = source->format;
+        config.capture.channels = channels;
+        config.sampleRate = sourceRate;
+        config.dataCallback = data_callback_source;
+        config.pUserData = source.get();
+
+        result = ma_device_init(&internal::context, &config, &source->device);
+        if (result != MA_SUCCESS) {
+            source->ring.Uninit();
+            stop();
+            return Error(std::format(
+                "Failed to initialize mixer source device #{} ({}).",
+                i + 1, ma::convert::to_string(result)
+            ));
+        }
+        sources.push_back(std::move(source));
+    }
+
+    mixBuffer.assign((size_t)chunkFrames * channels, 0.0f);
+    sourceBuffer.assign((size_t)chunkFrames * channels, 0.0f);
+
+    lastMicros.store(0.0, std::memory_order_relaxed);
+    averageMicros.store(0.0, std::memory_order_relaxed);
+    peakMicros.store(0.0, std::memory_order_relaxed);
+    periodMicros.store(0.0, std::memory_order_relaxed);
+
+    // --- Configure output ---
+    ma_device_config config = ma_device_config_init(ma_device_type_playback);
+    config.playback.pDeviceID = playbackId;
+    config.playback.format = format;
+    config.playback.channels = channels;
+    config.sampleRate = sampleRate;
+    config.dataCallback = data_callback_mix;
+
+    ma_result result = ma_device_init(&internal::context, &config, &playbackDevice);
+    if (result != MA_SUCCESS) {
+        stop();
+        return Error(std::format(
+            "Failed to initialize mixer playback device ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    for (ma_uint32 i = 0; i < sources.size(); ++i) {
+        result = ma_device_start(&sources[i]->device);
+        if (result != MA_SUCCESS) {
+            stop();
+            return Error(std::format(
+                "Failed to start mixer source device #{} ({}).",
+                i + 1, ma::convert::to_string(result)
+            ));
+        }
+    }
+
+    result = ma_device_start(&playbackDevice);
+    if (result != MA_SUCCESS) {
+        stop();
+        return Error(std::format(
+            "Failed to start mixer playback device ({}).",
+            ma::convert::to_string(result)
+        ));
+    }
+
+    return std::monostate{};
+}
+
+ResultVoid AudioRedirector::StopMixerRedirect()
+{
+    std::lock_guard lock(internal::mixer::mutex);
+    internal::mixer::stop();
+    return std::monostate{};
+}
+
+void internal::mixer::stop()
+{
+    // Stop the reader first; it walks every source ring.
+    stop_and_uninit(&playbackDevice);
+
+    for (auto &source : sources) {
+        stop_and_uninit(&source->device);
+        source->ring.Uninit();
+    }
+    sources.clear();
+}
+
+void internal::mixer::stop_and_uninit(ma_device *device) {
+    const ma_device_state device_state = ma_device_get_state(device);
+
+    if (device_state == ma_device_state_started || device_state == ma_device_state_starting) {
+        ma_device_stop(device);
+    }
+    if (device_state != ma_device_state_uninitialized) {
+        ma_device_uninit(device);
+    }
+    *device = {};
+}
+
+// Source -> write to this source's ring
+void internal::mixer::data_callback_source(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pOutput;
+    static_cast<Source*>(pDevice->pUserData)->ring.Write(pInput, frameCount);
+}
+
+// Playback -> pull every source onto the output clock, sum with per-source gain, convert
+void internal::mixer::data_callback_mix(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+{
+    (void)pDevice; (void)pInput;
+
+    const auto start = std::chrono::steady_clock::now();
+    const ma_uint32 bytesPerFrame = ma_get_bytes_per_frame(format, channels);
+    const ma_uint32 totalFrames = frameCount;
+
+    ma_uint8* pOut = (ma_uint8*)pOutput;
+    while (frameCount > 0) {
+        const ma_uint32 chunk = std::min(frameCount, chunkFrames);
+        const size_t samples = (size_t)chunk * channels;
+
+        std::fill_n(mixBuffer.data(), samples, 0.0f);
+
+        for (auto &source : sources) {
+            const ma_uint32 rendered = source->reader.Render(source->ring, source->format, sourceBuffer.data(), chunk);
+            source->gain.Process(sourceBuffer.data(), rendered, channels);
+            // An underrunning source contributes silence for the frames it could not render.
+            MixAccumulate(mixBuffer.data(), sourceBuffer.data(), 1.0f, (size_t)rendered * channels);
+        }
+
+        SampleConvert::Convert(pOut, format, mixBuffer.data(), ma_format_f32, samples);
+
+        pOut += (size_t)chunk * bytesPerFrame;
+        frameCount -= chunk;
+    }
+
+    const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    const double average = averageMicros.load(std::memory_order_relaxed);
+
+    lastMicros.store(elapsed, std::memory_order_relaxed);
+    averageMicros.store(average == 0.0 ? elapsed : average + 0.05 * (elapsed - average), std::memory_order_relaxed);
+    peakMicros.store(std::max(peakMicros.load(std::memory_order_relaxed), elapsed), std::memory_order_relaxed);
+    periodMicros.store(1e6 * totalFrames / sampleRate, std::memory_order_relaxed);
+}
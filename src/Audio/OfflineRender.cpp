@@ -0,0 +1,184 @@
+#include "AudioRedirector.hpp"
+#include <format>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "MAConvert.hpp"
+#include "AudioInternal.hpp"
+#include "WavFile.hpp"
+
+namespace internal::render {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t writeBytes = 1 << 20; // The output is written in blocks of about this size
+
+    // miniaudio's default periods, where the backend has no say
+    constexpr ma_uint32 lowLatencyPeriodMs = 10;
+    constexpr ma_uint32 conservativePeriodMs = 100;
+
+    using RoutePtr = std::unique_ptr<OfflineRoute, void (*)(OfflineRoute *)>;
+
+    ma_uint32 period_frames(const PeriodConfig &period, ma_uint32 sampleRate);
+    Result<RenderReport, Error> render(ma_device_type sourceType, const std::string &inputPath, const std::string &outputPath);
+}; // namespace internal::render
+
+// ============================================================================
+// Main Implementation
+// ============================================================================
+
+Result<RenderReport, Error> AudioRedirector::RenderLoopbackFile(const std::string &inputPath, const std::string &outputPath) {
+    return internal::render::render(ma_device_type_loopback, inputPath, outputPath);
+}
+
+Result<RenderReport, Error> AudioRedirector::RenderDuplexFile(const std::string &inputPath, const std::string &outputPath) {
+    return internal::render::render(ma_device_type_capture, inputPath, outputPath);
+}
+
+// ============================================================================
+// Internal helpers
+// ============================================================================
+
+// The period a device opened with these settings would get where the backend has no say.
+ma_uint32 internal::render::period_frames(const PeriodConfig &period, ma_uint32 sampleRate) {
+    if (period.periodSizeInFrames != 0) return period.periodSizeInFrames;
+    const ma_uint32 periodMs = period.performanceProfile == ma_performance_profile_conservative
+        ? conservativePeriodMs
+        : lowLatencyPeriodMs;
+    return std::max<ma_uint32>(sampleRate * periodMs / 1000, 1);
+}
+
+Result<RenderReport, Error> internal::render::render(
+    ma_device_type sourceType, const std::string &inputPath, const std::string &outputPath
+) {
+    using namespace AudioRedirector;
+    const bool loopback = sourceType == ma_device_type_loopback;
+
+    MappedWavFile input;
+    ma_result result = input.Open(inputPath.c_str());
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to open '{}' ({}).", inputPath, ma::convert::to_string(result)));
+    }
+
+    StreamFormat format = loopback
+        ? StreamFormat{GetLoopbackFormat(), GetLoopbackPlaybackFormat(), GetLoopbackChannels(), GetLoopbackPlaybackChannels(), GetLoopbackSampleRate()}
+        : StreamFormat{GetDuplexFormat(), GetDuplexPlaybackFormat(), GetDuplexChannels(), GetDuplexPlaybackChannels(), GetDuplexSampleRate()};
+    if (loopback ? IsLoopbackAutoFormat() : IsDuplexAutoFormat()) {
+        const ma_uint32 channels = std::min(input.GetChannels(), MaxChannels);
+        format = {input.GetFormat(), input.GetFormat(), channels, channels, input.GetSampleRate()};
+    }
+
+    RenderReport report = {};
+    report.inputFormat = input.GetFormat();
+    report.inputChannels = input.GetChannels();
+    report.inputSampleRate = input.GetSampleRate();
+    report.format = format.format;
+    report.channels = format.channels;
+    report.playbackFormat = format.playbackFormat;
+    report.playbackChannels = format.playbackChannels;
+    report.sampleRate = format.sampleRate;
+    report.periodFrames = period_frames(loopback ? GetLoopbackPeriodConfig() : GetDuplexPeriodConfig(), format.sampleRate);
+    report.convertsInput = input.GetFormat() != format.format || input.GetChannels() != format.channels ||
+        input.GetSampleRate() != format.sampleRate;
+
+    // What a capture device's converter would do between the file and the capture side.
+    ma_data_converter converter;
+    if (report.convertsInput) {
+        ma_data_converter_config config = ma_data_converter_config_init(
+            input.GetFormat(), format.format, input.GetChannels(), format.channels, input.GetSampleRate(), format.sampleRate
+        );
+        set_resampler(config.resampling, loopback ? GetLoopbackResampler() : GetDuplexResampler());
+        result = ma_data_converter_init(&config, nullptr, &converter);
+        if (result != MA_SUCCESS) {
+            return Error(std::format("Failed to set up the input conversion ({}).", ma::convert::to_string(result)));
+        }
+    }
+    const auto converterGuard = std::unique_ptr<ma_data_converter, void (*)(ma_data_converter *)>(
+        report.convertsInput ? &converter : nullptr, [](ma_data_converter *converter) { ma_data_converter_uninit(converter, nullptr); }
+    );
+
+    RoutePtr route(create_offline_route(sourceType, format), destroy_offline_route);
+    if (!route) {
+        return Error(std::format("Failed to build the pipeline ({}).", ma::convert::to_string(MA_OUT_OF_MEMORY)));
+    }
+
+    WavWriter output;
+    result = output.Open(outputPath.c_str(), format.playbackFormat, format.playbackChannels, format.sampleRate);
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to create '{}' ({}).", outputPath, ma::convert::to_string(result)));
+    }
+
+    const ma_uint32 periodFrames = report.periodFrames;
+    const ma_uint32 inputBytesPerFrame = ma_get_bytes_per_frame(input.GetFormat(), input.GetChannels());
+    const ma_uint32 outputBytesPerFrame = ma_get_bytes_per_frame(format.playbackFormat, format.playbackChannels);
+    const size_t periodBytes = (size_t)periodFrames * outputBytesPerFrame;
+
+    // Converted input, or silence once the input ran out.
+    std::vector<ma_uint8> capture((size_t)periodFrames * ma_get_bytes_per_frame(format.format, format.channels));
+    std::vector<ma_uint8> staging(std::max<size_t>(writeBytes / periodBytes, 1) * periodBytes);
+    size_t staged = 0;
+
+    // The loopback path holds its input back by the jitter buffer's latency; run it on with
+    // silence as a loopback capture of a quiet device would deliver, until that is played out.
+    ma_uint64 tailFrames = loopback ? (ma_uint64)GetLoopbackLatency() * format.sampleRate / 1000 + periodFrames : 0;
+
+    const ma_uint8 *pInput = static_cast<const ma_uint8 *>(input.GetFrames());
+    ma_uint64 inputLeft = input.GetFrameCount();
+    Clock::duration inCallbacks{};
+    const auto start = Clock::now();
+
+    for (;;) {
+        const void *pCapture = capture.data();
+        ma_uint32 frames = 0;
+
+        if (inputLeft > 0 && report.convertsInput) {
+            ma_uint64 framesIn = inputLeft;
+            ma_uint64 framesOut = periodFrames;
+            ma_data_converter_process_pcm_frames(&converter, pInput, &framesIn, capture.data(), &framesOut);
+            pInput += framesIn * inputBytesPerFrame;
+            inputLeft -= framesIn;
+            report.framesIn += framesIn;
+            frames = (ma_uint32)framesOut;
+            if (framesIn == 0 && framesOut == 0) inputLeft = 0; // What the resampler holds back stays there, as live
+        } else if (inputLeft > 0) {
+            // Already in the capture format: the callbacks read the mapping in place.
+            frames = (ma_uint32)std::min<ma_uint64>(inputLeft, periodFrames);
+            pCapture = pInput;
+            pInput += (size_t)frames * inputBytesPerFrame;
+            inputLeft -= frames;
+            report.framesIn += frames;
+        } else if (tailFrames > 0) {
+            frames = (ma_uint32)std::min<ma_uint64>(tailFrames, periodFrames);
+            ma_silence_pcm_frames(capture.data(), frames, format.format, format.channels);
+            tailFrames -= frames;
+        } else {
+            break;
+        }
+        if (frames == 0) continue;
+
+        if (staged + periodBytes > staging.size()) {
+            output.Write(staging.data(), staged);
+            staged = 0;
+        }
+
+        const auto callStart = Clock::now();
+        offline_process(route.get(), staging.data() + staged, pCapture, frames);
+        inCallbacks += Clock::now() - callStart;
+
+        staged += (size_t)frames * outputBytesPerFrame;
+        report.framesOut += frames;
+    }
+
+    if (staged > 0) output.Write(staging.data(), staged);
+    result = output.Close();
+    report.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.callbackSeconds = std::chrono::duration<double>(inCallbacks).count();
+    if (result != MA_SUCCESS) {
+        return Error(std::format("Failed to write '{}' ({}).", outputPath, ma::convert::to_string(result)));
+    }
+
+    const double audioSeconds = (double)report.framesOut / format.sampleRate;
+    report.realtimeFactor = report.totalSeconds > 0.0 ? audioSeconds / report.totalSeconds : 0.0;
+    return report;
+}
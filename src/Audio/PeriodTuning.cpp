@@ -0,0 +1,148 @@
+#include "AudioRedirector.hpp"
+#include <format>
+
+#include "AudioInternal.hpp"
+
+namespace internal::tuning {
+    constexpr ma_uint32 minPeriodFrames = 32; // Below this the callback overhead dominates
+
+    // One redirect path as the tuner sees it, through the public API.
+    struct Path {
+        const char *name;
+        void (*setConfig)(const PeriodConfig &config);
+        PeriodConfig (*getConfig)();
+        ResultVoid (*reconfigure)();
+        PeriodTrial (*read)(const RedirectorStats &stats); // Periods, xruns and late callbacks so far
+        const RecoveryStats &(*recovery)(const RedirectorStats &stats);
+    };
+
+    Result<PeriodTuneReport, Error> tune(const Path &path, ma_uint32 observeMs);
+    PeriodTrial observe(const Path &path, ma_uint32 requestedFrames, ma_uint32 observeMs);
+    ma_uint32 failures(const RecoveryStats &recovery);
+
+    const Path loopback = {
+        "loopback",
+        AudioRedirector::SetLoopbackPeriodConfig,
+        AudioRedirector::GetLoopbackPeriodConfig,
+        AudioRedirector::ReconfigureLoopbackRedirect,
+        [](const RedirectorStats &stats) {
+            // The playback side underruns when it is starved, the capture side overruns the ring.
+            PeriodTrial trial = {};
+            trial.playbackFrames = stats.loopbackPlayback.periodFrames;
+            trial.captureFrames = stats.loopbackCapture.periodFrames;
+            trial.xruns = stats.loopbackPlayback.underruns + stats.loopbackCapture.overruns;
+            trial.lateCallbacks = stats.loopbackPlayback.lateCallbacks + stats.loopbackCapture.lateCallbacks;
+            return trial;
+        },
+        [](const RedirectorStats &stats) -> const RecoveryStats & { return stats.loopbackRecovery; }
+    };
+
+    const Path duplex = {
+        "duplex",
+        AudioRedirector::SetDuplexPeriodConfig,
+        AudioRedirector::GetDuplexPeriodConfig,
+        AudioRedirector::ReconfigureDuplexRedirect,
+        [](const RedirectorStats &stats) {
+            PeriodTrial trial = {};
+            trial.playbackFrames = stats.duplex.periodFrames;
+            trial.captureFrames = stats.duplex.periodFrames; // One device, one period
+            trial.xruns = stats.duplex.underruns + stats.duplex.overruns;
+            trial.lateCallbacks = stats.duplex.lateCallbacks;
+            return trial;
+        },
+        [](const RedirectorStats &stats) -> const RecoveryStats & { return stats.duplexRecovery; }
+    };
+}; // namespace internal::tuning
+
+// ============================================================================
+// Main Implementation
+// ============================================================================
+
+Result<PeriodTuneReport, Error> AudioRedirector::TuneLoopbackPeriod(ma_uint32 observeMs)
+{
+    return internal::tuning::tune(internal::tuning::loopback, observeMs);
+}
+
+Result<PeriodTuneReport, Error> AudioRedirector::TuneDuplexPeriod(ma_uint32 observeMs)
+{
+    return internal::tuning::tune(internal::tuning::duplex, observeMs);
+}
+
+// Step the period down from what the backend gave the running route, halving it each time, and
+// keep the smallest one the route ran cleanly with.
+Result<PeriodTuneReport, Error> internal::tuning::tune(const Path &path, ma_uint32 observeMs)
+{
+    if (path.read(AudioRedirector::GetStats()).playbackFrames == 0) {
+        return Error(std::format("No {} redirect is running.", path.name));
+    }
+
+    PeriodTuneReport report = {};
+    PeriodConfig config = path.getConfig();
+    PeriodConfig applied = config;
+
+    // The running configuration is the baseline; if it is not stable, nothing smaller will be.
+    const PeriodTrial baseline = observe(path, config.periodSizeInFrames, observeMs);
+    report.trials.push_back(baseline);
+    ma_uint32 periodFrames = baseline.playbackFrames;
+
+    while (baseline.stable && periodFrames / 2 >= minPeriodFrames) {
+        PeriodConfig candidate = config;
+        candidate.periodSizeInFrames = periodFrames / 2;
+
+        path.setConfig(candidate);
+        applied = candidate;
+        if (!path.reconfigure()) {
+            report.trials.push_back({candidate.periodSizeInFrames, 0, 0, 0, 0, false, true, false});
+            break;
+        }
+
+        const PeriodTrial trial = observe(path, candidate.periodSizeInFrames, observeMs);
+        report.trials.push_back(trial);
+
+        // A backend that rounds the request back up has no smaller period to give.
+        if (!trial.stable || trial.playbackFrames >= periodFrames) break;
+
+        config = candidate;
+        periodFrames = trial.playbackFrames;
+    }
+
+    path.setConfig(config);
+    report.config = config;
+
+    if (applied.periodSizeInFrames != config.periodSizeInFrames) {
+        ResultVoid result = path.reconfigure();
+        if (!result) return result.error();
+    }
+    return report;
+}
+
+// Watch the running route for observeMs of pipeline time, cutting the wait short at the first
+// xrun, late callback or device failure.
+PeriodTrial internal::tuning::observe(const Path &path, ma_uint32 requestedFrames, ma_uint32 observeMs)
+{
+    const RedirectorStats before = AudioRedirector::GetStats();
+    const PeriodTrial start = path.read(before);
+    const ma_uint32 startFailures = failures(path.recovery(before));
+
+    PeriodTrial trial = {};
+    const auto check = [&]() {
+        const RedirectorStats stats = AudioRedirector::GetStats();
+        const RecoveryStats &recovery = path.recovery(stats);
+
+        trial = path.read(stats);
+        trial.requestedFrames = requestedFrames;
+        trial.xruns -= start.xruns;
+        trial.lateCallbacks -= start.lateCallbacks; // Not the peak load, which spans the whole route
+        trial.late = trial.lateCallbacks > 0;
+        trial.failed = recovery.recovering || failures(recovery) != startFailures;
+        return trial.xruns > 0 || trial.late || trial.failed;
+    };
+
+    trial.stable = !internal::wait_until(check, observeMs);
+    return trial;
+}
+
+ma_uint32 internal::tuning::failures(const RecoveryStats &recovery)
+{
+    return recovery.deviceLosses + recovery.stalls + recovery.failedAttempts;
+}
@@ -0,0 +1,437 @@
+#include "PolyphaseResampler.hpp"
+#include <atomic>
+#include <cmath>
+#include <new>
+#include <numeric>
+#include <numbers>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define POLYPHASE_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define POLYPHASE_AVX2_TARGET
+	#else
+		#include <cpuid.h>
+		#define POLYPHASE_AVX2_TARGET __attribute__((target("avx2")))
+	#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define POLYPHASE_NEON
+	#include <arm_neon.h>
+#endif
+
+// One output frame: per channel, the dot product of its history window with one branch.
+// taps is a multiple of 8; the windows of successive channels are stride floats apart.
+using DotKernel = void (*)(float *pOut, const float *pHistory, size_t stride, const float *pCoeffs, ma_uint32 taps, ma_uint32 channels);
+
+struct Design {
+	ma_uint32 taps;  // Per branch at the input rate, before widening for downsampling
+	double beta;     // Kaiser window shape: stopband attenuation
+	double rolloff;  // Cutoff as a fraction of the lower Nyquist frequency
+};
+
+static constexpr Design kDesigns[] = {
+	{16, 5.7, 0.80},  // Low
+	{32, 8.0, 0.88},  // Medium
+	{64, 10.0, 0.92}, // High
+};
+
+static const PolyphaseResampler::Quality kQualities[] = {
+	PolyphaseResampler::Quality::Low,
+	PolyphaseResampler::Quality::Medium,
+	PolyphaseResampler::Quality::High,
+};
+
+// ============================================================================
+// Kernels
+// ============================================================================
+
+namespace scalar {
+	void dot(float *pOut, const float *pHistory, size_t stride, const float *pCoeffs, ma_uint32 taps, ma_uint32 channels) {
+		for (ma_uint32 c = 0; c < channels; ++c) {
+			const float *x = pHistory + c * stride;
+			float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+			for (ma_uint32 i = 0; i < taps; i += 4) {
+				a0 += x[i + 0] * pCoeffs[i + 0];
+				a1 += x[i + 1] * pCoeffs[i + 1];
+				a2 += x[i + 2] * pCoeffs[i + 2];
+				a3 += x[i + 3] * pCoeffs[i + 3];
+			}
+			pOut[c] = (a0 + a1) + (a2 + a3);
+		}
+	}
+} // namespace scalar
+
+#if defined(POLYPHASE_X86)
+namespace sse2 {
+	inline float sum(__m128 v) {
+		v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+		return _mm_cvtss_f32(v);
+	}
+
+	void dot(float *pOut, const float *pHistory, size_t stride, const float *pCoeffs, ma_uint32 taps, ma_uint32 channels) {
+		for (ma_uint32 c = 0; c < channels; ++c) {
+			const float *x = pHistory + c * stride;
+			__m128 a0 = _mm_setzero_ps();
+			__m128 a1 = _mm_setzero_ps();
+			for (ma_uint32 i = 0; i < taps; i += 8) {
+				a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(x + i + 0), _mm_loadu_ps(pCoeffs + i + 0)));
+				a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(pCoeffs + i + 4)));
+			}
+			pOut[c] = sum(_mm_add_ps(a0, a1));
+		}
+	}
+} // namespace sse2
+
+namespace avx2 {
+	POLYPHASE_AVX2_TARGET void dot(float *pOut, const float *pHistory, size_t stride, const float *pCoeffs, ma_uint32 taps, ma_uint32 channels) {
+		for (ma_uint32 c = 0; c < channels; ++c) {
+			const float *x = pHistory + c * stride;
+			__m256 a0 = _mm256_setzero_ps();
+			__m256 a1 = _mm256_setzero_ps();
+
+			ma_uint32 i = 0;
+			for (; i + 16 <= taps; i += 16) {
+				a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_loadu_ps(x + i + 0), _mm256_loadu_ps(pCoeffs + i + 0)));
+				a1 = _mm256_add_ps(a1, _mm256_mul_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(pCoeffs + i + 8)));
+			}
+			if (i < taps) {
+				a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(pCoeffs + i)));
+			}
+
+			const __m256 s = _mm256_add_ps(a0, a1);
+			pOut[c] = sse2::sum(_mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1)));
+		}
+	}
+} // namespace avx2
+
+static bool cpu_has_avx2() {
+	#if defined(_MSC_VER)
+	int info[4] = {};
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false; // OS must save YMM state
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+	#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+	#endif
+}
+#endif // POLYPHASE_X86
+
+#if defined(POLYPHASE_NEON)
+namespace neon {
+	void dot(float *pOut, const float *pHistory, size_t stride, const float *pCoeffs, ma_uint32 taps, ma_uint32 channels) {
+		for (ma_uint32 c = 0; c < channels; ++c) {
+			const float *x = pHistory + c * stride;
+			float32x4_t a0 = vdupq_n_f32(0.0f);
+			float32x4_t a1 = vdupq_n_f32(0.0f);
+			for (ma_uint32 i = 0; i < taps; i += 8) {
+				a0 = vmlaq_f32(a0, vld1q_f32(x + i + 0), vld1q_f32(pCoeffs + i + 0));
+				a1 = vmlaq_f32(a1, vld1q_f32(x + i + 4), vld1q_f32(pCoeffs + i + 4));
+			}
+			const float32x4_t s = vaddq_f32(a0, a1);
+			const float32x2_t h = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+			pOut[c] = vget_lane_f32(vpadd_f32(h, h), 0);
+		}
+	}
+} // namespace neon
+#endif
+
+struct KernelSet {
+	PolyphaseResampler::Isa isa;
+	DotKernel dot;
+};
+
+static constexpr KernelSet kScalarKernels = {PolyphaseResampler::Isa::Scalar, scalar::dot};
+#if defined(POLYPHASE_X86)
+static constexpr KernelSet kSse2Kernels = {PolyphaseResampler::Isa::SSE2, sse2::dot};
+static constexpr KernelSet kAvx2Kernels = {PolyphaseResampler::Isa::AVX2, avx2::dot};
+#endif
+#if defined(POLYPHASE_NEON)
+static constexpr KernelSet kNeonKernels = {PolyphaseResampler::Isa::NEON, neon::dot};
+#endif
+
+static const KernelSet *best_kernels() {
+#if defined(POLYPHASE_X86)
+	return cpu_has_avx2() ? &kAvx2Kernels : &kSse2Kernels;
+#elif defined(POLYPHASE_NEON)
+	return &kNeonKernels;
+#else
+	return &kScalarKernels;
+#endif
+}
+
+// Resolved during static initialization, before any device can call in.
+static std::atomic<const KernelSet *> g_kernels = best_kernels();
+
+// ============================================================================
+// Filter design
+// ============================================================================
+
+// Zeroth order modified Bessel function of the first kind, by its power series.
+static double bessel_i0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+		const double half = x / (2.0 * k);
+		term *= half * half;
+		sum += term;
+	}
+	return sum;
+}
+
+bool PolyphaseResampler::Init(ma_uint32 channels, ma_uint32 sampleRateIn, ma_uint32 sampleRateOut, Quality quality) {
+	if (channels == 0 || sampleRateIn == 0 || sampleRateOut == 0) return false;
+
+	const Design &design = kDesigns[static_cast<int>(quality)];
+	const ma_uint32 gcd = std::gcd(sampleRateIn, sampleRateOut);
+	const double scale = std::min(1.0, static_cast<double>(sampleRateOut) / sampleRateIn);
+
+	m_channels = channels;
+	m_phases = sampleRateOut / gcd;
+	m_step = sampleRateIn / gcd;
+	m_taps = (static_cast<ma_uint32>(std::ceil(design.taps / scale)) + 7) & ~7u; // Whole vectors for every kernel
+
+	// Prototype low-pass at m_phases times the input rate; cutoff in cycles per input frame.
+	const size_t length = static_cast<size_t>(m_taps) * m_phases;
+	const double cutoff = 0.5 * scale * design.rolloff;
+	const double center = (length - 1) / 2.0;
+	const double halfWidth = length / 2.0;
+	const double window = bessel_i0(design.beta);
+
+	std::vector<double> prototype(length);
+	for (size_t m = 0; m < length; ++m) {
+		const double t = (m - center) / m_phases; // In input frames
+		const double x = (m - center) / halfWidth;
+		const double arg = 2.0 * std::numbers::pi * cutoff * t;
+		const double sinc = t == 0.0 ? 1.0 : std::sin(arg) / arg;
+		prototype[m] = 2.0 * cutoff * sinc * bessel_i0(design.beta * std::sqrt(std::max(0.0, 1.0 - x * x))) / window;
+	}
+
+	// Branch p holds prototype taps p, p + L, p + 2L ...; stored reversed so it lines up with
+	// the history window, oldest frame first. Each branch is normalized to unity gain at DC, so
+	// the gain does not ripple with the phase.
+	m_coeffs.assign(length, 0.0f);
+	for (ma_uint32 p = 0; p < m_phases; ++p) {
+		double sum = 0.0;
+		for (ma_uint32 j = 0; j < m_taps; ++j) sum += prototype[static_cast<size_t>(j) * m_phases + p];
+
+		float *branch = m_coeffs.data() + static_cast<size_t>(p) * m_taps;
+		for (ma_uint32 j = 0; j < m_taps; ++j) {
+			branch[m_taps - 1 - j] = static_cast<float>(prototype[static_cast<size_t>(j) * m_phases + p] / sum);
+		}
+	}
+
+	m_history.assign(static_cast<size_t>(channels) * m_taps * 2, 0.0f);
+	Reset();
+	return true;
+}
+
+void PolyphaseResampler::Reset() {
+	std::fill(m_history.begin(), m_history.end(), 0.0f);
+	m_write = 0;
+	m_phase = 0;
+	m_need = 1; // Output frame 0 lines up with input frame 0
+}
+
+// ============================================================================
+// Processing
+// ============================================================================
+
+void PolyphaseResampler::push(const float *pFrame) {
+	const size_t stride = static_cast<size_t>(m_taps) * 2;
+	for (ma_uint32 c = 0; c < m_channels; ++c) {
+		float *history = m_history.data() + c * stride;
+		history[m_write] = history[m_write + m_taps] = pFrame != nullptr ? pFrame[c] : 0.0f;
+	}
+	m_write = m_write + 1 == m_taps ? 0 : m_write + 1;
+}
+
+void PolyphaseResampler::Process(const float *pFramesIn, ma_uint64 *pFrameCountIn, float *pFramesOut, ma_uint64 *pFrameCountOut) {
+	const DotKernel dot = g_kernels.load(std::memory_order_relaxed)->dot;
+	const size_t stride = static_cast<size_t>(m_taps) * 2;
+	const ma_uint64 framesIn = *pFrameCountIn;
+	const ma_uint64 framesOut = *pFrameCountOut;
+	ma_uint64 in = 0;
+	ma_uint64 out = 0;
+
+	while (out < framesOut) {
+		for (; m_need > 0 && in < framesIn; ++in, --m_need) {
+			push(pFramesIn != nullptr ? pFramesIn + in * m_channels : nullptr);
+		}
+		if (m_need > 0) break;
+
+		// The window ends at the newest frame; from m_write it runs oldest to newest.
+		if (pFramesOut != nullptr) {
+			dot(pFramesOut + out * m_channels, m_history.data() + m_write, stride, m_coeffs.data() + static_cast<size_t>(m_phase) * m_taps, m_taps, m_channels);
+		}
+		++out;
+
+		m_phase += m_step;
+		m_need = m_phase / m_phases;
+		m_phase %= m_phases;
+	}
+
+	*pFrameCountIn = in;
+	*pFrameCountOut = out;
+}
+
+// Output frame k of those still to come reads up to input frame m_need - 1 + (m_phase + k * M) / L
+// past what is taken in.
+ma_uint64 PolyphaseResampler::RequiredInputFrames(ma_uint64 outputFrames) const {
+	if (outputFrames == 0) return 0;
+	return m_need + (m_phase + (outputFrames - 1) * m_step) / m_phases;
+}
+
+ma_uint64 PolyphaseResampler::ExpectedOutputFrames(ma_uint64 inputFrames) const {
+	if (inputFrames < m_need) return 0;
+	const ma_uint64 spare = inputFrames - m_need;
+	return ((spare + 1) * m_phases - m_phase + m_step - 1) / m_step;
+}
+
+ma_uint32 PolyphaseResampler::GetOutputLatency() const {
+	return static_cast<ma_uint32>((static_cast<ma_uint64>(GetInputLatency()) * m_phases + m_step / 2) / m_step);
+}
+
+// ============================================================================
+// miniaudio backend
+// ============================================================================
+
+namespace backend {
+	PolyphaseResampler &of(ma_resampling_backend *pBackend) {
+		return *static_cast<PolyphaseResampler *>(pBackend);
+	}
+
+	const PolyphaseResampler &of(const ma_resampling_backend *pBackend) {
+		return *static_cast<const PolyphaseResampler *>(pBackend);
+	}
+
+	ma_result get_heap_size(void *, const ma_resampler_config *, size_t *pHeapSizeInBytes) {
+		*pHeapSizeInBytes = 0; // The filter bank is sized by the rates; it is allocated in init
+		return MA_SUCCESS;
+	}
+
+	ma_result init(void *pUserData, const ma_resampler_config *pConfig, void *, ma_resampling_backend **ppBackend) {
+		if (pUserData == nullptr || pConfig->format != ma_format_f32) return MA_INVALID_ARGS;
+
+		PolyphaseResampler *resampler = new (std::nothrow) PolyphaseResampler;
+		if (resampler == nullptr) return MA_OUT_OF_MEMORY;
+
+		try {
+			const auto quality = *static_cast<const PolyphaseResampler::Quality *>(pUserData);
+			if (!resampler->Init(pConfig->channels, pConfig->sampleRateIn, pConfig->sampleRateOut, quality)) {
+				delete resampler;
+				return MA_INVALID_ARGS;
+			}
+		} catch (const std::bad_alloc &) {
+			delete resampler;
+			return MA_OUT_OF_MEMORY;
+		}
+
+		*ppBackend = resampler;
+		return MA_SUCCESS;
+	}
+
+	void uninit(void *, ma_resampling_backend *pBackend, const ma_allocation_callbacks *) {
+		delete &of(pBackend);
+	}
+
+	ma_result process(void *, ma_resampling_backend *pBackend, const void *pFramesIn, ma_uint64 *pFrameCountIn, void *pFramesOut, ma_uint64 *pFrameCountOut) {
+		of(pBackend).Process(static_cast<const float *>(pFramesIn), pFrameCountIn, static_cast<float *>(pFramesOut), pFrameCountOut);
+		return MA_SUCCESS;
+	}
+
+	ma_uint64 input_latency(void *, const ma_resampling_backend *pBackend) {
+		return of(pBackend).GetInputLatency();
+	}
+
+	ma_uint64 output_latency(void *, const ma_resampling_backend *pBackend) {
+		return of(pBackend).GetOutputLatency();
+	}
+
+	ma_result required_input(void *, const ma_resampling_backend *pBackend, ma_uint64 outputFrameCount, ma_uint64 *pInputFrameCount) {
+		*pInputFrameCount = of(pBackend).RequiredInputFrames(outputFrameCount);
+		return MA_SUCCESS;
+	}
+
+	ma_result expected_output(void *, const ma_resampling_backend *pBackend, ma_uint64 inputFrameCount, ma_uint64 *pOutputFrameCount) {
+		*pOutputFrameCount = of(pBackend).ExpectedOutputFrames(inputFrameCount);
+		return MA_SUCCESS;
+	}
+
+	ma_result reset(void *, ma_resampling_backend *pBackend) {
+		of(pBackend).Reset();
+		return MA_SUCCESS;
+	}
+
+	ma_resampling_backend_vtable vtable = {
+		get_heap_size,
+		init,
+		uninit,
+		process,
+		nullptr, // onSetRate: the rates of a device are fixed once it is open
+		input_latency,
+		output_latency,
+		required_input,
+		expected_output,
+		reset
+	};
+} // namespace backend
+
+ma_resampling_backend_vtable *PolyphaseResampler::BackendVTable() {
+	return &backend::vtable;
+}
+
+void *PolyphaseResampler::BackendUserData(Quality quality) {
+	return const_cast<Quality *>(&kQualities[static_cast<int>(quality)]);
+}
+
+// ============================================================================
+// Kernel selection
+// ============================================================================
+
+PolyphaseResampler::Isa PolyphaseResampler::GetIsa() {
+	return g_kernels.load(std::memory_order_relaxed)->isa;
+}
+
+bool PolyphaseResampler::SetIsa(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			g_kernels.store(&kScalarKernels);
+			return true;
+#if defined(POLYPHASE_X86)
+		case Isa::SSE2:
+			g_kernels.store(&kSse2Kernels);
+			return true;
+		case Isa::AVX2:
+			if (!cpu_has_avx2()) return false;
+			g_kernels.store(&kAvx2Kernels);
+			return true;
+#endif
+#if defined(POLYPHASE_NEON)
+		case Isa::NEON:
+			g_kernels.store(&kNeonKernels);
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+const char *PolyphaseResampler::to_string(Quality quality) {
+	switch (quality) {
+		case Quality::Low:
+			return "Low";
+		case Quality::Medium:
+			return "Medium";
+		case Quality::High:
+			return "High";
+		default:
+			return "Unknown";
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include "miniaudio.h"
+#include "SampleConvert.hpp"
+
+// Interleaved f32 sample rate converter between two fixed rates, windowed-sinc quality.
+//
+// The rate ratio is reduced to L/M (44100 -> 48000 is 160/147), and a Kaiser-windowed sinc
+// low-pass is designed at L times the input rate and split into L polyphase branches. Each
+// output frame is then one dot product of the input history with one branch, so nothing is
+// interpolated between coefficients. When downsampling, the cutoff follows the output
+// Nyquist and the branches grow by the rate ratio to keep the same transition band.
+//
+// The dot products are vectorized per instruction set and picked once at runtime, as in
+// SampleConvert: AVX2 or SSE2 on x86, NEON on ARM, scalar elsewhere.
+//
+// Plugs into miniaudio's data converter as a custom resampling backend (BackendVTable()),
+// which is how the devices of a redirect use it.
+class PolyphaseResampler {
+public:
+	enum class Quality
+	{
+		Low,    // 16 taps at the input rate, ~60 dB stopband
+		Medium, // 32 taps, ~80 dB
+		High    // 64 taps, ~100 dB
+	};
+
+	using Isa = SampleConvert::Isa;
+
+	// Designs the filter bank; not real-time safe. False on a zero rate or channel count.
+	bool Init(ma_uint32 channels, ma_uint32 sampleRateIn, ma_uint32 sampleRateOut, Quality quality);
+	void Reset(); // Clear the history; output restarts from silence
+
+	// Consume up to *pFrameCountIn frames and produce up to *pFrameCountOut; both are set to
+	// what was done. A null pFramesIn reads silence, a null pFramesOut discards the output.
+	void Process(const float *pFramesIn, ma_uint64 *pFrameCountIn, float *pFramesOut, ma_uint64 *pFrameCountOut);
+
+	ma_uint64 RequiredInputFrames(ma_uint64 outputFrames) const;
+	ma_uint64 ExpectedOutputFrames(ma_uint64 inputFrames) const;
+
+	ma_uint32 GetInputLatency() const { return m_taps / 2; } // Group delay, in input frames
+	ma_uint32 GetOutputLatency() const;
+	ma_uint32 GetTaps() const { return m_taps; }              // Per branch
+	ma_uint32 GetPhases() const { return m_phases; }
+
+	// A miniaudio resampling backend for ma_resample_algorithm_custom; pass BackendUserData()
+	// of the quality as its user data. Only f32 is accepted, which is what a data converter
+	// hands a custom backend.
+	static ma_resampling_backend_vtable *BackendVTable();
+	static void *BackendUserData(Quality quality);
+
+	static Isa GetIsa();           // Kernel set in use
+	static bool SetIsa(Isa isa);   // Force a kernel set (benchmarks); false if the CPU lacks it
+	static const char *to_string(Quality quality);
+
+private:
+	void push(const float *pFrame);
+
+	std::vector<float> m_coeffs;  // m_phases branches of m_taps, oldest input first
+	std::vector<float> m_history; // Per channel: m_taps frames stored twice, so any window is contiguous
+	ma_uint32 m_channels = 0;
+	ma_uint32 m_taps = 0;
+	ma_uint32 m_phases = 0; // L: branches, one per output phase
+	ma_uint32 m_step = 0;   // M: phase advance per output frame
+	ma_uint32 m_write = 0;  // History slot the next input frame goes to
+	ma_uint32 m_phase = 0;  // Branch of the next output frame
+	ma_uint32 m_need = 0;   // Input frames to take in before the next output frame
+};
@@ -0,0 +1,150 @@
+#include "RecordTap.hpp"
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+ma_result RecordTap::Start(const char *path, ma_format format, ma_uint32 channels, ma_uint32 sampleRate) {
+	Stop();
+	if (path == nullptr || format == ma_format_unknown || channels == 0 || sampleRate == 0) return MA_INVALID_ARGS;
+
+	const ma_uint32 bytesPerFrame = ma_get_bytes_per_frame(format, channels);
+	ma_result result = m_ring.Init(bytesPerFrame, (ma_uint32)((ma_uint64)sampleRate * BufferMs / 1000));
+	if (result != MA_SUCCESS) return result;
+
+	// One frame of slack: blocks are filled by whole frames, and what overhangs moves to the next.
+	m_block = static_cast<ma_uint8 *>(ma_aligned_malloc(BlockBytes + bytesPerFrame, WavWriter::HeaderBytes, nullptr));
+	if (m_block == nullptr) {
+		m_ring.Uninit();
+		return MA_OUT_OF_MEMORY;
+	}
+
+	result = m_writer.Open(path, format, channels, sampleRate);
+	if (result != MA_SUCCESS) {
+		m_writer.Close();
+		ma_aligned_free(m_block, nullptr);
+		m_block = nullptr;
+		m_ring.Uninit();
+		return result;
+	}
+
+	m_format = format;
+	m_channels = channels;
+	m_sampleRate = sampleRate;
+	m_staged = 0;
+	m_framesWritten.store(0, std::memory_order_relaxed);
+	m_framesDropped.store(0, std::memory_order_relaxed);
+	m_peakFill.store(0, std::memory_order_relaxed);
+	m_capacity.store(m_ring.GetCapacity(), std::memory_order_relaxed);
+	m_failed.store(false, std::memory_order_relaxed);
+
+	m_quit = false;
+	m_thread = std::thread(&RecordTap::run, this);
+	m_active.store(true, std::memory_order_release);
+	return MA_SUCCESS;
+}
+
+ma_result RecordTap::Stop() {
+	if (!m_writer.IsOpen()) return MA_SUCCESS;
+
+	// Once the flag is taken here no Push() is in progress, and every later one sees m_active clear.
+	m_active.store(false);
+	while (m_busy.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+	m_busy.store(false, std::memory_order_release);
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_quit = true;
+	}
+	m_wake.notify_one();
+	m_thread.join(); // Writes the rest
+
+	const ma_result result = m_writer.Close();
+	if (result != MA_SUCCESS) m_failed.store(true, std::memory_order_relaxed);
+	ma_aligned_free(m_block, nullptr);
+	m_block = nullptr;
+	m_ring.Uninit();
+	return result;
+}
+
+void RecordTap::Push(const void *pFrames, ma_uint32 frameCount, ma_format format, ma_uint32 channels, ma_uint32 sampleRate) {
+	if (!m_active.load(std::memory_order_relaxed)) return;
+
+	if (m_busy.exchange(true, std::memory_order_acquire)) {
+		m_framesDropped.fetch_add(frameCount, std::memory_order_relaxed);
+		return;
+	}
+	if (m_active.load(std::memory_order_acquire)) {
+		// The header is fixed: once the stream changed, nothing more belongs in this file.
+		if (format != m_format || channels != m_channels || sampleRate != m_sampleRate) {
+			m_failed.store(true, std::memory_order_relaxed);
+		}
+		const ma_uint32 written = m_failed.load(std::memory_order_relaxed) ? 0 : m_ring.Write(pFrames, frameCount);
+		if (written < frameCount) m_framesDropped.fetch_add(frameCount - written, std::memory_order_relaxed);
+	}
+	m_busy.store(false, std::memory_order_release);
+}
+
+bool RecordTap::Accepts(ma_format format, ma_uint32 channels, ma_uint32 sampleRate) const {
+	if (!m_writer.IsOpen()) return true;
+	return format == m_format && channels == m_channels && sampleRate == m_sampleRate;
+}
+
+RecordingStats RecordTap::GetStats() const {
+	const ma_uint32 capacity = m_capacity.load(std::memory_order_relaxed);
+	return RecordingStats{
+		m_active.load(std::memory_order_relaxed),
+		m_framesWritten.load(std::memory_order_relaxed),
+		m_framesDropped.load(std::memory_order_relaxed),
+		capacity != 0 ? 100.0 * m_peakFill.load(std::memory_order_relaxed) / capacity : 0.0,
+		m_failed.load(std::memory_order_relaxed),
+	};
+}
+
+void RecordTap::run() {
+	std::unique_lock lock(m_mutex);
+	while (!m_quit) {
+		m_wake.wait_for(lock, std::chrono::milliseconds(PollMs), [this] { return m_quit; });
+		lock.unlock();
+		drain(false);
+		lock.lock();
+	}
+	lock.unlock();
+
+	drain(true);
+}
+
+// Move what the ring holds into the block, writing out every block that fills; a final drain
+// also writes the part block at the end.
+void RecordTap::drain(bool final) {
+	const ma_uint32 bytesPerFrame = m_ring.GetBytesPerFrame();
+	ma_uint32 available = m_ring.AvailableRead();
+	if (available > m_peakFill.load(std::memory_order_relaxed)) m_peakFill.store(available, std::memory_order_relaxed);
+
+	const auto write = [this, bytesPerFrame](size_t bytes) {
+		if (m_writer.Write(m_block, bytes) == MA_SUCCESS) {
+			m_framesWritten.store(m_writer.GetDataBytes() / bytesPerFrame, std::memory_order_relaxed);
+			return;
+		}
+		// After a failed write (e.g. a full disk) the rest is read and counted as dropped.
+		m_failed.store(true, std::memory_order_relaxed);
+		m_framesDropped.fetch_add(bytes / bytesPerFrame, std::memory_order_relaxed);
+	};
+
+	while (available > 0) {
+		const ma_uint32 toFill = (ma_uint32)((BlockBytes - m_staged + bytesPerFrame - 1) / bytesPerFrame);
+		const ma_uint32 frames = m_ring.Read(m_block + m_staged, std::min(available, toFill));
+		m_staged += (size_t)frames * bytesPerFrame;
+		available -= frames;
+
+		if (m_staged >= BlockBytes) {
+			write(BlockBytes);
+			m_staged -= BlockBytes;
+			std::memmove(m_block, m_block + BlockBytes, m_staged);
+		}
+	}
+
+	if (final && m_staged > 0) {
+		write(m_staged);
+		m_staged = 0;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "miniaudio.h"
+#include "AudioRedirector.hpp"
+#include "SpscRing.hpp"
+#include "WavFile.hpp"
+
+// Records the frames a data callback hands it to a WAV file, with no file I/O, allocation,
+// locks or syscalls on the callback thread.
+//
+// Push() copies a block into an SpscRing sized for BufferMs of audio; frames that do not fit
+// are counted as dropped, never waited for. A writer thread wakes every PollMs, drains the ring
+// into an aligned staging block and hands whole BlockBytes blocks to a WavWriter, whose sample
+// data starts at an aligned file offset; the sizes are filled in when the recording stops.
+//
+// Only the active route of a path pushes, so the outgoing route of a crossfade is not recorded
+// (the incoming one captures the same source). Push() is still a try-lock: a callback of the
+// outgoing route that began just before the handover drops its frames instead of corrupting
+// the file. A block in another format, channel count or sample rate than
+// the recording fails it, and every later frame is dropped; callers about to change the stream
+// check Accepts() and stop the recording first.
+class RecordTap {
+public:
+	static constexpr ma_uint32 BufferMs = 2000;    // How long the writer may fall behind
+	static constexpr ma_uint32 PollMs = 20;        // Writer wake-up interval
+	static constexpr size_t BlockBytes = 1 << 16;  // Size and alignment of the file writes
+
+	RecordTap() = default;
+	~RecordTap() { Stop(); }
+	RecordTap(const RecordTap &) = delete;
+	RecordTap &operator=(const RecordTap &) = delete;
+
+	// Opens the file and starts the writer; not real-time safe. Restarts if already recording.
+	ma_result Start(const char *path, ma_format format, ma_uint32 channels, ma_uint32 sampleRate);
+	// Writes out what is buffered, completes the header and closes the file. Returns the first
+	// write error of the recording, if any.
+	ma_result Stop();
+
+	// Callback thread. A no-op while not recording.
+	void Push(const void *pFrames, ma_uint32 frameCount, ma_format format, ma_uint32 channels, ma_uint32 sampleRate);
+
+	// Whether a stream of this format can go on into the recording; always while not recording.
+	// Same thread as Start() and Stop().
+	bool Accepts(ma_format format, ma_uint32 channels, ma_uint32 sampleRate) const;
+
+	bool IsRecording() const { return m_active.load(std::memory_order_relaxed); }
+	RecordingStats GetStats() const;
+
+private:
+	void run();
+	void drain(bool final);
+
+	SpscRing m_ring;
+	WavWriter m_writer;
+	ma_format m_format = ma_format_unknown;
+	ma_uint32 m_channels = 0;
+	ma_uint32 m_sampleRate = 0;
+
+	alignas(64) std::atomic<bool> m_active = false; // Push() accepts frames
+	std::atomic<bool> m_busy = false;               // A Push() is in progress
+
+	// Writer thread
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_quit = false;
+	ma_uint8 *m_block = nullptr; // BlockBytes plus one frame, aligned
+	size_t m_staged = 0;         // Bytes in m_block
+
+	// Published through GetStats()
+	alignas(64) std::atomic<ma_uint64> m_framesWritten = 0;
+	std::atomic<ma_uint64> m_framesDropped = 0;
+	std::atomic<ma_uint32> m_peakFill = 0;
+	std::atomic<ma_uint32> m_capacity = 0; // Of the ring; kept after Stop() for the stats
+	std::atomic<bool> m_failed = false;
+};
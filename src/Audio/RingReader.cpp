@@ -0,0 +1,85 @@
+#include "RingReader.hpp"
+#include "SampleConvert.hpp"
+#include <cstdint>
+#include <algorithm>
+
+void RingReader::Reset(
+	ma_uint32 channels, ma_uint32 sourceRate, ma_uint32 outputRate, ma_uint32 latencyMs, ma_uint32 maxFrames,
+	ResamplerQuality quality
+) {
+	m_channels = channels;
+	m_baseStep = static_cast<double>(sourceRate) / outputRate;
+	m_cursor = 0;
+
+	m_jitterBuffer.Reset(sourceRate, latencyMs);
+	m_driftEstimator.Reset(sourceRate);
+
+	// Source frames for maxFrames of output: never more than two past the exact ratio.
+	ma_uint32 trimmedFrames = maxFrames;
+	m_converts = sourceRate != outputRate;
+	if (m_converts) {
+		const PolyphaseResampler::Quality tier =
+			quality == ResamplerQuality::High ? PolyphaseResampler::Quality::High :
+			quality == ResamplerQuality::Medium ? PolyphaseResampler::Quality::Medium : PolyphaseResampler::Quality::Low;
+		m_converter.Init(channels, sourceRate, outputRate, tier);
+		trimmedFrames = static_cast<ma_uint32>(static_cast<ma_uint64>(maxFrames) * sourceRate / outputRate) + 2;
+	}
+	m_trimmed.assign(m_converts ? static_cast<size_t>(trimmedFrames) * channels : 0, 0.0f);
+	m_resampler.Reset(channels, trimmedFrames);
+	m_resampler.SetStep(1.0);
+}
+
+ma_uint32 RingReader::Render(const BroadcastRing &ring, ma_format format, float *pOutput, ma_uint32 frameCount) {
+	const ma_uint64 written = ring.GetWriteCursor();
+
+	// Lapped by the writer (reader stalled): resume from the newest frames instead. The frames
+	// skipped count as dropped, so the jitter buffer widens its target as after an underrun.
+	if (written - m_cursor > ring.GetCapacity()) {
+		const ma_uint64 resume = written - std::min<ma_uint64>(m_jitterBuffer.GetTargetFrames(), written);
+		m_jitterBuffer.AddDroppedFrames(static_cast<ma_uint32>(std::min<ma_uint64>(resume - m_cursor, UINT32_MAX)));
+		m_cursor = resume;
+	}
+	const ma_uint32 framesAvailable = static_cast<ma_uint32>(written - m_cursor);
+
+	if (!m_jitterBuffer.IsPrerolling()) {
+		m_resampler.SetStep(m_driftEstimator.Update(
+			framesAvailable, m_jitterBuffer.GetTargetFrames(), static_cast<ma_uint32>(frameCount * m_baseStep)
+		));
+	}
+
+	// Source frames the converter needs for this block; the drift trim produces them.
+	const ma_uint32 trimmedFrames = m_converts ? static_cast<ma_uint32>(m_converter.RequiredInputFrames(frameCount)) : frameCount;
+	const JitterBuffer::Decision decision = m_jitterBuffer.Process(framesAvailable, m_resampler.InputFramesFor(trimmedFrames));
+	m_cursor += decision.framesToSkip;
+
+	// Convert straight out of the shared ring into the resampler; the writer never copies per reader.
+	float *pInput = m_resampler.InputBuffer();
+	ma_uint64 cursor = m_cursor;
+	ma_uint32 framesRead = 0;
+
+	while (framesRead < decision.framesToRead) {
+		const void *pFrames = nullptr;
+		const ma_uint32 frames = ring.Peek(cursor, decision.framesToRead - framesRead, &pFrames);
+		if (frames == 0) break;
+
+		SampleConvert::Convert(
+			pInput + static_cast<size_t>(framesRead) * m_channels, ma_format_f32,
+			pFrames, format, static_cast<size_t>(frames) * m_channels
+		);
+		cursor += frames;
+		framesRead += frames;
+	}
+
+	// Drop the block if the writer overwrote it while it was being read.
+	if (ring.IsIntact(m_cursor)) {
+		m_resampler.CommitInput(framesRead);
+	}
+	m_cursor = cursor;
+
+	if (!m_converts) return m_resampler.Process(pOutput, frameCount);
+
+	ma_uint64 framesIn = m_resampler.Process(m_trimmed.data(), trimmedFrames);
+	ma_uint64 framesOut = frameCount;
+	m_converter.Process(m_trimmed.data(), &framesIn, pOutput, &framesOut);
+	return static_cast<ma_uint32>(framesOut);
+}
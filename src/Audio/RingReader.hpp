@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "miniaudio.h"
+#include "AudioRedirector.hpp"
+#include "BroadcastRing.hpp"
+#include "JitterBuffer.hpp"
+#include "DriftEstimator.hpp"
+#include "FractionalResampler.hpp"
+#include "PolyphaseResampler.hpp"
+
+// One reader of a BroadcastRing: its own cursor, jitter buffer and drift/rate resampler.
+// Render() pulls ring frames (in the ring's PCM format) and produces f32 frames on the
+// reader's clock and sample rate. Only the reader's audio thread may call Render().
+//
+// The cubic resampler only trims the drift, a step within a fraction of a percent of 1.0,
+// where it does not alias. A fixed rate ratio between the source and the output is left to
+// a band-limited PolyphaseResampler after it.
+class RingReader {
+public:
+	// Not real-time safe. Where the rates differ, quality picks the converter's sinc tier;
+	// Linear, which has no band-limited counterpart here, gets the lowest one.
+	void Reset(
+		ma_uint32 channels, ma_uint32 sourceRate, ma_uint32 outputRate, ma_uint32 latencyMs, ma_uint32 maxFrames,
+		ResamplerQuality quality = ResamplerQuality::Medium
+	);
+
+	// Render up to frameCount frames; returns the number rendered (the rest is an underrun).
+	ma_uint32 Render(const BroadcastRing &ring, ma_format format, float *pOutput, ma_uint32 frameCount);
+
+	double GetDriftPpm() const { return m_driftEstimator.GetDriftPpm(); }
+	const JitterBuffer &GetJitterBuffer() const { return m_jitterBuffer; }
+
+private:
+	ma_uint32 m_channels = 2;
+	double m_baseStep = 1.0; // source frames per output frame
+	ma_uint64 m_cursor = 0;  // absolute read position in the ring
+
+	JitterBuffer m_jitterBuffer;
+	DriftEstimator m_driftEstimator;
+	FractionalResampler m_resampler; // Drift trim, at the source rate
+	PolyphaseResampler m_converter;  // Source to output rate, when they differ
+	bool m_converts = false;
+	std::vector<float> m_trimmed;    // Drift-trimmed source frames on their way to m_converter
+};
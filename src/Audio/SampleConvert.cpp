@@ -0,0 +1,730 @@
+#include "SampleConvert.hpp"
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define SAMPLE_CONVERT_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define SAMPLE_CONVERT_AVX2_TARGET
+	#else
+		#include <cpuid.h>
+		#define SAMPLE_CONVERT_AVX2_TARGET __attribute__((target("avx2")))
+	#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define SAMPLE_CONVERT_NEON
+	#include <arm_neon.h>
+#endif
+
+using Kernel = void (*)(void *pOut, const void *pIn, size_t count);
+
+// Scale factors; the same constants are used by every kernel set.
+static constexpr float kFromU8 = 1.0f / 128.0f;
+static constexpr float kFromS16 = 1.0f / 32768.0f;
+static constexpr float kFromS24 = 1.0f / 8388608.0f;
+static constexpr float kFromS32 = 1.0f / 2147483648.0f;
+static constexpr float kToU8 = 127.0f;
+static constexpr float kToS16 = 32767.0f;
+static constexpr float kToS24 = 8388607.0f;
+static constexpr float kToS32 = 2147483647.0f;  // rounds to 2^31 in f32, hence kMaxS32 below
+static constexpr float kMaxS32 = 0.99999994f;   // largest f32 below 1.0, keeps x * 2^31 in range
+
+// ============================================================================
+// Scalar kernels (also the tails of the vector kernels)
+// ============================================================================
+
+namespace scalar {
+	inline float clip(float x, float hi = 1.0f) {
+		return std::min(std::max(x, -1.0f), hi);
+	}
+
+	inline ma_int32 load_s24(const ma_uint8 *p) {
+		return static_cast<ma_int32>(
+			(static_cast<ma_uint32>(p[0]) << 8) | (static_cast<ma_uint32>(p[1]) << 16) | (static_cast<ma_uint32>(p[2]) << 24)
+		); // left-justified s32
+	}
+
+	inline void store_s24(ma_uint8 *p, ma_int32 v) { // v is right-justified
+		p[0] = static_cast<ma_uint8>(v);
+		p[1] = static_cast<ma_uint8>(v >> 8);
+		p[2] = static_cast<ma_uint8>(v >> 16);
+	}
+
+	// --- to f32 ---
+
+	void u8_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<float>(static_cast<ma_int32>(in[i]) - 128) * kFromU8;
+	}
+
+	void s16_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int16 *in = static_cast<const ma_int16 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<float>(in[i]) * kFromS16;
+	}
+
+	void s24_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<float>(load_s24(in + i * 3) >> 8) * kFromS24;
+	}
+
+	void s32_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<float>(in[i]) * kFromS32;
+	}
+
+	// --- from f32 ---
+
+	void f32_to_u8(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_uint8>(static_cast<ma_int32>(clip(in[i]) * kToU8 + 128.0f));
+	}
+
+	void f32_to_s16(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int16 *out = static_cast<ma_int16 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_int16>(static_cast<ma_int32>(clip(in[i]) * kToS16));
+	}
+
+	void f32_to_s24(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		for (size_t i = 0; i < count; ++i) store_s24(out + i * 3, static_cast<ma_int32>(clip(in[i]) * kToS24));
+	}
+
+	void f32_to_s32(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_int32>(clip(in[i], kMaxS32) * kToS32);
+	}
+
+	// --- integer <-> left-justified s32 ---
+
+	void u8_to_s32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_int32>(static_cast<ma_uint32>(in[i] ^ 0x80) << 24);
+	}
+
+	void s16_to_s32(void *pOut, const void *pIn, size_t count) {
+		const ma_int16 *in = static_cast<const ma_int16 *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_int32>(static_cast<ma_uint32>(static_cast<ma_uint16>(in[i])) << 16);
+	}
+
+	void s24_to_s32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = load_s24(in + i * 3);
+	}
+
+	void s32_to_u8(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_uint8>((in[i] >> 24) + 128);
+	}
+
+	void s32_to_s16(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		ma_int16 *out = static_cast<ma_int16 *>(pOut);
+		for (size_t i = 0; i < count; ++i) out[i] = static_cast<ma_int16>(in[i] >> 16);
+	}
+
+	void s32_to_s24(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		for (size_t i = 0; i < count; ++i) store_s24(out + i * 3, in[i] >> 8);
+	}
+} // namespace scalar
+
+// ============================================================================
+// SSE2 kernels
+// ============================================================================
+
+#if defined(SAMPLE_CONVERT_X86)
+namespace sse2 {
+	void u8_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(128);
+		const __m128 scale = _mm_set1_ps(kFromU8);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			const __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), bias);
+			const __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), bias);
+			_mm_storeu_ps(out + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)), scale));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)), scale));
+			_mm_storeu_ps(out + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)), scale));
+			_mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)), scale));
+		}
+		scalar::u8_to_f32(out + i, in + i, count - i);
+	}
+
+	void s16_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int16 *in = static_cast<const ma_int16 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m128 scale = _mm_set1_ps(kFromS16);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			_mm_storeu_ps(out + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale));
+		}
+		scalar::s16_to_f32(out + i, in + i, count - i);
+	}
+
+	void s32_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m128 scale = _mm_set1_ps(kFromS32);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+		}
+		scalar::s32_to_f32(out + i, in + i, count - i);
+	}
+
+	void f32_to_u8(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(kToU8), bias = _mm_set1_ps(128.0f);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i q[4];
+			for (int k = 0; k < 4; ++k) {
+				const __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + k * 4), lo), hi);
+				q[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, scale), bias));
+			}
+			const __m128i w0 = _mm_packs_epi32(q[0], q[1]);
+			const __m128i w1 = _mm_packs_epi32(q[2], q[3]);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(w0, w1));
+		}
+		scalar::f32_to_u8(out + i, in + i, count - i);
+	}
+
+	void f32_to_s16(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int16 *out = static_cast<ma_int16 *>(pOut);
+		const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(kToS16);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 0), lo), hi);
+			const __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi);
+			const __m128i packed = _mm_packs_epi32(
+				_mm_cvttps_epi32(_mm_mul_ps(a, scale)), _mm_cvttps_epi32(_mm_mul_ps(b, scale))
+			);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+		}
+		scalar::f32_to_s16(out + i, in + i, count - i);
+	}
+
+	void f32_to_s32(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(kMaxS32);
+		const __m128 scale = _mm_set1_ps(kToS32);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_cvttps_epi32(_mm_mul_ps(x, scale)));
+		}
+		scalar::f32_to_s32(out + i, in + i, count - i);
+	}
+
+	void u8_to_s32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			// (x ^ 0x80) << 24: interleave the byte into the top of each 32-bit lane.
+			const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), flip);
+			const __m128i lo = _mm_unpacklo_epi8(zero, v); // x << 8 per 16-bit lane
+			const __m128i hi = _mm_unpackhi_epi8(zero, v);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 0), _mm_unpacklo_epi16(zero, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_unpackhi_epi16(zero, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8), _mm_unpacklo_epi16(zero, hi));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 12), _mm_unpackhi_epi16(zero, hi));
+		}
+		scalar::u8_to_s32(out + i, in + i, count - i);
+	}
+
+	void s16_to_s32(void *pOut, const void *pIn, size_t count) {
+		const ma_int16 *in = static_cast<const ma_int16 *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 0), _mm_unpacklo_epi16(zero, v));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_unpackhi_epi16(zero, v));
+		}
+		scalar::s16_to_s32(out + i, in + i, count - i);
+	}
+
+	void s32_to_u8(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const __m128i bias = _mm_set1_epi32(128);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i q[4];
+			for (int k = 0; k < 4; ++k) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + k * 4));
+				q[k] = _mm_add_epi32(_mm_srai_epi32(v, 24), bias);
+			}
+			const __m128i w0 = _mm_packs_epi32(q[0], q[1]);
+			const __m128i w1 = _mm_packs_epi32(q[2], q[3]);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(w0, w1));
+		}
+		scalar::s32_to_u8(out + i, in + i, count - i);
+	}
+
+	void s32_to_s16(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		ma_int16 *out = static_cast<ma_int16 *>(pOut);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128i a = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 0)), 16);
+			const __m128i b = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 4)), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(a, b));
+		}
+		scalar::s32_to_s16(out + i, in + i, count - i);
+	}
+} // namespace sse2
+
+// ============================================================================
+// AVX2 kernels (f32 and s24 paths; other integer paths reuse SSE2)
+// ============================================================================
+
+namespace avx2 {
+	SAMPLE_CONVERT_AVX2_TARGET void u8_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m256i bias = _mm256_set1_epi32(128);
+		const __m256 scale = _mm256_set1_ps(kFromU8);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			const __m256i a = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v), bias);
+			const __m256i b = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)), bias);
+			_mm256_storeu_ps(out + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(a), scale));
+			_mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), scale));
+		}
+		sse2::u8_to_f32(out + i, in + i, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void s16_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int16 *in = static_cast<const ma_int16 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m256 scale = _mm256_set1_ps(kFromS16);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 0)));
+			const __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8)));
+			_mm256_storeu_ps(out + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(a), scale));
+			_mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), scale));
+		}
+		sse2::s16_to_f32(out + i, in + i, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void s32_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m256 scale = _mm256_set1_ps(kFromS32);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+			_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+		}
+		sse2::s32_to_f32(out + i, in + i, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void f32_to_u8(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+		const __m256 scale = _mm256_set1_ps(kToU8), bias = _mm256_set1_ps(128.0f);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 0), lo), hi);
+			const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 8), lo), hi);
+			const __m256i qa = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(a, scale), bias));
+			const __m256i qb = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(b, scale), bias));
+			// packs works per 128-bit lane; restore sample order before narrowing to bytes.
+			const __m256i w = _mm256_permute4x64_epi64(_mm256_packs_epi32(qa, qb), 0xD8);
+			const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), bytes);
+		}
+		sse2::f32_to_u8(out + i, in + i, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void f32_to_s16(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int16 *out = static_cast<ma_int16 *>(pOut);
+		const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+		const __m256 scale = _mm256_set1_ps(kToS16);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 0), lo), hi);
+			const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 8), lo), hi);
+			const __m256i packed = _mm256_packs_epi32(
+				_mm256_cvttps_epi32(_mm256_mul_ps(a, scale)), _mm256_cvttps_epi32(_mm256_mul_ps(b, scale))
+			);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+		}
+		sse2::f32_to_s16(out + i, in + i, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void f32_to_s32(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(kMaxS32);
+		const __m256 scale = _mm256_set1_ps(kToS32);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i), lo), hi);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_cvttps_epi32(_mm256_mul_ps(x, scale)));
+		}
+		sse2::f32_to_s32(out + i, in + i, count - i);
+	}
+
+	// s24 is packed 3-byte samples; byte shuffles (SSSE3, implied by AVX2) move four at a time.
+	// Loads read 16 bytes for 12, so the loops stop two samples early to stay in bounds.
+
+	SAMPLE_CONVERT_AVX2_TARGET void s24_to_s32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		const __m128i spread = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+		size_t i = 0;
+		for (; i + 6 <= count; i += 4) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i * 3));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(v, spread));
+		}
+		scalar::s24_to_s32(out + i, in + i * 3, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void s24_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const __m128i spread = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+		const __m128 scale = _mm_set1_ps(kFromS24);
+
+		size_t i = 0;
+		for (; i + 6 <= count; i += 4) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i * 3));
+			const __m128i s = _mm_srai_epi32(_mm_shuffle_epi8(v, spread), 8);
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+		}
+		scalar::s24_to_f32(out + i, in + i * 3, count - i);
+	}
+
+	// Store the low 12 bytes of a packed vector.
+	SAMPLE_CONVERT_AVX2_TARGET inline void store_12(ma_uint8 *p, __m128i v) {
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(p), v);
+		const ma_int32 tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+		std::memcpy(p + 8, &tail, sizeof(tail));
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void s32_to_s24(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const __m128i pack = _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			store_12(out + i * 3, _mm_shuffle_epi8(v, pack));
+		}
+		scalar::s32_to_s24(out + i * 3, in + i, count - i);
+	}
+
+	SAMPLE_CONVERT_AVX2_TARGET void f32_to_s24(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+		const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(kToS24);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi);
+			store_12(out + i * 3, _mm_shuffle_epi8(_mm_cvttps_epi32(_mm_mul_ps(x, scale)), pack));
+		}
+		scalar::f32_to_s24(out + i * 3, in + i, count - i);
+	}
+} // namespace avx2
+#endif // SAMPLE_CONVERT_X86
+
+// ============================================================================
+// NEON kernels
+// ============================================================================
+
+#if defined(SAMPLE_CONVERT_NEON)
+namespace neon {
+	void u8_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+		const int16x8_t bias = vdupq_n_s16(128);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(in + i))), bias);
+			vst1q_f32(out + i + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), kFromU8));
+			vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), kFromU8));
+		}
+		scalar::u8_to_f32(out + i, in + i, count - i);
+	}
+
+	void s16_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int16 *in = static_cast<const ma_int16 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const int16x8_t v = vld1q_s16(in + i);
+			vst1q_f32(out + i + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), kFromS16));
+			vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), kFromS16));
+		}
+		scalar::s16_to_f32(out + i, in + i, count - i);
+	}
+
+	void s32_to_f32(void *pOut, const void *pIn, size_t count) {
+		const ma_int32 *in = static_cast<const ma_int32 *>(pIn);
+		float *out = static_cast<float *>(pOut);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i)), kFromS32));
+		}
+		scalar::s32_to_f32(out + i, in + i, count - i);
+	}
+
+	void f32_to_u8(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f), bias = vdupq_n_f32(128.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 0), lo), hi);
+			const float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 4), lo), hi);
+			const int32x4_t qa = vcvtq_s32_f32(vaddq_f32(vmulq_n_f32(a, kToU8), bias));
+			const int32x4_t qb = vcvtq_s32_f32(vaddq_f32(vmulq_n_f32(b, kToU8), bias));
+			vst1_u8(out + i, vqmovun_s16(vcombine_s16(vqmovn_s32(qa), vqmovn_s32(qb))));
+		}
+		scalar::f32_to_u8(out + i, in + i, count - i);
+	}
+
+	void f32_to_s16(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int16 *out = static_cast<ma_int16 *>(pOut);
+		const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 0), lo), hi);
+			const float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 4), lo), hi);
+			const int16x4_t qa = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(a, kToS16)));
+			const int16x4_t qb = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(b, kToS16)));
+			vst1q_s16(out + i, vcombine_s16(qa, qb));
+		}
+		scalar::f32_to_s16(out + i, in + i, count - i);
+	}
+
+	void f32_to_s32(void *pOut, const void *pIn, size_t count) {
+		const float *in = static_cast<const float *>(pIn);
+		ma_int32 *out = static_cast<ma_int32 *>(pOut);
+		const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(kMaxS32);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(in + i), lo), hi);
+			vst1q_s32(out + i, vcvtq_s32_f32(vmulq_n_f32(x, kToS32)));
+		}
+		scalar::f32_to_s32(out + i, in + i, count - i);
+	}
+} // namespace neon
+#endif // SAMPLE_CONVERT_NEON
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+// Tables are indexed by ma_format (u8 = 1 ... f32 = 5); index 0 (unknown) is unused.
+struct KernelSet {
+	SampleConvert::Isa isa;
+	Kernel toF32[6];
+	Kernel fromF32[6];
+	Kernel toS32[6];
+	Kernel fromS32[6];
+};
+
+static constexpr KernelSet kScalarKernels = {
+	SampleConvert::Isa::Scalar,
+	{nullptr, scalar::u8_to_f32, scalar::s16_to_f32, scalar::s24_to_f32, scalar::s32_to_f32, nullptr},
+	{nullptr, scalar::f32_to_u8, scalar::f32_to_s16, scalar::f32_to_s24, scalar::f32_to_s32, nullptr},
+	{nullptr, scalar::u8_to_s32, scalar::s16_to_s32, scalar::s24_to_s32, nullptr, nullptr},
+	{nullptr, scalar::s32_to_u8, scalar::s32_to_s16, scalar::s32_to_s24, nullptr, nullptr},
+};
+
+#if defined(SAMPLE_CONVERT_X86)
+// s24 is a packed 3-byte layout without an SSE2 shuffle; it stays scalar below AVX2.
+static constexpr KernelSet kSse2Kernels = {
+	SampleConvert::Isa::SSE2,
+	{nullptr, sse2::u8_to_f32, sse2::s16_to_f32, scalar::s24_to_f32, sse2::s32_to_f32, nullptr},
+	{nullptr, sse2::f32_to_u8, sse2::f32_to_s16, scalar::f32_to_s24, sse2::f32_to_s32, nullptr},
+	{nullptr, sse2::u8_to_s32, sse2::s16_to_s32, scalar::s24_to_s32, nullptr, nullptr},
+	{nullptr, sse2::s32_to_u8, sse2::s32_to_s16, scalar::s32_to_s24, nullptr, nullptr},
+};
+
+static constexpr KernelSet kAvx2Kernels = {
+	SampleConvert::Isa::AVX2,
+	{nullptr, avx2::u8_to_f32, avx2::s16_to_f32, avx2::s24_to_f32, avx2::s32_to_f32, nullptr},
+	{nullptr, avx2::f32_to_u8, avx2::f32_to_s16, avx2::f32_to_s24, avx2::f32_to_s32, nullptr},
+	{nullptr, sse2::u8_to_s32, sse2::s16_to_s32, avx2::s24_to_s32, nullptr, nullptr},
+	{nullptr, sse2::s32_to_u8, sse2::s32_to_s16, avx2::s32_to_s24, nullptr, nullptr},
+};
+
+static bool cpu_has_avx2() {
+	#if defined(_MSC_VER)
+	int info[4] = {};
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false; // OS must save YMM state
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+	#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+	#endif
+}
+#endif // SAMPLE_CONVERT_X86
+
+#if defined(SAMPLE_CONVERT_NEON)
+static constexpr KernelSet kNeonKernels = {
+	SampleConvert::Isa::NEON,
+	{nullptr, neon::u8_to_f32, neon::s16_to_f32, scalar::s24_to_f32, neon::s32_to_f32, nullptr},
+	{nullptr, neon::f32_to_u8, neon::f32_to_s16, scalar::f32_to_s24, neon::f32_to_s32, nullptr},
+	{nullptr, scalar::u8_to_s32, scalar::s16_to_s32, scalar::s24_to_s32, nullptr, nullptr},
+	{nullptr, scalar::s32_to_u8, scalar::s32_to_s16, scalar::s32_to_s24, nullptr, nullptr},
+};
+#endif
+
+static const KernelSet *best_kernels() {
+#if defined(SAMPLE_CONVERT_X86)
+	return cpu_has_avx2() ? &kAvx2Kernels : &kSse2Kernels;
+#elif defined(SAMPLE_CONVERT_NEON)
+	return &kNeonKernels;
+#else
+	return &kScalarKernels;
+#endif
+}
+
+// Resolved during static initialization, before any device can call in.
+static std::atomic<const KernelSet *> g_kernels = best_kernels();
+
+void SampleConvert::Convert(void *pOut, ma_format formatOut, const void *pIn, ma_format formatIn, size_t sampleCount) {
+	const KernelSet &k = *g_kernels.load(std::memory_order_relaxed);
+
+	if (formatIn == formatOut) {
+		std::memcpy(pOut, pIn, sampleCount * ma_get_bytes_per_sample(formatIn));
+	} else if (formatIn == ma_format_f32) {
+		k.fromF32[formatOut](pOut, pIn, sampleCount);
+	} else if (formatOut == ma_format_f32) {
+		k.toF32[formatIn](pOut, pIn, sampleCount);
+	} else if (formatIn == ma_format_s32) {
+		k.fromS32[formatOut](pOut, pIn, sampleCount);
+	} else if (formatOut == ma_format_s32) {
+		k.toS32[formatIn](pOut, pIn, sampleCount);
+	} else {
+		// Integer to integer: widen to s32 in cache-sized blocks, then narrow.
+		constexpr size_t blockSamples = 1024;
+		ma_int32 block[blockSamples];
+
+		const ma_uint8 *in = static_cast<const ma_uint8 *>(pIn);
+		ma_uint8 *out = static_cast<ma_uint8 *>(pOut);
+		const ma_uint32 bytesIn = ma_get_bytes_per_sample(formatIn);
+		const ma_uint32 bytesOut = ma_get_bytes_per_sample(formatOut);
+
+		for (size_t done = 0; done < sampleCount;) {
+			const size_t n = std::min(blockSamples, sampleCount - done);
+			k.toS32[formatIn](block, in + done * bytesIn, n);
+			k.fromS32[formatOut](out + done * bytesOut, block, n);
+			done += n;
+		}
+	}
+}
+
+SampleConvert::Isa SampleConvert::GetIsa() {
+	return g_kernels.load(std::memory_order_relaxed)->isa;
+}
+
+bool SampleConvert::SetIsa(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			g_kernels.store(&kScalarKernels);
+			return true;
+#if defined(SAMPLE_CONVERT_X86)
+		case Isa::SSE2:
+			g_kernels.store(&kSse2Kernels);
+			return true;
+		case Isa::AVX2:
+			if (!cpu_has_avx2()) return false;
+			g_kernels.store(&kAvx2Kernels);
+			return true;
+#endif
+#if defined(SAMPLE_CONVERT_NEON)
+		case Isa::NEON:
+			g_kernels.store(&kNeonKernels);
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+const char *SampleConvert::to_string(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			return "Scalar";
+		case Isa::SSE2:
+			return "SSE2";
+		case Isa::AVX2:
+			return "AVX2";
+		case Isa::NEON:
+			return "NEON";
+		default:
+			return "Unknown";
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include "miniaudio.h"
+
+// PCM sample format conversion between u8/s16/s24/s32/f32.
+//
+// Kernels are vectorized per instruction set and picked once at runtime: AVX2 or SSE2 on x86,
+// NEON on ARM, scalar elsewhere. Integer to integer conversions go through a left-justified
+// s32 intermediate, so they are lossless where the target is wide enough. No dithering is
+// applied; f32 input is clipped to [-1, 1] and truncated toward zero, identically in every
+// kernel set, so output does not depend on the CPU it ran on.
+namespace SampleConvert {
+	enum class Isa
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	// Convert sampleCount samples (frames * channels); same format in and out is a memcpy.
+	void Convert(void *pOut, ma_format formatOut, const void *pIn, ma_format formatIn, size_t sampleCount);
+
+	Isa GetIsa();                  // Kernel set in use
+	bool SetIsa(Isa isa);          // Force a kernel set (benchmarks); false if the CPU lacks it
+	const char *to_string(Isa isa);
+} // namespace SampleConvert
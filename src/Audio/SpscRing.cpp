@@ -0,0 +1,116 @@
+#include "SpscRing.hpp"
+#include <cstring>
+#include <algorithm>
+
+ma_result SpscRing::Init(ma_uint32 bytesPerFrame, ma_uint32 minCapacityFrames) {
+	if (bytesPerFrame == 0 || minCapacityFrames == 0 || minCapacityFrames > (1u << 30)) {
+		return MA_INVALID_ARGS;
+	}
+
+	ma_uint32 capacity = 1;
+	while (capacity < minCapacityFrames) capacity <<= 1;
+
+	m_data = static_cast<ma_uint8 *>(ma_aligned_malloc(static_cast<size_t>(capacity) * bytesPerFrame, 64, nullptr));
+	if (m_data == nullptr) return MA_OUT_OF_MEMORY;
+
+	m_bytesPerFrame = bytesPerFrame;
+	m_capacity = capacity;
+	m_mask = capacity - 1;
+	Reset();
+	return MA_SUCCESS;
+}
+
+void SpscRing::Uninit() {
+	ma_aligned_free(m_data, nullptr);
+	m_data = nullptr;
+	m_capacity = 0;
+}
+
+void SpscRing::Reset() {
+	m_writePos.store(0, std::memory_order_relaxed);
+	m_readPos.store(0, std::memory_order_relaxed);
+	m_cachedReadPos = 0;
+	m_cachedWritePos = 0;
+}
+
+SpscRing::Segments SpscRing::segments(ma_uint32 position, ma_uint32 frameCount) const {
+	const ma_uint32 offset = position & m_mask;
+	const ma_uint32 first = std::min(frameCount, m_capacity - offset);
+
+	return Segments{
+		{m_data + static_cast<size_t>(offset) * m_bytesPerFrame, m_data},
+		{first, frameCount - first},
+	};
+}
+
+// ----------------------------------------------------------------------------
+// Producer
+// ----------------------------------------------------------------------------
+
+ma_uint32 SpscRing::AvailableWrite() {
+	m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+	return m_capacity - (m_writePos.load(std::memory_order_relaxed) - m_cachedReadPos);
+}
+
+SpscRing::Segments SpscRing::AcquireWrite(ma_uint32 frameCount) {
+	const ma_uint32 writePos = m_writePos.load(std::memory_order_relaxed);
+
+	// Only touch the consumer's cache line when the cached index says there is not enough room.
+	if (m_capacity - (writePos - m_cachedReadPos) < frameCount) {
+		m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+	}
+	return segments(writePos, std::min(frameCount, m_capacity - (writePos - m_cachedReadPos)));
+}
+
+void SpscRing::CommitWrite(ma_uint32 frameCount) {
+	m_writePos.store(m_writePos.load(std::memory_order_relaxed) + frameCount, std::memory_order_release);
+}
+
+ma_uint32 SpscRing::Write(const void *pFrames, ma_uint32 frameCount) {
+	const Segments s = AcquireWrite(frameCount);
+	const size_t firstBytes = static_cast<size_t>(s.frames[0]) * m_bytesPerFrame;
+
+	std::memcpy(s.pData[0], pFrames, firstBytes);
+	std::memcpy(s.pData[1], static_cast<const ma_uint8 *>(pFrames) + firstBytes, static_cast<size_t>(s.frames[1]) * m_bytesPerFrame);
+
+	CommitWrite(s.Total());
+	return s.Total();
+}
+
+// ----------------------------------------------------------------------------
+// Consumer
+// ----------------------------------------------------------------------------
+
+ma_uint32 SpscRing::AvailableRead() {
+	m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+	return m_cachedWritePos - m_readPos.load(std::memory_order_relaxed);
+}
+
+SpscRing::Segments SpscRing::AcquireRead(ma_uint32 frameCount) {
+	const ma_uint32 readPos = m_readPos.load(std::memory_order_relaxed);
+
+	// Only touch the producer's cache line when the cached index says there is not enough data.
+	if (m_cachedWritePos - readPos < frameCount) {
+		m_cachedWritePos = m_writePos.load(std::memory_order_acquire);
+	}
+	return segments(readPos, std::min(frameCount, m_cachedWritePos - readPos));
+}
+
+void SpscRing::CommitRead(ma_uint32 frameCount) {
+	m_readPos.store(m_readPos.load(std::memory_order_relaxed) + frameCount, std::memory_order_release);
+}
+
+ma_uint32 SpscRing::Read(void *pFrames, ma_uint32 frameCount) {
+	const Segments s = AcquireRead(frameCount);
+	const size_t firstBytes = static_cast<size_t>(s.frames[0]) * m_bytesPerFrame;
+
+	std::memcpy(pFrames, s.pData[0], firstBytes);
+	std::memcpy(static_cast<ma_uint8 *>(pFrames) + firstBytes, s.pData[1], static_cast<size_t>(s.frames[1]) * m_bytesPerFrame);
+
+	CommitRead(s.Total());
+	return s.Total();
+}
+
+void SpscRing::Skip(ma_uint32 frameCount) {
+	CommitRead(AcquireRead(frameCount).Total());
+}
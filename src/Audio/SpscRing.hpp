@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include "miniaudio.h"
+
+// Lock-free single-producer/single-consumer ring of PCM frames.
+//
+// Capacity is a power of two, so positions are free-running 32-bit frame counters masked
+// into the buffer. The producer and consumer indices live on separate cache lines, and each
+// side keeps a private copy of the other side's index so Acquire only touches the other
+// side's line when the cached copy says there is not enough room/data. Acquire calls always
+// cover the whole request (up to what is available) as at most two segments, split at the
+// wrap point.
+class SpscRing {
+public:
+	struct Segments {
+		void *pData[2];
+		ma_uint32 frames[2];
+
+		ma_uint32 Total() const { return frames[0] + frames[1]; }
+	};
+
+	ma_result Init(ma_uint32 bytesPerFrame, ma_uint32 minCapacityFrames); // capacity is rounded up to a power of two
+	void Uninit();
+	void Reset(); // Empty the ring; neither side may be running
+
+	// --- Producer ---
+	ma_uint32 AvailableWrite(); // always exact
+	Segments AcquireWrite(ma_uint32 frameCount);
+	void CommitWrite(ma_uint32 frameCount);
+	ma_uint32 Write(const void *pFrames, ma_uint32 frameCount); // returns frames written
+
+	// --- Consumer ---
+	ma_uint32 AvailableRead(); // always exact (the fill level)
+	Segments AcquireRead(ma_uint32 frameCount);
+	void CommitRead(ma_uint32 frameCount);
+	ma_uint32 Read(void *pFrames, ma_uint32 frameCount); // returns frames read
+	void Skip(ma_uint32 frameCount);                     // discard up to frameCount frames
+
+	ma_uint32 GetCapacity() const { return m_capacity; }
+	ma_uint32 GetBytesPerFrame() const { return m_bytesPerFrame; }
+	bool IsInitialized() const { return m_data != nullptr; }
+
+private:
+	Segments segments(ma_uint32 position, ma_uint32 frameCount) const;
+
+	ma_uint8 *m_data = nullptr;
+	ma_uint32 m_bytesPerFrame = 0;
+	ma_uint32 m_capacity = 0;
+	ma_uint32 m_mask = 0;
+
+	alignas(64) std::atomic<ma_uint32> m_writePos = 0; // owned by the producer
+	ma_uint32 m_cachedReadPos = 0;                     // producer's view of m_readPos
+
+	alignas(64) std::atomic<ma_uint32> m_readPos = 0;  // owned by the consumer
+	ma_uint32 m_cachedWritePos = 0;                    // consumer's view of m_writePos
+};
@@ -0,0 +1,691 @@
+#include "VirtualBackend.hpp"
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	struct Client;
+
+	struct EndpointState {
+		VirtualBackend::Endpoint config;
+		bool connected = true;
+		bool stalled = false;      // Fires no periods, like a hung driver; its devices stay started
+		double nextPeriod = 0.0;   // Virtual time of the next period boundary
+		double fireTime = 0.0;     // nextPeriod plus jitter
+		double phase = 0.0;        // Capture tone phase, radians
+		std::vector<float> mix;    // Sum of the playback clients, or the capture signal
+		std::vector<float> scratch;
+
+		double periodSeconds() const {
+			return config.periodFrames / (config.sampleRate * (1.0 + config.skewPpm * 1e-6));
+		}
+	};
+
+	struct Client {
+		ma_device *pDevice = nullptr;
+		EndpointState *pPlayback = nullptr; // Rendered into (playback, duplex)
+		EndpointState *pCapture = nullptr;  // Captured from (capture, duplex) or the mix of (loopback)
+		bool loopback = false;
+		bool running = false;
+		bool invalidated = false;           // Its endpoint was disconnected
+	};
+
+	class Engine {
+	public:
+		explicit Engine(const VirtualBackend::Script &script);
+		~Engine();
+
+		ma_result Enumerate(ma_context *pContext, ma_enum_devices_callback_proc callback, void *pUserData);
+		ma_result GetInfo(ma_device_type type, const ma_device_id *pId, ma_device_info *pInfo);
+
+		ma_result Init(ma_device *pDevice, ma_device_type type, ma_device_descriptor *pPlayback, ma_device_descriptor *pCapture);
+		ma_result Uninit(ma_device *pDevice);
+		ma_result Start(ma_device *pDevice);
+		ma_result Stop(ma_device *pDevice);
+
+		double Advance(double seconds);
+		bool IsManual() const { return m_manual; }
+
+		double GetTime() const { return m_now.load(std::memory_order_relaxed); }
+		ma_uint64 GetPeriodCount() const { return m_periods.load(std::memory_order_relaxed); }
+
+	private:
+		// Every lock taken outside the scheduler announces itself first, so a free-running
+		// scheduler steps aside instead of starving start/stop calls.
+		std::unique_lock<std::mutex> lockForApi();
+
+		void run();
+		void tick(EndpointState &endpoint);
+		void disconnect(EndpointState &endpoint, std::vector<ma_device *> &lost);
+		void schedule(EndpointState &endpoint, double from);
+
+		EndpointState *find(ma_device_type type, const ma_device_id *pId);
+		Client *client(ma_device *pDevice);
+		bool isActive(const EndpointState &endpoint) const;
+		void fillInfo(const EndpointState &endpoint, ma_device_info *pInfo) const;
+		void fillDescriptor(const EndpointState &endpoint, ma_device_descriptor *pDescriptor) const;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_advanced; // Manual clock reached its target, or went idle
+		std::atomic<int> m_waiting = 0;
+		std::mutex m_lossMutex; // Held while lost devices are stopped; uninit waits for it
+
+		std::vector<std::unique_ptr<EndpointState>> m_endpoints;
+		std::vector<std::unique_ptr<Client>> m_clients;
+		std::vector<VirtualBackend::Event> m_events; // Sorted by time
+		size_t m_nextEvent = 0;
+
+		double m_speed = 0.0;
+		bool m_manual = false;
+		double m_advanceTo = 0.0;           // Manual clock target
+		bool m_paced = false;               // Pacing anchor is valid (reset whenever the clock idles)
+		Clock::time_point m_anchorReal;
+		double m_anchorVirtual = 0.0;
+
+		std::mt19937 m_rng;
+		std::atomic<double> m_now = 0.0;
+		std::atomic<ma_uint64> m_periods = 0;
+
+		bool m_quit = false;
+		std::thread m_thread;
+	};
+
+	Engine *engine(const ma_context *pContext) {
+		return static_cast<Engine *>(pContext->pUserData);
+	}
+
+	void post_notification(ma_device *pDevice, ma_device_notification_type type) {
+		if (pDevice->onNotification == nullptr) return;
+
+		ma_device_notification notification = {};
+		notification.pDevice = pDevice;
+		notification.type = type;
+		pDevice->onNotification(&notification);
+	}
+}
+
+// ============================================================================
+// Engine
+// ============================================================================
+
+Engine::Engine(const VirtualBackend::Script &script) : m_rng(script.seed) {
+	for (const VirtualBackend::Endpoint &config : script.endpoints) {
+		auto endpoint = std::make_unique<EndpointState>();
+		endpoint->config = config;
+		endpoint->mix.assign((size_t)config.periodFrames * config.channels, 0.0f);
+		endpoint->scratch.assign((size_t)config.periodFrames * config.channels, 0.0f);
+		m_endpoints.push_back(std::move(endpoint));
+	}
+
+	m_events = script.events;
+	std::stable_sort(m_events.begin(), m_events.end(), [](const auto &a, const auto &b) { return a.timeSeconds < b.timeSeconds; });
+	m_speed = script.speed;
+	m_manual = script.manual;
+
+	m_thread = std::thread(&Engine::run, this);
+}
+
+Engine::~Engine() {
+	{
+		auto lock = lockForApi();
+		m_quit = true;
+	}
+	m_wake.notify_all();
+	m_thread.join();
+}
+
+EndpointState *Engine::find(ma_device_type type, const ma_device_id *pId) {
+	EndpointState *fallback = nullptr;
+
+	for (auto &endpoint : m_endpoints) {
+		if (endpoint->config.type != type || !endpoint->connected) continue;
+
+		if (pId != nullptr) {
+			if (std::strncmp(pId->custom.s, endpoint->config.name.c_str(), sizeof(pId->custom.s)) == 0) return endpoint.get();
+		} else {
+			if (endpoint->config.isDefault) return endpoint.get();
+			if (fallback == nullptr) fallback = endpoint.get();
+		}
+	}
+	return fallback;
+}
+
+std::unique_lock<std::mutex> Engine::lockForApi() {
+	m_waiting.fetch_add(1, std::memory_order_relaxed);
+	std::unique_lock lock(m_mutex);
+	m_waiting.fetch_sub(1, std::memory_order_relaxed);
+	return lock;
+}
+
+Client *Engine::client(ma_device *pDevice) {
+	for (auto &c : m_clients) {
+		if (c->pDevice == pDevice) return c.get();
+	}
+	return nullptr;
+}
+
+bool Engine::isActive(const EndpointState &endpoint) const {
+	for (const auto &c : m_clients) {
+		if (c->running && (c->pPlayback == &endpoint || c->pCapture == &endpoint)) return true;
+	}
+	return false;
+}
+
+void Engine::fillInfo(const EndpointState &endpoint, ma_device_info *pInfo) const {
+	*pInfo = {};
+	std::strncpy(pInfo->id.custom.s, endpoint.config.name.c_str(), sizeof(pInfo->id.custom.s) - 1);
+	std::strncpy(pInfo->name, endpoint.config.name.c_str(), sizeof(pInfo->name) - 1);
+	pInfo->isDefault = endpoint.config.isDefault;
+
+	pInfo->nativeDataFormatCount = 1;
+	pInfo->nativeDataFormats[0].format = ma_format_f32;
+	pInfo->nativeDataFormats[0].channels = endpoint.config.channels;
+	pInfo->nativeDataFormats[0].sampleRate = endpoint.config.sampleRate;
+	pInfo->nativeDataFormats[0].flags = 0;
+}
+
+void Engine::fillDescriptor(const EndpointState &endpoint, ma_device_descriptor *pDescriptor) const {
+	// Shared-mode behaviour: the endpoint mixes in f32 at its own rate and period; miniaudio
+	// converts and resamples to whatever the device asked for.
+	pDescriptor->format = ma_format_f32;
+	pDescriptor->channels = endpoint.config.channels;
+	pDescriptor->sampleRate = endpoint.config.sampleRate;
+	ma_channel_map_init_standard(ma_standard_channel_map_default, pDescriptor->channelMap, MA_MAX_CHANNELS, endpoint.config.channels);
+	pDescriptor->periodSizeInFrames = endpoint.config.periodFrames;
+	pDescriptor->periodCount = 2;
+}
+
+ma_result Engine::Enumerate(ma_context *pContext, ma_enum_devices_callback_proc callback, void *pUserData) {
+	std::vector<std::pair<ma_device_type, ma_device_info>> infos;
+	{
+		auto lock = lockForApi();
+		for (const auto &endpoint : m_endpoints) {
+			if (!endpoint->connected) continue;
+			ma_device_info info;
+			fillInfo(*endpoint, &info);
+			infos.emplace_back(endpoint->config.type, info);
+		}
+	}
+
+	// The callback may call back into the context, so it runs unlocked.
+	for (auto &[type, info] : infos) {
+		if (!callback(pContext, type, &info, pUserData)) break;
+	}
+	return MA_SUCCESS;
+}
+
+ma_result Engine::GetInfo(ma_device_type type, const ma_device_id *pId, ma_device_info *pInfo) {
+	auto lock = lockForApi();
+
+	const EndpointState *endpoint = find(type, pId);
+	if (endpoint == nullptr) return MA_NO_DEVICE;
+
+	fillInfo(*endpoint, pInfo);
+	return MA_SUCCESS;
+}
+
+ma_result Engine::Init(ma_device *pDevice, ma_device_type type, ma_device_descriptor *pPlayback, ma_device_descriptor *pCapture) {
+	auto lock = lockForApi();
+
+	auto c = std::make_unique<Client>();
+	c->pDevice = pDevice;
+	c->loopback = type == ma_device_type_loopback;
+
+	if (type == ma_device_type_playback || type == ma_device_type_duplex) {
+		c->pPlayback = find(ma_device_type_playback, pPlayback->pDeviceID);
+		if (c->pPlayback == nullptr) return MA_NO_DEVICE;
+		fillDescriptor(*c->pPlayback, pPlayback);
+	}
+	if (type == ma_device_type_capture || type == ma_device_type_duplex) {
+		c->pCapture = find(ma_device_type_capture, pCapture->pDeviceID);
+		if (c->pCapture == nullptr) return MA_NO_DEVICE;
+		fillDescriptor(*c->pCapture, pCapture);
+	}
+	if (type == ma_device_type_loopback) {
+		// Loopback captures what a playback endpoint renders.
+		c->pCapture = find(ma_device_type_playback, pCapture->pDeviceID);
+		if (c->pCapture == nullptr) return MA_NO_DEVICE;
+		fillDescriptor(*c->pCapture, pCapture);
+	}
+
+	m_clients.push_back(std::move(c));
+	return MA_SUCCESS;
+}
+
+ma_result Engine::Uninit(ma_device *pDevice) {
+	std::lock_guard lossLock(m_lossMutex); // Not while the scheduler is stopping it as lost
+	auto lock = lockForApi();
+
+	std::erase_if(m_clients, [&](const auto &c) { return c->pDevice == pDevice; });
+	return MA_SUCCESS;
+}
+
+ma_result Engine::Start(ma_device *pDevice) {
+	{
+		auto lock = lockForApi();
+
+		Client *c = client(pDevice);
+		if (c == nullptr || c->invalidated) return MA_NO_DEVICE;
+
+		// An endpoint that was idle starts its clock one period from now.
+		for (EndpointState *endpoint : {c->pPlayback, c->pCapture}) {
+			if (endpoint != nullptr && !isActive(*endpoint)) schedule(*endpoint, GetTime());
+		}
+		c->running = true;
+	}
+	m_wake.notify_all();
+	return MA_SUCCESS;
+}
+
+ma_result Engine::Stop(ma_device *pDevice) {
+	{
+		// Waits for a period in progress, so no callback follows the return.
+		auto lock = lockForApi();
+
+		Client *c = client(pDevice);
+		if (c != nullptr) c->running = false;
+	}
+	post_notification(pDevice, ma_device_notification_type_stopped);
+	return MA_SUCCESS;
+}
+
+void Engine::schedule(EndpointState &endpoint, double from) {
+	const double period = endpoint.periodSeconds();
+	endpoint.nextPeriod = from + period;
+
+	// Jitter delays the callback, never the period boundary, so the clock itself stays exact.
+	const double maxJitter = std::min(endpoint.config.jitterUs * 1e-6, 0.9 * period);
+	endpoint.fireTime = endpoint.nextPeriod + (maxJitter > 0.0 ? std::uniform_real_distribution<double>(0.0, maxJitter)(m_rng) : 0.0);
+}
+
+void Engine::run() {
+	std::unique_lock lock(m_mutex);
+
+	while (!m_quit) {
+		if (m_waiting.load(std::memory_order_relaxed) > 0) {
+			lock.unlock();
+			while (m_waiting.load(std::memory_order_relaxed) > 0) std::this_thread::yield();
+			lock.lock();
+			continue;
+		}
+
+		// Next endpoint period, in time order; ties go to the endpoint declared first.
+		EndpointState *next = nullptr;
+		for (auto &endpoint : m_endpoints) {
+			if (!endpoint->connected || endpoint->stalled || !isActive(*endpoint)) continue;
+			if (next == nullptr || endpoint->fireTime < next->fireTime) next = endpoint.get();
+		}
+
+		// A scripted event comes first when it is due before that period, or when nothing runs.
+		const bool eventPending = m_nextEvent < m_events.size();
+		const bool eventDue = eventPending && (next == nullptr || m_events[m_nextEvent].timeSeconds <= next->fireTime);
+
+		if (next == nullptr && !eventDue) {
+			m_paced = false; // The clock stands still until a device starts
+			m_advanced.notify_all();
+			m_wake.wait(lock);
+			continue;
+		}
+
+		const double time = eventDue ? std::max(m_events[m_nextEvent].timeSeconds, GetTime()) : next->fireTime;
+
+		if (m_manual && time > m_advanceTo) {
+			m_now.store(std::max(GetTime(), m_advanceTo), std::memory_order_relaxed);
+			m_advanced.notify_all();
+			m_wake.wait(lock);
+			continue;
+		}
+
+		if (m_speed > 0.0) {
+			if (!m_paced) {
+				m_anchorReal = Clock::now();
+				m_anchorVirtual = GetTime();
+				m_paced = true;
+			}
+			const auto due = m_anchorReal + std::chrono::duration_cast<Clock::duration>(
+				std::chrono::duration<double>((time - m_anchorVirtual) / m_speed)
+			);
+			// Woken early by a start, stop or shutdown: pick the next period again.
+			if (m_wake.wait_until(lock, due) == std::cv_status::no_timeout) continue;
+		}
+
+		m_now.store(time, std::memory_order_relaxed);
+
+		if (!eventDue) {
+			tick(*next);
+			continue;
+		}
+
+		const VirtualBackend::Event event = m_events[m_nextEvent++];
+		std::vector<ma_device *> lost;
+		for (auto &endpoint : m_endpoints) {
+			if (endpoint->config.name != event.endpoint) continue;
+			switch (event.type) {
+				case VirtualBackend::EventType::Disconnect: disconnect(*endpoint, lost); break;
+				case VirtualBackend::EventType::Reconnect: endpoint->connected = true; break;
+				case VirtualBackend::EventType::Stall: endpoint->stalled = true; break;
+				case VirtualBackend::EventType::Resume:
+					// Periods resume from now rather than catching up on the ones missed.
+					if (endpoint->stalled) schedule(*endpoint, time);
+					endpoint->stalled = false;
+					break;
+			}
+		}
+
+		if (!lost.empty()) {
+			// Stopping goes through miniaudio (state and notification), which calls back into Stop(),
+			// so it runs unlocked. Holding the loss lock keeps the devices from being uninitialized
+			// meanwhile; any that already were are dropped first.
+			lock.unlock();
+			{
+				std::lock_guard lossLock(m_lossMutex);
+				{
+					std::lock_guard relock(m_mutex);
+					std::erase_if(lost, [&](ma_device *pDevice) { return client(pDevice) == nullptr; });
+				}
+				for (ma_device *pDevice : lost) {
+					ma_device_stop(pDevice);
+				}
+			}
+			lock.lock();
+		}
+	}
+}
+
+double Engine::Advance(double seconds) {
+	auto lock = lockForApi();
+	if (!m_manual) return GetTime();
+
+	m_advanceTo = GetTime() + seconds;
+	m_wake.notify_all();
+
+	// Returns early if every device stops and no scripted event is left, since the clock stands still then.
+	m_advanced.wait(lock, [&]() {
+		if (GetTime() >= m_advanceTo) return true;
+		for (const auto &endpoint : m_endpoints) {
+			if (endpoint->connected && !endpoint->stalled && isActive(*endpoint)) return false;
+		}
+		return m_nextEvent >= m_events.size();
+	});
+	return GetTime();
+}
+
+void Engine::disconnect(EndpointState &endpoint, std::vector<ma_device *> &lost) {
+	endpoint.connected = false;
+
+	for (auto &c : m_clients) {
+		if (c->pPlayback != &endpoint && c->pCapture != &endpoint) continue;
+		c->invalidated = true;
+		if (c->running) {
+			c->running = false;
+			lost.push_back(c->pDevice);
+		}
+	}
+}
+
+void Engine::tick(EndpointState &endpoint) {
+	const ma_uint32 frames = endpoint.config.periodFrames;
+	const ma_uint32 channels = endpoint.config.channels;
+
+	if (endpoint.config.type == ma_device_type_playback) {
+		// Render every playback client and sum them, like a shared-mode mixer.
+		std::fill(endpoint.mix.begin(), endpoint.mix.end(), 0.0f);
+		for (auto &c : m_clients) {
+			if (!c->running || c->pPlayback != &endpoint) continue;
+
+			std::fill(endpoint.scratch.begin(), endpoint.scratch.end(), 0.0f);
+			ma_device_handle_backend_data_callback(c->pDevice, endpoint.scratch.data(), nullptr, frames);
+			for (size_t i = 0; i < endpoint.mix.size(); ++i) {
+				endpoint.mix[i] += endpoint.scratch[i];
+			}
+		}
+	} else {
+		const double step = 2.0 * 3.14159265358979323846 * endpoint.config.toneHz / endpoint.config.sampleRate;
+		for (ma_uint32 i = 0; i < frames; ++i) {
+			const float sample = endpoint.config.toneHz > 0.0f ? endpoint.config.toneLevel * (float)std::sin(endpoint.phase) : 0.0f;
+			endpoint.phase = std::fmod(endpoint.phase + step, 2.0 * 3.14159265358979323846);
+			for (ma_uint32 ch = 0; ch < channels; ++ch) {
+				endpoint.mix[(size_t)i * channels + ch] = sample;
+			}
+		}
+	}
+
+	// Capture clients get the tone; loopback clients get what the endpoint just played.
+	for (auto &c : m_clients) {
+		if (!c->running || c->pCapture != &endpoint) continue;
+		ma_device_handle_backend_data_callback(c->pDevice, nullptr, endpoint.mix.data(), frames);
+	}
+
+	m_periods.fetch_add(1, std::memory_order_relaxed);
+	schedule(endpoint, endpoint.nextPeriod);
+}
+
+// ============================================================================
+// miniaudio callbacks
+// ============================================================================
+
+static ma_result on_context_uninit(ma_context *pContext) {
+	delete engine(pContext);
+	pContext->pUserData = nullptr;
+	return MA_SUCCESS;
+}
+
+static ma_result on_context_enumerate_devices(ma_context *pContext, ma_enum_devices_callback_proc callback, void *pUserData) {
+	return engine(pContext)->Enumerate(pContext, callback, pUserData);
+}
+
+static ma_result on_context_get_device_info(ma_context *pContext, ma_device_type deviceType, const ma_device_id *pDeviceID, ma_device_info *pDeviceInfo) {
+	return engine(pContext)->GetInfo(deviceType, pDeviceID, pDeviceInfo);
+}
+
+static ma_result on_device_init(ma_device *pDevice, const ma_device_config *pConfig, ma_device_descriptor *pDescriptorPlayback, ma_device_descriptor *pDescriptorCapture) {
+	return engine(pDevice->pContext)->Init(pDevice, pConfig->deviceType, pDescriptorPlayback, pDescriptorCapture);
+}
+
+static ma_result on_device_uninit(ma_device *pDevice) {
+	return engine(pDevice->pContext)->Uninit(pDevice);
+}
+
+static ma_result on_device_start(ma_device *pDevice) {
+	return engine(pDevice->pContext)->Start(pDevice);
+}
+
+static ma_result on_device_stop(ma_device *pDevice) {
+	return engine(pDevice->pContext)->Stop(pDevice);
+}
+
+static ma_result on_context_init(ma_context *pContext, const ma_context_config *pConfig, ma_backend_callbacks *pCallbacks) {
+	const auto *pScript = static_cast<const VirtualBackend::Script *>(pConfig->pUserData);
+	if (pScript == nullptr) return MA_INVALID_ARGS;
+
+	// The context user data is the script until here, and the engine from now on.
+	pContext->pUserData = new Engine(*pScript);
+
+	// No read/write or data loop callbacks: miniaudio treats the backend as asynchronous and
+	// leaves the callback timing to the scheduler thread.
+	pCallbacks->onContextInit = on_context_init;
+	pCallbacks->onContextUninit = on_context_uninit;
+	pCallbacks->onContextEnumerateDevices = on_context_enumerate_devices;
+	pCallbacks->onContextGetDeviceInfo = on_context_get_device_info;
+	pCallbacks->onDeviceInit = on_device_init;
+	pCallbacks->onDeviceUninit = on_device_uninit;
+	pCallbacks->onDeviceStart = on_device_start;
+	pCallbacks->onDeviceStop = on_device_stop;
+	return MA_SUCCESS;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+ma_context_config VirtualBackend::ContextConfig(const Script *pScript) {
+	ma_context_config config = ma_context_config_init();
+	config.custom.onContextInit = on_context_init;
+	config.pUserData = const_cast<Script *>(pScript);
+	return config;
+}
+
+bool VirtualBackend::IsActive(const ma_context *pContext) {
+	return pContext->backend == ma_backend_custom && pContext->callbacks.onContextInit == on_context_init;
+}
+
+bool VirtualBackend::IsManual(const ma_context *pContext) {
+	return IsActive(pContext) && engine(pContext)->IsManual();
+}
+
+double VirtualBackend::GetTimeSeconds(const ma_context *pContext) {
+	return IsActive(pContext) ? engine(pContext)->GetTime() : 0.0;
+}
+
+double VirtualBackend::Advance(const ma_context *pContext, double seconds) {
+	return IsActive(pContext) ? engine(pContext)->Advance(seconds) : 0.0;
+}
+
+ma_uint64 VirtualBackend::GetPeriodCount(const ma_context *pContext) {
+	return IsActive(pContext) ? engine(pContext)->GetPeriodCount() : 0;
+}
+
+VirtualBackend::Script VirtualBackend::DefaultScript() {
+	Script script;
+
+	Endpoint speakers;
+	speakers.name = "Speakers";
+	speakers.isDefault = true;
+	script.endpoints.push_back(speakers);
+
+	Endpoint headphones;
+	headphones.name = "Headphones";
+	headphones.periodFrames = 441;
+	headphones.skewPpm = 50.0;
+	headphones.jitterUs = 500.0;
+	script.endpoints.push_back(headphones);
+
+	Endpoint microphone;
+	microphone.name = "Microphone";
+	microphone.type = ma_device_type_capture;
+	microphone.isDefault = true;
+	script.endpoints.push_back(microphone);
+
+	return script;
+}
+
+Result<VirtualBackend::Script, Error> VirtualBackend::ParseScript(std::string_view text) {
+	Script script;
+
+	const auto number = [](std::string_view key, std::string_view value) -> Result<double, Error> {
+		const std::string str(value);
+		char *end = nullptr;
+		const double parsed = std::strtod(str.c_str(), &end);
+		if (str.empty() || *end != '\0') return Error(std::format("Invalid value '{}' for '{}'.", value, key));
+		return parsed;
+	};
+
+	size_t start = 0;
+	while (start <= text.size()) {
+		const size_t end = std::min(text.find_first_of(";\n", start), text.size());
+		const std::string_view statement = text.substr(start, end - start);
+		start = end + 1;
+
+		// Whitespace separated words
+		std::vector<std::string_view> words;
+		for (size_t i = 0; i < statement.size();) {
+			i = statement.find_first_not_of(" \t\r", i);
+			if (i == std::string_view::npos) break;
+			const size_t j = std::min(statement.find_first_of(" \t\r", i), statement.size());
+			words.push_back(statement.substr(i, j - i));
+			i = j;
+		}
+		if (words.empty()) continue;
+
+		const std::string_view keyword = words[0];
+
+		if (keyword == "speed" && words.size() == 2 && words[1] == "manual") {
+			script.manual = true;
+		} else if (keyword == "speed" || keyword == "seed") {
+			if (words.size() != 2) return Error(std::format("'{}' takes one value.", keyword));
+			auto value = number(keyword, words[1]);
+			if (!value) return value.error();
+			if (keyword == "speed") script.speed = std::max(0.0, value.value());
+			else script.seed = (ma_uint32)value.value();
+		} else if (keyword == "playback" || keyword == "capture") {
+			if (words.size() < 2) return Error(std::format("'{}' needs an endpoint name.", keyword));
+
+			Endpoint endpoint;
+			endpoint.name = words[1];
+			endpoint.type = keyword == "playback" ? ma_device_type_playback : ma_device_type_capture;
+
+			for (size_t i = 2; i < words.size(); ++i) {
+				if (words[i] == "default") {
+					endpoint.isDefault = true;
+					continue;
+				}
+
+				const size_t eq = words[i].find('=');
+				if (eq == std::string_view::npos) return Error(std::format("Expected key=value, got '{}'.", words[i]));
+				const std::string_view key = words[i].substr(0, eq);
+				auto value = number(key, words[i].substr(eq + 1));
+				if (!value) return value.error();
+				const double v = value.value();
+
+				if (key == "rate" && v >= 8000 && v <= 384000) endpoint.sampleRate = (ma_uint32)v;
+				else if (key == "channels" && v >= 1 && v <= MA_MAX_CHANNELS) endpoint.channels = (ma_uint32)v;
+				else if (key == "period" && v >= 16) endpoint.periodFrames = (ma_uint32)v;
+				else if (key == "skew" && std::abs(v) < 1e5) endpoint.skewPpm = v;
+				else if (key == "jitter" && v >= 0) endpoint.jitterUs = v;
+				else if (key == "tone" && v >= 0) endpoint.toneHz = (float)v;
+				else if (key == "level" && v >= 0) endpoint.toneLevel = (float)v;
+				else return Error(std::format("Invalid endpoint setting '{}'.", words[i]));
+			}
+
+			for (const Endpoint &existing : script.endpoints) {
+				if (existing.name == endpoint.name) return Error(std::format("Duplicate endpoint '{}'.", endpoint.name));
+			}
+			if (endpoint.name.size() >= sizeof(ma_device_id{}.custom.s)) {
+				return Error(std::format("Endpoint name '{}' is too long.", endpoint.name));
+			}
+			script.endpoints.push_back(endpoint);
+		} else if (keyword == "lose" || keyword == "restore" || keyword == "stall" || keyword == "resume") {
+			if (words.size() != 3 || !words[2].starts_with("at=")) {
+				return Error(std::format("Expected '{} <endpoint> at=<seconds>'.", keyword));
+			}
+			auto time = number("at", words[2].substr(3));
+			if (!time) return time.error();
+
+			const EventType type =
+				keyword == "lose" ? EventType::Disconnect :
+				keyword == "restore" ? EventType::Reconnect :
+				keyword == "stall" ? EventType::Stall : EventType::Resume;
+			script.events.push_back(Event{time.value(), type, std::string(words[1])});
+		} else {
+			return Error(std::format("Unknown script statement '{}'.", keyword));
+		}
+	}
+
+	for (const Event &event : script.events) {
+		const bool known = std::any_of(script.endpoints.begin(), script.endpoints.end(), [&](const Endpoint &e) { return e.name == event.endpoint; });
+		if (!known) return Error(std::format("Event for unknown endpoint '{}'.", event.endpoint));
+	}
+
+	// The first endpoint of each type is the default unless one is marked.
+	for (const ma_device_type type : {ma_device_type_playback, ma_device_type_capture}) {
+		const auto ofType = [&](const Endpoint &e) { return e.type == type; };
+		const bool hasDefault = std::any_of(script.endpoints.begin(), script.endpoints.end(), [&](const Endpoint &e) { return ofType(e) && e.isDefault; });
+		const auto first = std::find_if(script.endpoints.begin(), script.endpoints.end(), ofType);
+		if (!hasDefault && first != script.endpoints.end()) first->isDefault = true;
+	}
+
+	if (script.endpoints.empty()) return Error("Script defines no endpoints.");
+	return script;
+}
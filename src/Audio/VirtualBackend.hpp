@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "miniaudio.h"
+#include "Result.hpp"
+#include "Error.hpp"
+
+// Deterministic stand-in audio backend for miniaudio (ma_backend_custom), on a virtual clock.
+//
+// Endpoints are scripted: playback endpoints (which can also be opened as loopback sources)
+// and capture endpoints with their own rate, period, clock skew and callback jitter. One
+// scheduler thread fires every endpoint's period in virtual-time order: a playback period
+// pulls from each playback client and sums them, and hands that mix to the endpoint's
+// loopback clients; a capture period delivers a test tone. With speed 0 the clock runs as
+// fast as the CPU allows, so hours of pipeline time take seconds; speed 1 paces it to the
+// wall clock. A free-running clock keeps going while the caller starts and stops devices, so
+// for runs that must repeat exactly use the manual clock: it only moves in Advance(), and the
+// same script, seed and sequence of calls always give the same callbacks.
+//
+// Scripted events disconnect an endpoint (its running devices stop with a stopped
+// notification and cannot start again) and reconnect it (new devices can be opened on it), or
+// stall an endpoint (its devices stay started but get no callbacks) and resume it.
+// Virtual time only advances while at least one device is running; with none, it skips ahead to
+// the next scripted event (so a lost device still gets restored while everything is stopped).
+class VirtualBackend {
+public:
+	struct Endpoint {
+		std::string name;                               // Also the device ID (ma_device_id::custom.s)
+		ma_device_type type = ma_device_type_playback;  // playback or capture
+		ma_uint32 sampleRate = 48000;
+		ma_uint32 channels = 2;
+		ma_uint32 periodFrames = 480;
+		double skewPpm = 0.0;      // Clock error against the virtual clock; positive runs fast
+		double jitterUs = 0.0;     // Each period fires up to this much late (uniform)
+		float toneHz = 1000.0f;    // Capture signal; 0 for silence
+		float toneLevel = 0.25f;
+		bool isDefault = false;
+	};
+
+	enum class EventType
+	{
+		Disconnect,
+		Reconnect,
+		Stall,  // The endpoint stops firing periods without any notification
+		Resume
+	};
+
+	struct Event {
+		double timeSeconds; // Virtual time
+		EventType type;
+		std::string endpoint;
+	};
+
+	struct Script {
+		std::vector<Endpoint> endpoints;
+		std::vector<Event> events;
+		double speed = 0.0; // 0: as fast as possible; 1: real time
+		bool manual = false; // The clock only moves in Advance(); overrides speed
+		ma_uint32 seed = 1; // Jitter random seed
+	};
+
+	// Statements separated by ';' or newlines, e.g.
+	//   playback Speakers default; playback Headphones skew=50 jitter=500 period=441
+	//   capture Mic tone=440 level=0.5; lose Headphones at=30; restore Headphones at=35; speed 0
+	// "stall <endpoint> at=<s>" and "resume <endpoint> at=<s>" hang and release an endpoint.
+	// "speed manual" selects the manual clock.
+	// Endpoint keys: rate, channels, period (frames), skew (ppm), jitter (us), tone (Hz), level, default.
+	static Result<Script, Error> ParseScript(std::string_view text);
+
+	// Two playback endpoints (one skewed and jittery) and one capture endpoint.
+	static Script DefaultScript();
+
+	// Context config selecting this backend; pass with ma_backend_custom to ma_context_init().
+	// The script is copied when the context initializes.
+	static ma_context_config ContextConfig(const Script *pScript);
+
+	static bool IsActive(const ma_context *pContext);
+	static bool IsManual(const ma_context *pContext); // Active with the manual clock
+	static double GetTimeSeconds(const ma_context *pContext);    // 0 for other backends
+	static ma_uint64 GetPeriodCount(const ma_context *pContext); // Endpoint periods fired so far
+
+	// Manual clock: run the running devices for this much virtual time, as fast as possible.
+	// Blocks until done (or until no device is running) and returns the virtual time reached.
+	static double Advance(const ma_context *pContext, double seconds);
+};
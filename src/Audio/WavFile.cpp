@@ -0,0 +1,288 @@
+#include "WavFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <string>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+	// WAV fields are little-endian.
+	struct HeaderWriter {
+		ma_uint8 *p;
+
+		void bytes(const char *s, size_t n) { std::memcpy(p, s, n); p += n; }
+		void u16(ma_uint16 v) { for (int i = 0; i < 2; ++i) *p++ = (ma_uint8)(v >> (8 * i)); }
+		void u32(ma_uint32 v) { for (int i = 0; i < 4; ++i) *p++ = (ma_uint8)(v >> (8 * i)); }
+		void u64(ma_uint64 v) { for (int i = 0; i < 8; ++i) *p++ = (ma_uint8)(v >> (8 * i)); }
+	};
+
+	ma_uint16 read_u16(const ma_uint8 *p) { return (ma_uint16)(p[0] | p[1] << 8); }
+	ma_uint32 read_u32(const ma_uint8 *p) { return (ma_uint32)read_u16(p) | (ma_uint32)read_u16(p + 2) << 16; }
+	ma_uint64 read_u64(const ma_uint8 *p) { return (ma_uint64)read_u32(p) | (ma_uint64)read_u32(p + 4) << 32; }
+
+	constexpr ma_uint16 kFormatPcm = 1;
+	constexpr ma_uint16 kFormatFloat = 3;
+	constexpr ma_uint16 kFormatExtensible = 0xFFFE;
+
+	// miniaudio's positions from front left to top back right are in the order of the WAVE
+	// speaker mask bits.
+	ma_uint32 speaker_mask(ma_uint32 channels) {
+		ma_channel map[MA_MAX_CHANNELS];
+		ma_channel_map_init_standard(ma_standard_channel_map_microsoft, map, MA_MAX_CHANNELS, channels);
+
+		ma_uint32 mask = 0;
+		for (ma_uint32 c = 0; c < channels; ++c) {
+			if (map[c] == MA_CHANNEL_MONO) mask |= 1u << (MA_CHANNEL_FRONT_CENTER - MA_CHANNEL_FRONT_LEFT);
+			else if (map[c] >= MA_CHANNEL_FRONT_LEFT && map[c] <= MA_CHANNEL_TOP_BACK_RIGHT) mask |= 1u << (map[c] - MA_CHANNEL_FRONT_LEFT);
+		}
+		return mask;
+	}
+
+	ma_result result_from_errno(int error) {
+		return error == ENOENT ? MA_DOES_NOT_EXIST : error == EACCES ? MA_ACCESS_DENIED : MA_ERROR;
+	}
+}
+
+// ============================================================================
+// WavWriter
+// ============================================================================
+
+ma_result WavWriter::Open(const char *path, ma_format format, ma_uint32 channels, ma_uint32 sampleRate) {
+	Close();
+	if (path == nullptr || format == ma_format_unknown || channels == 0 || sampleRate == 0) return MA_INVALID_ARGS;
+
+	m_file = std::fopen(path, "wb");
+	if (m_file == nullptr) return result_from_errno(errno);
+	std::setvbuf(m_file, nullptr, _IONBF, 0); // The callers' blocks are the buffering
+
+	m_format = format;
+	m_channels = channels;
+	m_sampleRate = sampleRate;
+	m_dataBytes = 0;
+	m_error = MA_SUCCESS;
+
+	write_header(); // Placeholder sizes until Close()
+	return m_error;
+}
+
+ma_result WavWriter::Write(const void *pData, size_t bytes) {
+	if (m_error != MA_SUCCESS) return m_error;
+	if (std::fwrite(pData, 1, bytes, m_file) != bytes) {
+		m_error = MA_IO_ERROR;
+		return m_error;
+	}
+	m_dataBytes += bytes;
+	return MA_SUCCESS;
+}
+
+ma_result WavWriter::Close() {
+	if (m_file == nullptr) return MA_SUCCESS;
+
+	// The data chunk is padded to an even size; the sizes in the header cover it. After a
+	// failed write the header still gets the sizes of what made it into the file.
+	if ((m_dataBytes & 1) != 0 && std::fputc(0, m_file) == EOF && m_error == MA_SUCCESS) m_error = MA_IO_ERROR;
+	if (std::fseek(m_file, 0, SEEK_SET) == 0) write_header();
+	else if (m_error == MA_SUCCESS) m_error = MA_IO_ERROR;
+
+	if (std::fclose(m_file) != 0 && m_error == MA_SUCCESS) m_error = MA_IO_ERROR;
+	m_file = nullptr;
+	return m_error;
+}
+
+// RIFF/WAVE header of HeaderBytes: a JUNK chunk where RF64 puts its ds64 chunk, the format,
+// a JUNK chunk padding to the data chunk, and the data chunk's header. Past 4 GiB the file
+// becomes RF64, with the 64-bit sizes in the ds64 chunk.
+void WavWriter::write_header() {
+	alignas(8) ma_uint8 header[HeaderBytes] = {};
+	HeaderWriter w{header};
+
+	const ma_uint32 bytesPerSample = ma_get_bytes_per_sample(m_format);
+	const ma_uint32 blockAlign = bytesPerSample * m_channels;
+	const ma_uint16 tag = m_format == ma_format_f32 ? kFormatFloat : kFormatPcm;
+	const bool extensible = m_channels > 2 || bytesPerSample > 2;
+	const ma_uint64 riffBytes = HeaderBytes - 8 + m_dataBytes + (m_dataBytes & 1);
+	const bool rf64 = riffBytes > 0xFFFFFFFFull;
+
+	w.bytes(rf64 ? "RF64" : "RIFF", 4);
+	w.u32(rf64 ? 0xFFFFFFFFu : (ma_uint32)riffBytes);
+	w.bytes("WAVE", 4);
+
+	w.bytes(rf64 ? "ds64" : "JUNK", 4);
+	w.u32(28);
+	w.u64(riffBytes);
+	w.u64(m_dataBytes);
+	w.u64(m_dataBytes / blockAlign);
+	w.u32(0); // No table
+
+	w.bytes("fmt ", 4);
+	w.u32(extensible ? 40 : 16);
+	w.u16(extensible ? kFormatExtensible : tag);
+	w.u16((ma_uint16)m_channels);
+	w.u32(m_sampleRate);
+	w.u32(m_sampleRate * blockAlign);
+	w.u16((ma_uint16)blockAlign);
+	w.u16((ma_uint16)(bytesPerSample * 8));
+	if (extensible) {
+		w.u16(22);
+		w.u16((ma_uint16)(bytesPerSample * 8)); // Valid bits
+		w.u32(speaker_mask(m_channels));
+		w.u32(tag); // Subformat GUID: the format tag, then the fixed WAVE suffix
+		w.u16(0x0000);
+		w.u16(0x0010);
+		w.bytes("\x80\x00\x00\xAA\x00\x38\x9B\x71", 8);
+	}
+
+	const size_t padding = HeaderBytes - 8 - (size_t)(w.p - header) - 8; // Up to the data chunk header
+	w.bytes("JUNK", 4);
+	w.u32((ma_uint32)padding);
+	w.p += padding;
+
+	w.bytes("data", 4);
+	w.u32(rf64 ? 0xFFFFFFFFu : (ma_uint32)m_dataBytes);
+
+	if (std::fwrite(header, 1, HeaderBytes, m_file) != HeaderBytes && m_error == MA_SUCCESS) m_error = MA_IO_ERROR;
+}
+
+// ============================================================================
+// MappedWavFile
+// ============================================================================
+
+ma_result MappedWavFile::Open(const char *path) {
+	Close();
+	if (path == nullptr) return MA_INVALID_ARGS;
+
+#ifdef _WIN32
+	// Paths are UTF-8.
+	const int length = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+	if (length == 0) return MA_INVALID_ARGS;
+	std::wstring widePath(length, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, path, -1, widePath.data(), length);
+
+	HANDLE file = CreateFileW(
+		widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) {
+		const DWORD error = GetLastError();
+		return error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND ? MA_DOES_NOT_EXIST
+			: error == ERROR_ACCESS_DENIED ? MA_ACCESS_DENIED : MA_ERROR;
+	}
+	m_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		Close();
+		return MA_INVALID_FILE;
+	}
+	m_size = (size_t)size.QuadPart;
+
+	m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping != nullptr) m_pView = static_cast<const ma_uint8 *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0) return result_from_errno(errno);
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size == 0) {
+		close(fd);
+		return MA_INVALID_FILE;
+	}
+	m_size = (size_t)status.st_size;
+
+	void *view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // The mapping keeps the file open
+	if (view != MAP_FAILED) {
+		madvise(view, m_size, MADV_SEQUENTIAL);
+		m_pView = static_cast<const ma_uint8 *>(view);
+	}
+#endif
+
+	if (m_pView == nullptr) {
+		Close();
+		return MA_OUT_OF_MEMORY;
+	}
+
+	const ma_result result = parse();
+	if (result != MA_SUCCESS) Close();
+	return result;
+}
+
+void MappedWavFile::Close() {
+#ifdef _WIN32
+	if (m_pView != nullptr) UnmapViewOfFile(m_pView);
+	if (m_mapping != nullptr) CloseHandle(m_mapping);
+	if (m_file != nullptr) CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	if (m_pView != nullptr) munmap(const_cast<ma_uint8 *>(m_pView), m_size);
+#endif
+	m_pView = nullptr;
+	m_size = 0;
+	m_format = ma_format_unknown;
+	m_channels = 0;
+	m_sampleRate = 0;
+	m_pFrames = nullptr;
+	m_frameCount = 0;
+}
+
+// Walks the chunks up to the data chunk. A data chunk that is cut short, or still has the
+// placeholder size of a recording that never finished, is taken to run to the end of the file.
+ma_result MappedWavFile::parse() {
+	if (m_size < 12) return MA_INVALID_FILE;
+	const bool rf64 = std::memcmp(m_pView, "RF64", 4) == 0;
+	if ((!rf64 && std::memcmp(m_pView, "RIFF", 4) != 0) || std::memcmp(m_pView + 8, "WAVE", 4) != 0) return MA_INVALID_FILE;
+
+	ma_uint64 ds64DataBytes = 0;
+	const ma_uint8 *fmt = nullptr;
+	size_t pos = 12;
+	while (pos + 8 <= m_size) {
+		const ma_uint8 *chunk = m_pView + pos;
+		const size_t remaining = m_size - pos - 8;
+		ma_uint64 size = read_u32(chunk + 4);
+
+		if (std::memcmp(chunk, "ds64", 4) == 0 && size >= 24 && remaining >= 24) {
+			ds64DataBytes = read_u64(chunk + 16);
+		} else if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16 && remaining >= size) {
+			fmt = chunk + 8;
+			ma_uint16 tag = read_u16(fmt);
+			if (tag == kFormatExtensible && size >= 40) tag = read_u16(fmt + 24);
+
+			m_channels = read_u16(fmt + 2);
+			m_sampleRate = read_u32(fmt + 4);
+			const ma_uint32 blockAlign = read_u16(fmt + 12);
+			const ma_uint32 bits = read_u16(fmt + 14);
+
+			if (tag == kFormatFloat && bits == 32) m_format = ma_format_f32;
+			else if (tag == kFormatPcm && bits == 8) m_format = ma_format_u8;
+			else if (tag == kFormatPcm && bits == 16) m_format = ma_format_s16;
+			else if (tag == kFormatPcm && bits == 24) m_format = ma_format_s24;
+			else if (tag == kFormatPcm && bits == 32) m_format = ma_format_s32;
+			else return MA_FORMAT_NOT_SUPPORTED;
+
+			// Samples in wider containers (e.g. 24 in 32 bits) are not read.
+			if (m_channels == 0 || m_sampleRate == 0 || blockAlign != ma_get_bytes_per_frame(m_format, m_channels)) {
+				return MA_FORMAT_NOT_SUPPORTED;
+			}
+		} else if (std::memcmp(chunk, "data", 4) == 0) {
+			if (fmt == nullptr) return MA_INVALID_FILE;
+			if (rf64 && size == 0xFFFFFFFFu) size = ds64DataBytes;
+			if (size == 0 || size > remaining) size = remaining;
+
+			m_pFrames = chunk + 8;
+			m_frameCount = size / ma_get_bytes_per_frame(m_format, m_channels);
+			return MA_SUCCESS;
+		}
+
+		pos += 8 + (size_t)std::min<ma_uint64>(size + (size & 1), remaining);
+	}
+	return MA_INVALID_FILE;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdio>
+#include "miniaudio.h"
+
+// Streams sample data to a WAV file with unbuffered writes; callers hand it large blocks.
+//
+// The header is padded so the sample data starts at HeaderBytes, which keeps blocks of an
+// aligned size at aligned file offsets. Close() fills in the sizes, switching the file to RF64
+// (EBU Tech 3306) past 4 GiB; until then the header holds placeholder sizes.
+class WavWriter {
+public:
+	static constexpr size_t HeaderBytes = 4096; // Where the sample data starts in the file
+
+	WavWriter() = default;
+	~WavWriter() { Close(); }
+	WavWriter(const WavWriter &) = delete;
+	WavWriter &operator=(const WavWriter &) = delete;
+
+	ma_result Open(const char *path, ma_format format, ma_uint32 channels, ma_uint32 sampleRate);
+	// Returns the first write error of the file; once a write failed, later ones are refused.
+	ma_result Write(const void *pData, size_t bytes);
+	// Completes the header and closes the file. Returns the first error of the file, if any.
+	ma_result Close();
+
+	bool IsOpen() const { return m_file != nullptr; }
+	ma_uint64 GetDataBytes() const { return m_dataBytes; }
+
+private:
+	void write_header();
+
+	std::FILE *m_file = nullptr;
+	ma_format m_format = ma_format_unknown;
+	ma_uint32 m_channels = 0;
+	ma_uint32 m_sampleRate = 0;
+	ma_uint64 m_dataBytes = 0;
+	ma_result m_error = MA_SUCCESS;
+};
+
+// A WAV file mapped into memory read-only, so its sample data is read in place. Reads PCM
+// (8, 16, 24 and 32-bit) and 32-bit float, plain or extensible, from RIFF and RF64 files.
+class MappedWavFile {
+public:
+	MappedWavFile() = default;
+	~MappedWavFile() { Close(); }
+	MappedWavFile(const MappedWavFile &) = delete;
+	MappedWavFile &operator=(const MappedWavFile &) = delete;
+
+	ma_result Open(const char *path);
+	void Close();
+
+	ma_format GetFormat() const { return m_format; }
+	ma_uint32 GetChannels() const { return m_channels; }
+	ma_uint32 GetSampleRate() const { return m_sampleRate; }
+	const void *GetFrames() const { return m_pFrames; }
+	ma_uint64 GetFrameCount() const { return m_frameCount; }
+
+private:
+	ma_result parse();
+
+	const ma_uint8 *m_pView = nullptr;
+	size_t m_size = 0;
+#ifdef _WIN32
+	void *m_file = nullptr;    // HANDLE
+	void *m_mapping = nullptr; // HANDLE
+#endif
+
+	ma_format m_format = ma_format_unknown;
+	ma_uint32 m_channels = 0;
+	ma_uint32 m_sampleRate = 0;
+	const void *m_pFrames = nullptr;
+	ma_uint64 m_frameCount = 0;
+};
@@ -0,0 +1,691 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <optional>
+#include <string>
+#include <vector>
+#include <thread>
+#include <format>
+#include <algorithm>
+
+#include "AudioRedirector.hpp"
+#include "MAConvert.hpp"
+#include "VirtualBackend.hpp"
+
+// Headless redirector: the audio core without Qt, for machines with no display.
+// Runs one loopback or duplex redirect until SIGINT/SIGTERM (Ctrl+C, Ctrl+Break), or renders a
+// WAV file through one offline.
+
+using Clock = std::chrono::steady_clock;
+
+enum class Mode
+{
+	Loopback,
+	Duplex
+};
+
+struct Options {
+	Mode mode = Mode::Loopback;
+	bool list = false;
+	std::string source;   // Empty selects the system default
+	std::string playback; // Empty selects the system default
+	ma_format format = ma_format_unknown;
+	ma_format playbackFormat = ma_format_unknown;
+	bool autoFormat = false; // Open the devices at their native formats
+	ma_uint32 sampleRate = 0;
+	ma_uint32 channels = 0;
+	ma_uint32 playbackChannels = 0;
+	std::vector<ChannelRoute> routes; // Empty routes by channel position
+	ma_uint32 latencyMs = 0;
+	ResamplerQuality resampler = ResamplerQuality::Medium;
+	PeriodConfig period;      // Zeros keep the backend default
+	bool tunePeriod = false;  // Find the smallest stable period once running
+	float gain = 1.0f;
+	bool limiter = false;
+	ma_uint32 measureMarkers = 0; // Measure loopback latency with this many markers instead of redirecting
+	std::optional<std::string> virtualScript; // Run on VirtualBackend instead of real devices
+	double durationSeconds = 0.0;             // Stop after this much pipeline time; 0 runs until a signal
+	std::optional<std::string> record;        // Record the source to this WAV file while running
+	std::optional<std::string> render;        // Render this WAV file offline instead of redirecting
+	std::optional<std::string> renderTo;      // ... to this one
+	std::optional<std::string> switchTo;      // Move to this playback device while running
+	double switchAtSeconds = 2.0;             // ... at this pipeline time
+	std::optional<std::string> crashLog;      // Append the unlogged audio events here on a crash
+};
+
+static std::atomic<bool> g_stop = false;
+
+static void on_signal(int) {
+	g_stop.store(true);
+}
+
+static double ms_since(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void print_usage() {
+	std::printf(
+		"Usage: AudioRedirectorHeadless [options]\n"
+		"\n"
+		"  --list                   List devices and exit\n"
+		"  --mode loopback|duplex   Redirect system output (loopback) or a capture device (default: loopback)\n"
+		"  --source <device>        Device to redirect from: a playback device for loopback, a capture device for duplex\n"
+		"  --playback <device>      Device to play on\n"
+		"  --format <format>        Sample format on both sides: u8, s16, s24, s32, f32, or auto to negotiate\n"
+		"                           format, rate and channels from the devices' native formats\n"
+		"  --playback-format <fmt>  Override the playback side format\n"
+		"  --rate <hz>              Sample rate\n"
+		"  --channels <n>           Channel count on both sides, 1 to 32 (default: 2)\n"
+		"  --playback-channels <n>  Override the playback side channel count\n"
+		"  --route <routes>         Channel routing, comma separated out=in[*gain] with channels from 0;\n"
+		"                           e.g. 0=1,1=0 swaps, 0=0,1=0 plays the left channel on both.\n"
+		"                           Routes to one output add up. Default: by channel position\n"
+		"  --gain <linear>          Volume, e.g. 0.5 or 4 for a 4x boost (default: 1)\n"
+		"  --latency <ms>           Loopback target latency\n"
+		"  --resampler <quality>    Where a device runs at another rate: linear (miniaudio's), or a\n"
+		"                           windowed-sinc tier: low, medium (default), high\n"
+		"  --period <frames>        Device period size (default: backend default, 10 ms)\n"
+		"  --periods <n>            Device period count (default: backend default, 3)\n"
+		"  --profile <profile>      Device performance profile: low-latency (default), conservative\n"
+		"  --tune-period            Step the period down once running and keep the smallest stable one\n"
+		"  --limiter                Enable the true-peak limiter, e.g. with a --gain boost\n"
+		"  --measure-latency <n>    Measure loopback latency with n markers played on the source, then exit\n"
+		"  --virtual <script>       Use simulated devices on a virtual clock; 'default' for the built-in script\n"
+		"  --duration <seconds>     Stop after this much pipeline time (virtual time with --virtual)\n"
+		"  --record <file.wav>      Record what the source delivers to a WAV file while redirecting\n"
+		"  --render <in.wav>        Run a WAV file through the path's processing without devices, then exit\n"
+		"  --render-to <out.wav>    Where --render writes its output\n"
+		"  --switch-to <device>     Switch to another playback device while running and report the gap\n"
+		"  --switch-at <seconds>    When to switch, in pipeline time (default: 2)\n"
+		"  --crash-log <file>       On a crash, append the audio events not logged yet to this file\n"
+		"\n"
+		"Devices are matched by ID, then by exact name, then by list index, then by a unique\n"
+		"case-insensitive part of the name. Omit a device to use the system default.\n"
+	);
+}
+
+// Accepts the short form ("s16") as well as the full UI string ("s16 (Signed 16-bit)").
+static std::optional<ma_format> parse_format(const std::string &str) {
+	for (const ma_format format : AudioRedirector::Formats) {
+		const std::string_view name = ma::convert::to_string(format);
+		if (name == str || (name.starts_with(str) && name.size() > str.size() && name[str.size()] == ' ')) {
+			return format;
+		}
+	}
+	return std::nullopt;
+}
+
+// "out=in[*gain],...", e.g. "0=0*0.5,0=1*0.5" for a mono downmix.
+static Result<std::vector<ChannelRoute>, Error> parse_routes(const std::string &str) {
+	std::vector<ChannelRoute> routes;
+	size_t begin = 0;
+	while (begin <= str.size()) {
+		const size_t end = std::min(str.find(',', begin), str.size());
+		const std::string entry = str.substr(begin, end - begin);
+		begin = end + 1;
+
+		ChannelRoute route = {0, 0, 1.0f};
+		char *pos = nullptr;
+		route.output = static_cast<ma_uint32>(std::strtoul(entry.c_str(), &pos, 10));
+		if (pos == entry.c_str() || *pos != '=') return Error(std::format("Invalid route '{}'.", entry));
+		const char *input = pos + 1;
+		route.input = static_cast<ma_uint32>(std::strtoul(input, &pos, 10));
+		if (pos == input) return Error(std::format("Invalid route '{}'.", entry));
+		if (*pos == '*') {
+			const char *gain = pos + 1;
+			route.gain = std::strtof(gain, &pos);
+			if (pos == gain) return Error(std::format("Invalid route '{}'.", entry));
+		}
+		if (*pos != '\0') return Error(std::format("Invalid route '{}'.", entry));
+		if (route.input >= AudioRedirector::MaxChannels || route.output >= AudioRedirector::MaxChannels) {
+			return Error(std::format("Route '{}' is out of range; channels go up to {}.", entry, AudioRedirector::MaxChannels - 1));
+		}
+		routes.push_back(route);
+	}
+	return routes;
+}
+
+static Result<Options, Error> parse_options(int argc, char *argv[]) {
+	Options options;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const auto next = [&]() -> Result<std::string, Error> {
+			if (i + 1 >= argc) return Error(std::format("Missing value for {}.", arg));
+			return std::string(argv[++i]);
+		};
+
+		if (arg == "--list") {
+			options.list = true;
+		} else if (arg == "--limiter") {
+			options.limiter = true;
+		} else if (arg == "--no-limiter") {
+			options.limiter = false; // The default; kept for existing scripts
+		} else if (arg == "--tune-period") {
+			options.tunePeriod = true;
+		} else if (arg == "--help" || arg == "-h") {
+			print_usage();
+			std::exit(0);
+		} else {
+			auto value = next();
+			if (!value) return value.error();
+			const std::string &v = value.value();
+
+			if (arg == "--mode") {
+				if (v == "loopback") options.mode = Mode::Loopback;
+				else if (v == "duplex") options.mode = Mode::Duplex;
+				else return Error(std::format("Unknown mode '{}'.", v));
+			} else if (arg == "--source") {
+				options.source = v;
+			} else if (arg == "--playback") {
+				options.playback = v;
+			} else if (arg == "--format" && v == "auto") {
+				options.autoFormat = true;
+			} else if (arg == "--format" || arg == "--playback-format") {
+				const std::optional<ma_format> format = parse_format(v);
+				if (!format) return Error(std::format("Unknown format '{}'.", v));
+				(arg == "--format" ? options.format : options.playbackFormat) = format.value();
+			} else if (arg == "--rate") {
+				options.sampleRate = static_cast<ma_uint32>(std::strtoul(v.c_str(), nullptr, 10));
+				if (std::find(std::begin(AudioRedirector::SampleRates), std::end(AudioRedirector::SampleRates), options.sampleRate)
+					== std::end(AudioRedirector::SampleRates)) {
+					return Error(std::format("Unsupported sample rate '{}'.", v));
+				}
+			} else if (arg == "--channels" || arg == "--playback-channels") {
+				const ma_uint32 channels = static_cast<ma_uint32>(std::strtoul(v.c_str(), nullptr, 10));
+				if (channels == 0 || channels > AudioRedirector::MaxChannels) {
+					return Error(std::format("Unsupported channel count '{}'.", v));
+				}
+				(arg == "--channels" ? options.channels : options.playbackChannels) = channels;
+			} else if (arg == "--route") {
+				auto routes = parse_routes(v);
+				if (!routes) return routes.error();
+				options.routes = routes.value();
+			} else if (arg == "--gain") {
+				options.gain = std::strtof(v.c_str(), nullptr);
+				if (!(options.gain >= 0.0f)) return Error(std::format("Invalid gain '{}'.", v));
+			} else if (arg == "--latency") {
+				options.latencyMs = static_cast<ma_uint32>(std::strtoul(v.c_str(), nullptr, 10));
+			} else if (arg == "--resampler") {
+				if (v == "linear") options.resampler = ResamplerQuality::Linear;
+				else if (v == "low") options.resampler = ResamplerQuality::Low;
+				else if (v == "medium") options.resampler = ResamplerQuality::Medium;
+				else if (v == "high") options.resampler = ResamplerQuality::High;
+				else return Error(std::format("Unknown resampler '{}'.", v));
+			} else if (arg == "--period" || arg == "--periods") {
+				const ma_uint32 count = static_cast<ma_uint32>(std::strtoul(v.c_str(), nullptr, 10));
+				if (count == 0) return Error(std::format("Invalid value '{}' for {}.", v, arg));
+				(arg == "--period" ? options.period.periodSizeInFrames : options.period.periods) = count;
+			} else if (arg == "--profile") {
+				if (v == "low-latency") options.period.performanceProfile = ma_performance_profile_low_latency;
+				else if (v == "conservative") options.period.performanceProfile = ma_performance_profile_conservative;
+				else return Error(std::format("Unknown performance profile '{}'.", v));
+			} else if (arg == "--virtual") {
+				options.virtualScript = v;
+			} else if (arg == "--duration") {
+				options.durationSeconds = std::strtod(v.c_str(), nullptr);
+				if (!(options.durationSeconds > 0.0)) return Error(std::format("Invalid duration '{}'.", v));
+			} else if (arg == "--record") {
+				options.record = v;
+			} else if (arg == "--render") {
+				options.render = v;
+			} else if (arg == "--render-to") {
+				options.renderTo = v;
+			} else if (arg == "--switch-to") {
+				options.switchTo = v;
+			} else if (arg == "--switch-at") {
+				options.switchAtSeconds = std::strtod(v.c_str(), nullptr);
+				if (!(options.switchAtSeconds >= 0.0)) return Error(std::format("Invalid switch time '{}'.", v));
+			} else if (arg == "--crash-log") {
+				options.crashLog = v;
+			} else if (arg == "--measure-latency") {
+				options.measureMarkers = static_cast<ma_uint32>(std::strtoul(v.c_str(), nullptr, 10));
+				if (options.measureMarkers == 0) return Error(std::format("Invalid marker count '{}'.", v));
+			} else {
+				return Error(std::format("Unknown option '{}'.", arg));
+			}
+		}
+	}
+
+	if (options.render.has_value() != options.renderTo.has_value()) {
+		return Error("--render and --render-to go together.");
+	}
+	return options;
+}
+
+static std::string lowercase(std::string str) {
+	std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return str;
+}
+
+// Resolve a device query to an ID; nullptr (system default) for an empty query.
+static Result<const ma_device_id *, Error> find_device(const ma_device_info *infos, ma_uint32 count, const std::string &query) {
+	if (query.empty()) return static_cast<const ma_device_id *>(nullptr);
+
+	for (ma_uint32 i = 0; i < count; ++i) {
+		if (AudioRedirector::GetDeviceIdString(infos[i].id) == query) return &infos[i].id;
+	}
+
+	const std::string needle = lowercase(query);
+	for (ma_uint32 i = 0; i < count; ++i) {
+		if (lowercase(infos[i].name) == needle) return &infos[i].id;
+	}
+
+	char *end = nullptr;
+	const unsigned long index = std::strtoul(query.c_str(), &end, 10);
+	if (*end == '\0' && index < count) return &infos[index].id;
+
+	const ma_device_id *match = nullptr;
+	for (ma_uint32 i = 0; i < count; ++i) {
+		if (lowercase(infos[i].name).find(needle) == std::string::npos) continue;
+		if (match != nullptr) return Error(std::format("Device '{}' is ambiguous; use the full name or ID.", query));
+		match = &infos[i].id;
+	}
+	if (match == nullptr) return Error(std::format("No device matches '{}'.", query));
+	return match;
+}
+
+static void list_devices(const AudioDevices &devices) {
+	const auto print = [](const char *title, const ma_device_info *infos, ma_uint32 count) {
+		std::printf("%s:\n", title);
+		for (ma_uint32 i = 0; i < count; ++i) {
+			std::printf(
+				"  [%u]%s %s\n       %s\n", i, infos[i].isDefault ? " (default)" : "",
+				infos[i].name, AudioRedirector::GetDeviceIdString(infos[i].id).c_str()
+			);
+		}
+	};
+	print("Playback devices (loopback sources)", devices.playbackDeviceInfos, devices.playbackDeviceCount);
+	print("Capture devices", devices.captureDeviceInfos, devices.captureDeviceCount);
+}
+
+static void print_latency(const LatencyReport &report) {
+	std::printf("Markers: %u sent, %u detected\n", report.markersSent, report.markersDetected);
+	std::printf(
+		"Latency: min %.2f ms, mean %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+		report.minMs, report.meanMs, report.p50Ms, report.p95Ms, report.p99Ms, report.maxMs
+	);
+}
+
+static void print_stats(const char *name, const CallbackStats &stats) {
+	std::printf(
+		"%-8s %llu callbacks, DSP load %.1f%% (peak %.1f%%), duration p99 %.0f us (peak %.0f us), "
+		"interval %.2f ms (peak %.2f ms), %llu underruns (%llu frames), %llu overruns (%llu frames)\n",
+		name, (unsigned long long)stats.callbacks, stats.loadPercent, stats.peakLoadPercent,
+		stats.p99Micros, stats.peakMicros, stats.averageIntervalMicros / 1000.0, stats.peakIntervalMicros / 1000.0,
+		(unsigned long long)stats.underruns, (unsigned long long)stats.underrunFrames,
+		(unsigned long long)stats.overruns, (unsigned long long)stats.overrunFrames
+	);
+}
+
+static void print_tuning(const PeriodTuneReport &report) {
+	std::printf("%-10s %9s %9s %7s  %s\n", "Requested", "Playback", "Capture", "Xruns", "Result");
+	for (const PeriodTrial &trial : report.trials) {
+		const char *verdict = trial.stable ? "stable" : trial.failed ? "device failed" : trial.late ? "late callbacks" : "xruns";
+		std::printf(
+			"%-10s %9u %9u %7llu  %s\n",
+			trial.requestedFrames == 0 ? "default" : std::to_string(trial.requestedFrames).c_str(),
+			trial.playbackFrames, trial.captureFrames, (unsigned long long)trial.xruns, verdict
+		);
+	}
+
+	const PeriodConfig &config = report.config;
+	std::string flags;
+	if (config.periodSizeInFrames != 0) flags += std::format(" --period {}", config.periodSizeInFrames);
+	if (config.periods != 0) flags += std::format(" --periods {}", config.periods);
+	if (config.performanceProfile == ma_performance_profile_conservative) flags += " --profile conservative";
+	std::printf(
+		"Kept %s. Start with the same devices and%s to skip tuning.\n",
+		config.periodSizeInFrames == 0 ? "the backend default period" : std::format("a {} frame period", config.periodSizeInFrames).c_str(),
+		flags.empty() ? " no period options" : flags.c_str()
+	);
+	std::fflush(stdout);
+}
+
+static const char *resampler_name(ResamplerQuality quality) {
+	switch (quality) {
+		case ResamplerQuality::Low: return "low quality sinc";
+		case ResamplerQuality::Medium: return "medium quality sinc";
+		case ResamplerQuality::High: return "high quality sinc";
+		default: return "linear";
+	}
+}
+
+static void print_conversions(const RouteConversions &conversions) {
+	// Capture converts from the device format to the redirect's, playback the other way.
+	const auto print = [](const char *name, const StreamConversion &stream, bool capture) {
+		const auto step = [capture](auto device, auto redirect) {
+			return capture ? std::format("{} -> {}", device, redirect) : std::format("{} -> {}", redirect, device);
+		};
+		std::string active;
+		if (stream.convertsFormat) active += ", format " + step(ma_get_format_name(stream.deviceFormat), ma_get_format_name(stream.format));
+		if (stream.convertsChannels) active += ", channels " + step(stream.deviceChannels, stream.channels);
+		if (stream.resamples) {
+			active += std::format(", resampling {} Hz ({})", step(stream.deviceSampleRate, stream.sampleRate), resampler_name(stream.resampler));
+		}
+		std::printf(
+			"  %-9s device %s, %u ch, %u Hz%s\n", name, ma_get_format_name(stream.deviceFormat), stream.deviceChannels,
+			stream.deviceSampleRate, active.empty() ? ", no conversion" : active.c_str()
+		);
+	};
+
+	std::printf("Formats (%s):\n", conversions.negotiated ? "negotiated" : "from the settings");
+	print("Capture:", conversions.capture, true);
+	print("Playback:", conversions.playback, false);
+	if (conversions.convertsSamples) {
+		std::printf("  The redirect converts the samples itself: %s in, %s out.\n",
+			ma_get_format_name(conversions.capture.format), ma_get_format_name(conversions.playback.format));
+	}
+	if (conversions.routing != nullptr && std::string_view(conversions.routing) != "identity") {
+		std::printf("  Channels routed %u -> %u (%s matrix).\n",
+			conversions.capture.channels, conversions.playback.channels, conversions.routing);
+	}
+	std::fflush(stdout);
+}
+
+static void print_switch(const SwitchReport &report) {
+	std::printf(
+		"Switched output: new device ready after %.1f ms, %.0f ms crossfade, %.1f ms overlap, %.1f ms gap\n",
+		report.prepareMs, report.crossfadeMs, report.overlapMs, report.gapMs
+	);
+	std::fflush(stdout);
+}
+
+static void print_recovery(const RecoveryStats &stats) {
+	std::printf(
+		"Recovery: %u device losses, %u stalls, %u reroutes, %u recoveries (last %.1f ms, max %.1f ms), %u failed attempts%s\n",
+		stats.deviceLosses, stats.stalls, stats.reroutes, stats.recoveries, stats.lastRecoveryMs, stats.maxRecoveryMs,
+		stats.failedAttempts, stats.recovering ? ", still recovering" : ""
+	);
+}
+
+static void print_recording(const RecordingStats &stats) {
+	std::printf(
+		"Recording: %llu frames written, %llu dropped, buffer peak %.1f%%%s\n",
+		(unsigned long long)stats.framesWritten, (unsigned long long)stats.framesDropped, stats.bufferPeakPercent,
+		stats.failed ? ", a write failed" : ""
+	);
+}
+
+static void print_render(const RenderReport &report) {
+	std::printf(
+		"Input: %s, %u ch, %u Hz, %llu frames%s\n", ma_get_format_name(report.inputFormat), report.inputChannels,
+		report.inputSampleRate, (unsigned long long)report.framesIn, report.convertsInput ? ", converted to the capture side" : ""
+	);
+	std::printf(
+		"Pipeline: %s, %u ch in, %s, %u ch out, %u Hz, %u frame periods\n", ma_get_format_name(report.format), report.channels,
+		ma_get_format_name(report.playbackFormat), report.playbackChannels, report.sampleRate, report.periodFrames
+	);
+	std::printf(
+		"Rendered %.1f s of audio in %.3f s (%.0fx real time), %.3f s of it in the callbacks.\n",
+		(double)report.framesOut / report.sampleRate, report.totalSeconds, report.realtimeFactor, report.callbackSeconds
+	);
+}
+
+static void apply_settings(const Options &options) {
+	AudioRedirector::SetLimiterEnabled(options.limiter);
+
+	if (options.mode == Mode::Loopback) {
+		if (options.format != ma_format_unknown) AudioRedirector::SetLoopbackFormat(options.format);
+		if (options.playbackFormat != ma_format_unknown) AudioRedirector::SetLoopbackPlaybackFormat(options.playbackFormat);
+		if (options.sampleRate != 0) AudioRedirector::SetLoopbackSampleRate(options.sampleRate);
+		if (options.channels != 0) AudioRedirector::SetLoopbackChannels(options.channels);
+		if (options.playbackChannels != 0) AudioRedirector::SetLoopbackPlaybackChannels(options.playbackChannels);
+		AudioRedirector::SetLoopbackRouting(options.routes);
+		AudioRedirector::SetLoopbackAutoFormat(options.autoFormat);
+		if (options.latencyMs != 0) AudioRedirector::SetLoopbackLatency(options.latencyMs);
+		AudioRedirector::SetLoopbackResampler(options.resampler);
+		AudioRedirector::SetLoopbackPeriodConfig(options.period);
+		AudioRedirector::SetPlaybackVolume(options.gain);
+	} else {
+		if (options.format != ma_format_unknown) AudioRedirector::SetDuplexFormat(options.format);
+		if (options.playbackFormat != ma_format_unknown) AudioRedirector::SetDuplexPlaybackFormat(options.playbackFormat);
+		if (options.sampleRate != 0) AudioRedirector::SetDuplexSampleRate(options.sampleRate);
+		if (options.channels != 0) AudioRedirector::SetDuplexChannels(options.channels);
+		if (options.playbackChannels != 0) AudioRedirector::SetDuplexPlaybackChannels(options.playbackChannels);
+		AudioRedirector::SetDuplexRouting(options.routes);
+		AudioRedirector::SetDuplexAutoFormat(options.autoFormat);
+		AudioRedirector::SetDuplexResampler(options.resampler);
+		AudioRedirector::SetDuplexPeriodConfig(options.period);
+		AudioRedirector::SetDuplexVolume(options.gain);
+	}
+}
+
+static int fail(const Error &error) {
+	std::fprintf(stderr, "error: %s\n", error.message.c_str());
+	return 1;
+}
+
+int main(int argc, char *argv[]) {
+	const Clock::time_point processStart = Clock::now();
+
+	auto parsed = parse_options(argc, argv);
+	if (!parsed) {
+		fail(parsed.error());
+		print_usage();
+		return 2;
+	}
+	const Options &options = parsed.value();
+
+	if (options.crashLog) {
+		const ResultVoid installed = AudioRedirector::InstallCrashHandler(options.crashLog.value());
+		if (!installed) return fail(installed.error());
+	}
+
+	// Offline rendering needs no devices, so no context either.
+	if (options.render) {
+		apply_settings(options);
+		auto report = options.mode == Mode::Loopback
+			? AudioRedirector::RenderLoopbackFile(options.render.value(), options.renderTo.value())
+			: AudioRedirector::RenderDuplexFile(options.render.value(), options.renderTo.value());
+		if (!report) return fail(report.error());
+		print_render(report.value());
+		return 0;
+	}
+
+	// The script is copied when the context initializes.
+	VirtualBackend::Script script;
+	ResultVoid result = std::monostate{};
+	if (options.virtualScript) {
+		if (options.virtualScript.value() == "default") {
+			script = VirtualBackend::DefaultScript();
+		} else {
+			auto parsedScript = VirtualBackend::ParseScript(options.virtualScript.value());
+			if (!parsedScript) return fail(parsedScript.error());
+			script = parsedScript.value();
+		}
+		const ma_backend backend = ma_backend_custom;
+		const ma_context_config config = VirtualBackend::ContextConfig(&script);
+		result = AudioRedirector::Initialize(&backend, 1, &config);
+	} else {
+		result = AudioRedirector::Initialize();
+	}
+	if (!result) return fail(result.error());
+	const double contextMs = ms_since(processStart);
+
+	auto devicesResult = AudioRedirector::GetAudioDevices();
+	if (!devicesResult) return fail(devicesResult.error());
+	const AudioDevices &devices = devicesResult.value();
+
+	if (options.list) {
+		list_devices(devices);
+		AudioRedirector::Uninitialize();
+		return 0;
+	}
+
+	const bool loopback = options.mode == Mode::Loopback;
+
+	// Loopback captures what a playback device renders, so its source is a playback device.
+	auto sourceId = loopback
+		? find_device(devices.playbackDeviceInfos, devices.playbackDeviceCount, options.source)
+		: find_device(devices.captureDeviceInfos, devices.captureDeviceCount, options.source);
+	if (!sourceId) return fail(sourceId.error());
+
+	auto playbackId = find_device(devices.playbackDeviceInfos, devices.playbackDeviceCount, options.playback);
+	if (!playbackId) return fail(playbackId.error());
+
+	auto switchId = find_device(devices.playbackDeviceInfos, devices.playbackDeviceCount, options.switchTo.value_or(""));
+	if (!switchId) return fail(switchId.error());
+
+	// --- Apply settings ---
+	apply_settings(options);
+
+	if (options.measureMarkers != 0) {
+		if (!loopback) {
+			AudioRedirector::Uninitialize();
+			return fail(Error("--measure-latency measures the loopback path; use --mode loopback."));
+		}
+		auto report = AudioRedirector::MeasureLoopbackLatency(sourceId.value(), playbackId.value(), options.measureMarkers);
+		AudioRedirector::Uninitialize();
+		if (!report) return fail(report.error());
+		print_latency(report.value());
+		return 0;
+	}
+
+	std::signal(SIGINT, on_signal);
+	std::signal(SIGTERM, on_signal);
+#ifdef SIGBREAK
+	std::signal(SIGBREAK, on_signal);
+#endif
+
+	// --- Start and time the first audible frame ---
+	result = loopback
+		? AudioRedirector::StartLoopbackRedirect(sourceId.value(), playbackId.value())
+		: AudioRedirector::StartDuplexRedirect(sourceId.value(), playbackId.value());
+	if (!result) {
+		AudioRedirector::Uninitialize();
+		return fail(result.error());
+	}
+	const double startMs = ms_since(processStart);
+
+	// On VirtualBackend's manual clock ("speed manual") the waits below drive the clock themselves.
+	const bool manualClock = VirtualBackend::IsManual(AudioRedirector::GetContext());
+	const auto framesPlayed = loopback ? AudioRedirector::GetLoopbackFramesPlayed : AudioRedirector::GetDuplexFramesPlayed;
+	double firstAudioMs = -1.0;
+	while (!g_stop.load() && ms_since(processStart) < 10000.0) {
+		if (framesPlayed() > 0) {
+			firstAudioMs = ms_since(processStart);
+			break;
+		}
+		if (manualClock) VirtualBackend::Advance(AudioRedirector::GetContext(), 0.001);
+		else std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+
+	std::printf(
+		"Redirecting (%s). Startup: context %.1f ms, devices started %.1f ms, first audio %s\n",
+		loopback ? "loopback" : "duplex", contextMs, startMs,
+		firstAudioMs < 0.0 ? "not yet" : std::format("{:.1f} ms", firstAudioMs).c_str()
+	);
+	if (loopback) {
+		std::printf("First audio includes the %u ms jitter buffer pre-roll.\n", AudioRedirector::GetLoopbackLatency());
+	}
+	const RedirectorStats started = AudioRedirector::GetStats();
+	std::printf(
+		"Device period: %u frames playback, %u frames capture.\n",
+		loopback ? started.loopbackPlayback.periodFrames : started.duplex.periodFrames,
+		loopback ? started.loopbackCapture.periodFrames : started.duplex.periodFrames
+	);
+
+	print_conversions(loopback ? AudioRedirector::GetLoopbackConversions() : AudioRedirector::GetDuplexConversions());
+
+	if (options.record) {
+		result = loopback
+			? AudioRedirector::StartLoopbackRecording(options.record.value())
+			: AudioRedirector::StartDuplexRecording(options.record.value());
+		if (result) std::printf("Recording to %s.\n", options.record.value().c_str());
+		else fail(result.error());
+	}
+
+	if (options.tunePeriod) {
+		auto report = loopback ? AudioRedirector::TuneLoopbackPeriod() : AudioRedirector::TuneDuplexPeriod();
+		if (report) print_tuning(report.value());
+		else fail(report.error());
+	}
+
+	std::printf("Press Ctrl+C to stop.\n");
+	std::fflush(stdout);
+
+	// Pipeline time is the virtual clock on VirtualBackend, which may run far ahead of the wall clock.
+	const bool isVirtual = options.virtualScript.has_value();
+	const Clock::time_point runStart = Clock::now();
+	const auto pipelineSeconds = [&]() {
+		return isVirtual ? VirtualBackend::GetTimeSeconds(AudioRedirector::GetContext()) : ms_since(runStart) / 1000.0;
+	};
+
+	const auto recoveryStats = [&]() {
+		const RedirectorStats stats = AudioRedirector::GetStats();
+		return loopback ? stats.loopbackRecovery : stats.duplexRecovery;
+	};
+
+	bool switchPending = options.switchTo.has_value();
+	bool recovering = false;
+	while (!g_stop.load() && (options.durationSeconds == 0.0 || pipelineSeconds() < options.durationSeconds)) {
+		const RecoveryStats recovery = recoveryStats();
+		if (recovery.recovering != recovering) {
+			recovering = recovery.recovering;
+			if (recovering) std::printf("Redirect lost at %.3f s; reopening.\n", pipelineSeconds());
+			else std::printf("Recovered in %.1f ms.\n", recovery.lastRecoveryMs);
+			std::fflush(stdout);
+		}
+
+		if (switchPending && pipelineSeconds() >= options.switchAtSeconds) {
+			switchPending = false;
+			auto report = loopback
+				? AudioRedirector::SwitchLoopbackOutput(switchId.value())
+				: AudioRedirector::SwitchDuplexOutput(switchId.value());
+			if (report) print_switch(report.value());
+			else fail(report.error());
+		}
+
+		if (manualClock) {
+			// Advance() returns at once when no device is running (e.g. after a scripted loss).
+			const double now = pipelineSeconds();
+			double step = options.durationSeconds == 0.0 ? 1.0 : options.durationSeconds - now;
+			if (switchPending) step = std::min(step, std::max(options.switchAtSeconds - now, 0.001));
+			if (VirtualBackend::Advance(AudioRedirector::GetContext(), std::min(1.0, step)) <= now) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		} else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(isVirtual ? 1 : 100));
+		}
+	}
+
+	const double wallSeconds = ms_since(runStart) / 1000.0;
+	const double ranSeconds = pipelineSeconds();
+	const ma_uint64 periods = VirtualBackend::GetPeriodCount(AudioRedirector::GetContext());
+
+	if (options.record) {
+		result = loopback ? AudioRedirector::StopLoopbackRecording() : AudioRedirector::StopDuplexRecording();
+		if (!result) fail(result.error());
+	}
+	result = loopback ? AudioRedirector::StopLoopbackRedirect() : AudioRedirector::StopDuplexRedirect();
+	if (!result) fail(result.error());
+
+	// Wall-clock timings; on VirtualBackend the intervals reflect the simulation speed.
+	const RedirectorStats stats = AudioRedirector::GetStats();
+	if (loopback) {
+		print_stats("Capture:", stats.loopbackCapture);
+		print_stats("Playback:", stats.loopbackPlayback);
+	} else {
+		print_stats("Duplex:", stats.duplex);
+	}
+	print_recovery(loopback ? stats.loopbackRecovery : stats.duplexRecovery);
+	if (options.record) {
+		print_recording(loopback ? AudioRedirector::GetLoopbackRecordingStats() : AudioRedirector::GetDuplexRecordingStats());
+	}
+
+	if (isVirtual) {
+		std::printf(
+			"Ran %.1f s of pipeline time in %.2f s (%.0fx real time): %llu device periods, %llu frames played.\n",
+			ranSeconds, wallSeconds, wallSeconds > 0.0 ? ranSeconds / wallSeconds : 0.0,
+			(unsigned long long)periods, (unsigned long long)framesPlayed()
+		);
+	}
+
+	result = AudioRedirector::Uninitialize();
+	if (!result) return fail(result.error());
+	return 0;
+}
@@ -1,16 +1,32 @@
 #include <QApplication>
+#include <QDir>
 #include <QFile>
+#include <QStandardPaths>
 #include <QLoggingCategory>
 
 #include <dwmapi.h>
 #pragma comment(lib, "Dwmapi.lib")
 
 #include "MainWindow.hpp"
+#include "AudioRedirector.hpp"
+#include "Log.hpp"
 
 int main(int argc, char *argv[]) {
 	QLoggingCategory::setFilterRules("*.debug=false\n*.warning=false");
 
 	QApplication app(argc, argv);
+	QApplication::setOrganizationName("AudioRedirector"); // QSettings location (device cache)
+	QApplication::setApplicationName("AudioRedirector");
+
+	// An absolute path in the app's local data folder, whatever the working directory: the
+	// crash handler keeps the file open and cannot build a path itself.
+	const QString crashDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+	QDir().mkpath(crashDir);
+	const std::string crashPath = QDir::toNativeSeparators(QDir(crashDir).filePath("crash.txt")).toLocal8Bit().toStdString();
+	if (const auto installed = AudioRedirector::InstallCrashHandler(crashPath); !installed) {
+		Log::Warning("{}", installed.error().message);
+	}
+
 	MainWindow window;
 	window.setWindowTitle("Audio Redirector");
 	window.setWindowIcon(QIcon(":/icons/app.ico"));
@@ -5,7 +5,7 @@
 Error::Error(const std::string &msg, const std::string &traceback)
     : message(msg), traceback(traceback) {}
 
-Error::Error(const std::string &msg, source_location loc)
+Error::Error(const std::string &msg, std::source_location loc)
     : message(msg)
 {
     std::ostringstream oss;
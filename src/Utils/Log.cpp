@@ -1,54 +1,335 @@
 #include "Log.hpp"
 #include <ctime>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
-#include <fstream>
-#include <filesystem>
+#include <cstdio>
+#include <atomic>
+#include <thread>
 #include <mutex>
+#include <string_view>
+#include <filesystem>
+#include <system_error>
 
-// Log to file "log.txt" by default.
-std::string g_logFilepath = "log.txt";
-// Mutex for thread-safe logging
-std::mutex g_logMutex;
+namespace {
+	struct Node {
+		std::atomic<Node *> next = nullptr;
+		Log::Level level = Log::Level::Info;
+		std::time_t time = 0; // When the message was logged, not when it was written
+		std::string message;
+	};
 
-void Log::SetLogFile(const std::string &filepath) {
-	g_logFilepath = filepath;
+	// Intrusive multi-producer single-consumer queue (Vyukov). A push is one atomic exchange,
+	// so callers never wait on each other or on the writer.
+	class MpscQueue {
+	public:
+		MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+		void Push(Node *node) {
+			node->next.store(nullptr, std::memory_order_relaxed);
+			Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		// Consumer only. Returns nullptr when empty, or while a push is between its two steps;
+		// that message shows up on the next call.
+		Node *Pop() {
+			Node *tail = m_tail;
+			Node *next = tail->next.load(std::memory_order_acquire);
+
+			if (tail == &m_stub) {
+				if (next == nullptr) return nullptr;
+				m_tail = next;
+				tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+			if (next != nullptr) {
+				m_tail = next;
+				return tail;
+			}
+			if (tail != m_head.load(std::memory_order_acquire)) return nullptr;
+
+			// The last node can only be handed out with the stub queued behind it.
+			Push(&m_stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next == nullptr) return nullptr;
+			m_tail = next;
+			return tail;
+		}
+
+	private:
+		std::atomic<Node *> m_head;
+		Node *m_tail;
+		Node m_stub;
+	};
+
+	// Background writer: drains the queue in batches into a file it keeps open (the console in
+	// debug builds), rotating the file by size.
+	class Writer {
+	public:
+		Writer() : m_thread(&Writer::run, this) {}
+		~Writer();
+
+		void Post(Log::Level level, std::string message);
+		void Flush();
+
+		void SetFile(const std::string &filepath);
+		void SetRotation(std::uintmax_t maxBytes, unsigned keepFiles);
+
+	private:
+		void run();
+		void drain();
+		void append(const Node &node);
+		void open();
+		void rotate();
+		const std::string &timestamp(std::time_t time);
+
+		MpscQueue m_queue;
+		std::atomic<std::uint64_t> m_posted = 0;  // Also what the writer waits on
+		std::atomic<std::uint64_t> m_written = 0; // What Flush() waits on
+		std::atomic<bool> m_quit = false;
+
+		std::mutex m_configMutex;
+		std::string m_filepath = "log.txt"; // Log to file "log.txt" by default.
+		std::uintmax_t m_maxBytes = 1 << 20;
+		unsigned m_keepFiles = 3;
+		std::atomic<bool> m_reopen = true;
+
+		// Writer thread only
+		std::FILE *m_file = nullptr;
+		std::uintmax_t m_fileBytes = 0;
+		std::string m_batch;
+		std::time_t m_stampTime = -1;
+		std::string m_stamp;
+
+		std::thread m_thread; // Last: starts once everything above is constructed
+	};
+
+	Writer &writer() {
+		static Writer instance;
+		return instance;
+	}
+
+	std::string format_timestamp(std::time_t time) {
+		std::tm localTime{};
+
+#if defined(_WIN32) || defined(_WIN64)
+		// Windows: secure version
+		localtime_s(&localTime, &time);
+#else
+		// POSIX: thread-safe version
+		localtime_r(&time, &localTime);
+#endif
+
+		char buffer[32];
+		const size_t length = std::strftime(buffer, sizeof(buffer), "%d-%m-%Y %H:%M:%S", &localTime);
+		return std::string(buffer, length);
+	}
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+Writer::~Writer() {
+	m_quit.store(true, std::memory_order_release);
+	m_posted.fetch_add(1, std::memory_order_release);
+	m_posted.notify_one();
+	m_thread.join();
+
+	if (m_file != nullptr) std::fclose(m_file);
+}
+
+void Writer::Post(Log::Level level, std::string message) {
+	Node *node = new Node;
+	node->level = level;
+	node->time = std::time(nullptr);
+	node->message = std::move(message);
+
+	m_queue.Push(node);
+	m_posted.fetch_add(1, std::memory_order_release);
+	m_posted.notify_one();
+}
+
+void Writer::Flush() {
+	const std::uint64_t target = m_posted.load(std::memory_order_acquire);
+
+	for (std::uint64_t written = m_written.load(std::memory_order_acquire); written < target;) {
+		m_written.wait(written, std::memory_order_acquire);
+		written = m_written.load(std::memory_order_acquire);
+	}
 }
 
-void Log::private_::LogMessage(Level level, const std::string &message) {
-	std::string levelStr = GetLevelString(level);
-	// Lock mutex before IO to avoid race conditions
-	std::lock_guard<std::mutex> lock(g_logMutex);
+void Writer::SetFile(const std::string &filepath) {
+	std::lock_guard lock(m_configMutex);
+	m_filepath = filepath;
+	m_reopen.store(true, std::memory_order_release); // Messages already queued go to the new file
+}
+
+void Writer::SetRotation(std::uintmax_t maxBytes, unsigned keepFiles) {
+	std::lock_guard lock(m_configMutex);
+	m_maxBytes = maxBytes;
+	m_keepFiles = keepFiles;
+}
+
+void Writer::run() {
+	while (true) {
+		const std::uint64_t seen = m_posted.load(std::memory_order_acquire);
+		drain();
+
+		if (m_quit.load(std::memory_order_acquire)) {
+			drain(); // Whatever was logged up to the exit
+			return;
+		}
+		m_posted.wait(seen, std::memory_order_acquire);
+	}
+}
+
+// Everything queued goes out as one write and one flush.
+void Writer::drain() {
+	std::uint64_t count = 0;
+	m_batch.clear();
+
+	// A push caught between its two steps hides the messages behind it until it completes; its
+	// count goes up after that, which wakes run() for another pass.
+	for (Node *node = m_queue.Pop(); node != nullptr; node = m_queue.Pop()) {
+		append(*node);
+		delete node;
+		++count;
+	}
+	if (count == 0) return;
 
 #ifndef NDEBUG
-	std::ostream &outStream = (level == Level::Error || level == Level::Fatal) ? std::cerr : std::cout;
-	std::ostringstream oss;
-	oss << "[" << levelStr << "] " << message;
-	outStream << oss.str() << '\n'; // write to console
+	std::fwrite(m_batch.data(), 1, m_batch.size(), stdout);
+	std::fflush(stdout);
 #else
-	const std::string timestamp = GetTimestamp();
-	std::ofstream logFile(g_logFilepath, std::ios::app);
+	if (m_reopen.exchange(false, std::memory_order_acq_rel)) open();
+	if (m_file != nullptr) {
+		std::fwrite(m_batch.data(), 1, m_batch.size(), m_file);
+		std::fflush(m_file);
+		m_fileBytes += m_batch.size();
+		rotate();
+	}
+#endif
+
+	m_written.fetch_add(count, std::memory_order_release);
+	m_written.notify_all();
+}
 
-	std::string msg; // token
+void Writer::append(const Node &node) {
+	const std::string level = Log::private_::GetLevelString(node.level);
+
+#ifndef NDEBUG
+	m_batch += '[';
+	m_batch += level;
+	m_batch += "] ";
+	m_batch += node.message;
+	m_batch += '\n';
+#else
+	const std::string &stamp = timestamp(node.time);
 	bool timestampAdded = false;
-	std::istringstream iss(message);
 
-	while (std::getline(iss, msg, '\n')) {
-		if (msg.empty()) continue;
+	std::string_view rest = node.message;
+	while (!rest.empty()) {
+		const size_t end = rest.find('\n');
+		const std::string_view line = rest.substr(0, end);
+		rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+		if (line.empty()) continue;
 
 		if (!timestampAdded) {
-			logFile << "[" << timestamp << "] " << levelStr << ": " << msg << '\n';
+			m_batch += '[';
+			m_batch += stamp;
+			m_batch += "] ";
+			m_batch += level;
+			m_batch += ": ";
 			timestampAdded = true;
-			continue;
+		} else {
+			// Align continuation lines; 3 => 2 for brackets + 1 for space
+			m_batch.append(stamp.size() + 3, ' ');
 		}
-		// Align continuation lines; 3 => 2 for brackets + 1 for space
-		std::string spacing = std::string(timestamp.size() + 3, ' ');
-		logFile << spacing << msg << '\n';
+		m_batch += line;
+		m_batch += '\n';
 	}
 #endif
 }
 
+// Formatting the local time is the costly part of a line, and it only changes once a second.
+const std::string &Writer::timestamp(std::time_t time) {
+	if (time != m_stampTime) {
+		m_stamp = format_timestamp(time);
+		m_stampTime = time;
+	}
+	return m_stamp;
+}
+
+void Writer::open() {
+	if (m_file != nullptr) std::fclose(m_file);
+
+	std::string filepath;
+	{
+		std::lock_guard lock(m_configMutex);
+		filepath = m_filepath;
+	}
+
+	m_file = std::fopen(filepath.c_str(), "ab");
+	std::error_code error;
+	const std::uintmax_t size = std::filesystem::file_size(filepath, error);
+	m_fileBytes = error ? 0 : size;
+}
+
+// log.txt -> log.1.txt -> log.2.txt ...; the oldest beyond keepFiles is removed.
+void Writer::rotate() {
+	std::string filepath;
+	std::uintmax_t maxBytes;
+	unsigned keepFiles;
+	{
+		std::lock_guard lock(m_configMutex);
+		filepath = m_filepath;
+		maxBytes = m_maxBytes;
+		keepFiles = m_keepFiles;
+	}
+	if (maxBytes == 0 || m_fileBytes < maxBytes) return;
+
+	std::fclose(m_file);
+	m_file = nullptr;
+
+	const std::filesystem::path path(filepath);
+	const auto numbered = [&](unsigned n) {
+		std::filesystem::path name = path;
+		name.replace_extension(std::to_string(n) + path.extension().string());
+		return name;
+	};
+
+	std::error_code error;
+	if (keepFiles == 0) {
+		std::filesystem::remove(path, error);
+	} else {
+		std::filesystem::remove(numbered(keepFiles), error);
+		for (unsigned n = keepFiles; n > 1; --n) {
+			std::filesystem::rename(numbered(n - 1), numbered(n), error);
+		}
+		std::filesystem::rename(path, numbered(1), error);
+	}
+	open();
+}
+
+// ============================================================================
+// Log
+// ============================================================================
+
+void Log::SetLogFile(const std::string &filepath) {
+	writer().SetFile(filepath);
+}
+
+void Log::SetRotation(std::uintmax_t maxBytes, unsigned keepFiles) {
+	writer().SetRotation(maxBytes, keepFiles);
+}
+
+void Log::Flush() {
+	writer().Flush();
+}
+
+void Log::private_::LogMessage(Level level, std::string message) {
+	writer().Post(level, std::move(message));
+}
+
 std::string Log::private_::GetLevelString(Level level) {
 	switch (level) {
 		case Level::Debug:
@@ -67,32 +348,17 @@ std::string Log::private_::GetLevelString(Level level) {
 }
 
 std::string Log::private_::GetTimestamp() {
-	std::time_t now = std::time(nullptr);
-	std::tm localTime{};
-
-#if defined(_WIN32) || defined(_WIN64)
-	// Windows: secure version
-	localtime_s(&localTime, &now);
-#else
-	// POSIX: thread-safe version
-	localtime_r(&now, &localTime);
-#endif
-
-	std::ostringstream oss;
-	oss << std::put_time(&localTime, "%d-%m-%Y %H:%M:%S");
-	return oss.str();
+	return format_timestamp(std::time(nullptr));
 }
 
 void Log::private_::LogWithTracebackImpl(
 	const char *file, int line, const char *func, Level level, const std::string &message
 ) {
-	std::ostringstream oss;
 #ifndef NDEBUG
-	oss << message << "\nTraceback: " << file << ":" << line << " in function: " << func;
+	const std::string_view filename = file;
 #else
-	std::filesystem::path p(file);
-	std::string filename = p.filename().string();
-	oss << message << "\nTraceback: " << filename << ":" << line << " in function: " << func;
+	std::string_view filename = file;
+	filename = filename.substr(filename.find_last_of("/\\") + 1); // npos + 1 == 0
 #endif
-	LogMessage(level, oss.str());
+	LogMessage(level, std::format("{}\nTraceback: {}:{} in function: {}", message, filename, line, func));
 }
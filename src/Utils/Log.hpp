@@ -2,6 +2,7 @@
 #include <string>
 #include <format>
 #include <codecvt>
+#include <cstdint>
 
 namespace Log {
 	enum class Level
@@ -14,13 +15,22 @@ namespace Log {
 	};
 
 	namespace private_ {
-		void LogMessage(Level level, const std::string &message);
+		void LogMessage(Level level, std::string message); // Queues it for the writer thread
 		std::string GetLevelString(Level level);
 		std::string GetTimestamp(); // Get local time stamp
 	} // namespace private_
 
 	void SetLogFile(const std::string &filepath);
 
+	// Once the log file grows past maxBytes it becomes <name>.1<ext>, the older ones move up by
+	// one and only keepFiles of them are kept; checked after each batch the writer thread writes.
+	// maxBytes 0 never rotates. Default: 1 MiB, 3 files.
+	void SetRotation(std::uintmax_t maxBytes, unsigned keepFiles);
+
+	// Messages are written by a background thread; this blocks until everything logged so far
+	// has been written.
+	void Flush();
+
 	template <typename... Args>
 	static void Debug(std::format_string<Args...> fmtStr, Args &&...args) {
 #ifndef NDEBUG
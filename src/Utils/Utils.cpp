@@ -5,6 +5,7 @@
 #include <shellapi.h>
 #include <functiondiscoverykeys_devpkey.h>
 #include <wrl/client.h> // For Microsoft::WRL::ComPtr
+#include <mutex>
 
 using Microsoft::WRL::ComPtr;
 
@@ -14,11 +15,14 @@ struct PropVariantRII {
 	~PropVariantRII() { PropVariantClear(&var); }
 };
 
-Result<std::wstring, Error> Utils::GetDeviceIconPath(const wchar_t *deviceId) {
-	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> pEnum;
-	HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(&pEnum));
-	if (FAILED(hr)) {
-		return WinErr(hr, "Failed to create IMMDeviceEnumerator");
+Result<std::wstring, Error> Utils::GetDeviceIconPath(const wchar_t *deviceId, IMMDeviceEnumerator *pSharedEnum) {
+	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> pEnum = pSharedEnum;
+	HRESULT hr = S_OK;
+	if (!pEnum) {
+		hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(&pEnum));
+		if (FAILED(hr)) {
+			return WinErr(hr, "Failed to create IMMDeviceEnumerator");
+		}
 	}
 
 	Microsoft::WRL::ComPtr<IMMDevice> pDevice;
@@ -61,3 +65,83 @@ HICON Utils::ExtractDeviceIcon(const std::wstring &iconPath) {
 	ExtractIconExW(file.c_str(), resourceId, nullptr, &hIcon, 1);
 	return hIcon;
 }
+
+// ============================================================================
+// DeviceWatcher
+// ============================================================================
+
+class Utils::DeviceWatcher::Client : public IMMNotificationClient {
+public:
+	explicit Client(std::function<void()> onChange) : m_onChange(std::move(onChange)) {}
+
+	// --- IUnknown ---
+	ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&m_refs); }
+
+	ULONG STDMETHODCALLTYPE Release() override {
+		const ULONG refs = InterlockedDecrement(&m_refs);
+		if (refs == 0) delete this;
+		return refs;
+	}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppv) override {
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient)) {
+			*ppv = static_cast<IMMNotificationClient *>(this);
+			AddRef();
+			return S_OK;
+		}
+		*ppv = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	// --- IMMNotificationClient ---
+	HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override { return notify(); }
+	HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override { return notify(); }
+	HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override { return notify(); }
+	HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow, ERole role, LPCWSTR) override {
+		// Fired once per role; the console role is the one miniaudio reports as default.
+		return role == eConsole ? notify() : S_OK;
+	}
+	HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY key) override {
+		// Endpoints change other properties all the time; only names and icons are shown.
+		const bool shown = IsEqualPropertyKey(key, PKEY_Device_FriendlyName) || IsEqualPropertyKey(key, PKEY_DeviceClass_IconPath);
+		return shown ? notify() : S_OK;
+	}
+
+	// A notification may already be on its way in; after this it does nothing.
+	void Detach() {
+		std::lock_guard lock(m_mutex);
+		m_onChange = nullptr;
+	}
+
+private:
+	HRESULT notify() {
+		std::lock_guard lock(m_mutex);
+		if (m_onChange) m_onChange();
+		return S_OK;
+	}
+
+	std::mutex m_mutex;
+	std::function<void()> m_onChange;
+	LONG m_refs = 1;
+};
+
+Utils::DeviceWatcher::DeviceWatcher(std::function<void()> onChange) {
+	HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(&m_enum));
+	if (FAILED(hr)) return; // No notifications; the device list only refreshes on request
+
+	m_client = new Client(std::move(onChange));
+	hr = m_enum->RegisterEndpointNotificationCallback(m_client);
+	if (FAILED(hr)) {
+		m_client->Release();
+		m_client = nullptr;
+	}
+}
+
+Utils::DeviceWatcher::~DeviceWatcher() {
+	if (m_client) {
+		m_client->Detach();
+		m_enum->UnregisterEndpointNotificationCallback(m_client);
+		m_client->Release();
+	}
+	if (m_enum) m_enum->Release();
+}
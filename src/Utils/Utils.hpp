@@ -1,11 +1,32 @@
 #pragma once
 #include <string>
+#include <functional>
 #include <Windows.h>
 
 #include "Result.hpp"
 #include "Error.hpp"
 
+struct IMMDeviceEnumerator;
+
 namespace Utils {
-	Result<std::wstring, Error> GetDeviceIconPath(const wchar_t *deviceId);
+	// Pass an enumerator when resolving several devices; without one a new one is created.
+	Result<std::wstring, Error> GetDeviceIconPath(const wchar_t *deviceId, IMMDeviceEnumerator *pEnum = nullptr);
 	HICON ExtractDeviceIcon(const std::wstring &iconPath);
+
+	// Calls onChange when an audio endpoint is added, removed, enabled or disabled, renamed, or
+	// becomes the default. It runs on a COM thread, may fire several times for one change and
+	// must not block. The callback stops when the watcher is destroyed.
+	class DeviceWatcher {
+	public:
+		explicit DeviceWatcher(std::function<void()> onChange);
+		~DeviceWatcher();
+
+		DeviceWatcher(const DeviceWatcher &) = delete;
+		DeviceWatcher &operator=(const DeviceWatcher &) = delete;
+
+	private:
+		class Client;
+		IMMDeviceEnumerator *m_enum = nullptr;
+		Client *m_client = nullptr;
+	};
 } // namespace Utils
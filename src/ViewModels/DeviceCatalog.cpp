@@ -0,0 +1,186 @@
+#include "DeviceCatalog.hpp"
+#include <QSettings>
+#include <QBuffer>
+#include <cstring>
+
+#include <objbase.h>
+#include <mmdeviceapi.h>
+#include <wrl/client.h>
+
+#include "AudioRedirector.hpp"
+
+// Adding or removing a device sends a burst of notifications (one per role and property).
+static constexpr int kSettleMs = 300;
+
+DeviceCatalog::DeviceCatalog(QObject *parent) : QObject(parent) {
+	load();
+
+	m_settle = new QTimer(this);
+	m_settle->setSingleShot(true);
+	m_settle->setInterval(kSettleMs);
+	connect(m_settle, &QTimer::timeout, this, &DeviceCatalog::Refresh);
+
+	// Notifications arrive on a COM thread; the timer restarts on the UI thread.
+	m_watcher = std::make_unique<Utils::DeviceWatcher>([timer = m_settle]() {
+		QMetaObject::invokeMethod(timer, [timer]() { timer->start(); }, Qt::QueuedConnection);
+	});
+}
+
+DeviceCatalog::~DeviceCatalog() {
+	m_watcher.reset(); // No notifications from here on
+
+	// A running enumeration finishes; the result it posts is dropped with this object.
+	if (m_worker) {
+		m_worker->wait();
+		delete m_worker;
+	}
+}
+
+void DeviceCatalog::Refresh() {
+	if (m_worker) {
+		m_pending = true;
+		return;
+	}
+
+	m_worker = QThread::create([this, cache = m_cache]() {
+		QString error;
+		DeviceList devices = enumerate(cache, &error);
+		QMetaObject::invokeMethod(this, [this, devices = std::move(devices), error]() {
+			finished(devices, error);
+		}, Qt::QueuedConnection);
+	});
+	m_worker->start();
+}
+
+void DeviceCatalog::finished(const DeviceList &devices, const QString &error) {
+	m_worker->wait(); // Returns at once: posting the result was the worker's last step
+	delete m_worker;
+	m_worker = nullptr;
+
+	if (error.isEmpty()) {
+		m_cache = devices;
+		save();
+		emit devicesEnumerated(m_cache);
+	} else {
+		emit enumerationFailed(error);
+	}
+
+	if (m_pending) {
+		m_pending = false;
+		Refresh();
+	}
+}
+
+// Worker thread. A device keeps its cached icon as long as its name is unchanged.
+DeviceList DeviceCatalog::enumerate(const DeviceList &cache, QString *error) {
+	DeviceList list;
+
+	// The WASAPI enumeration and the icon lookups both need COM on this thread.
+	const HRESULT hrInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	auto result = AudioRedirector::GetAudioDevices();
+	if (!result.has_value()) {
+		*error = QString::fromStdString(result.error().str());
+		if (SUCCEEDED(hrInit)) CoUninitialize();
+		return list;
+	}
+
+	// One enumerator for all the icon lookups instead of one per device.
+	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> pEnum;
+	CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(&pEnum));
+
+	const auto resolve = [&](const ma_device_info &info, const std::vector<DeviceEntry> &known) {
+		DeviceEntry entry = { info, QImage() };
+
+		for (const DeviceEntry &cached : known) {
+			if (ma_device_id_equal(&cached.info.id, &info.id) && std::strcmp(cached.info.name, info.name) == 0) {
+				entry.icon = cached.icon;
+				return entry;
+			}
+		}
+
+		auto iconPath = Utils::GetDeviceIconPath(info.id.wasapi, pEnum.Get());
+		if (iconPath.has_value()) {
+			HICON hIcon = Utils::ExtractDeviceIcon(iconPath.value());
+			if (hIcon) {
+				entry.icon = QImage::fromHICON(hIcon);
+				DestroyIcon(hIcon); // Clean up the HICON
+			}
+		}
+		return entry;
+	};
+
+	// The arrays belong to the context until the next enumeration, so they are copied out here.
+	const AudioDevices &devices = result.value();
+	for (ma_uint32 i = 0; i < devices.playbackDeviceCount; ++i) {
+		list.playback.push_back(resolve(devices.playbackDeviceInfos[i], cache.playback));
+	}
+	for (ma_uint32 i = 0; i < devices.captureDeviceCount; ++i) {
+		list.capture.push_back(resolve(devices.captureDeviceInfos[i], cache.capture));
+	}
+
+	pEnum.Reset();
+	if (SUCCEEDED(hrInit)) CoUninitialize();
+	return list;
+}
+
+// Settings layout: an array per device type under DeviceCache, each entry holding the raw
+// device ID, the name, the default flag and the icon as PNG.
+
+void DeviceCatalog::load() {
+	QSettings settings;
+	settings.beginGroup("DeviceCache");
+
+	const auto read = [&](const char *type, std::vector<DeviceEntry> &entries) {
+		const int count = settings.beginReadArray(type);
+		for (int i = 0; i < count; ++i) {
+			settings.setArrayIndex(i);
+
+			const QByteArray id = settings.value("id").toByteArray();
+			if (id.size() != sizeof(ma_device_id)) continue; // Written by a different build
+
+			DeviceEntry entry = {};
+			std::memcpy(&entry.info.id, id.constData(), sizeof(ma_device_id));
+			const QByteArray name = settings.value("name").toString().toUtf8();
+			std::strncpy(entry.info.name, name.constData(), sizeof(entry.info.name) - 1);
+			entry.info.isDefault = settings.value("default").toBool();
+			entry.icon.loadFromData(settings.value("icon").toByteArray(), "PNG");
+			entries.push_back(entry);
+		}
+		settings.endArray();
+	};
+
+	read("playback", m_cache.playback);
+	read("capture", m_cache.capture);
+	settings.endGroup();
+}
+
+void DeviceCatalog::save() const {
+	QSettings settings;
+	settings.beginGroup("DeviceCache");
+	settings.remove(""); // Devices gone since the last run go with the old entries
+
+	const auto write = [&](const char *type, const std::vector<DeviceEntry> &entries) {
+		settings.beginWriteArray(type, (int)entries.size());
+		for (int i = 0; i < (int)entries.size(); ++i) {
+			const DeviceEntry &entry = entries[i];
+			settings.setArrayIndex(i);
+			settings.setValue("id", QByteArray((const char *)&entry.info.id, sizeof(ma_device_id)));
+			settings.setValue("name", QString::fromUtf8(entry.info.name));
+			settings.setValue("default", (bool)entry.info.isDefault);
+
+			QByteArray png;
+			if (!entry.icon.isNull()) {
+				QBuffer buffer(&png);
+				buffer.open(QIODevice::WriteOnly);
+				entry.icon.save(&buffer, "PNG");
+			}
+			settings.setValue("icon", png);
+		}
+		settings.endArray();
+	};
+
+	write("playback", m_cache.playback);
+	write("capture", m_cache.capture);
+	settings.endGroup();
+}
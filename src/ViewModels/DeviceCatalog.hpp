@@ -0,0 +1,59 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QTimer>
+#include <QThread>
+#include <vector>
+#include <memory>
+
+#include "miniaudio.h"
+#include "Utils.hpp"
+
+struct DeviceEntry {
+	ma_device_info info;
+	QImage icon; // The device's own icon; null to use the generic one
+};
+
+struct DeviceList {
+	std::vector<DeviceEntry> playback;
+	std::vector<DeviceEntry> capture;
+};
+
+// The audio endpoints for the device dropdowns, enumerated off the UI thread.
+//
+// Enumeration and icon resolution (a COM property read and an icon extraction per device) run
+// on a worker thread. The result is kept in QSettings by device ID, so the next start shows the
+// last known list at once and the worker only extracts icons for devices that are new or were
+// renamed. Endpoint notifications (hotplug, default device changes) trigger a new enumeration
+// once they settle.
+class DeviceCatalog : public QObject {
+	Q_OBJECT
+
+public:
+	explicit DeviceCatalog(QObject *parent = nullptr);
+	~DeviceCatalog();
+
+	// The list saved by the previous enumeration; empty on the first run.
+	const DeviceList &Cached() const { return m_cache; }
+
+	// Enumerate on the worker thread; devicesEnumerated() follows on the UI thread. A refresh
+	// requested while one runs is queued behind it.
+	void Refresh();
+
+signals:
+	void devicesEnumerated(const DeviceList &devices);
+	void enumerationFailed(const QString &message);
+
+private:
+	static DeviceList enumerate(const DeviceList &cache, QString *error);
+	void finished(const DeviceList &devices, const QString &error);
+
+	void load();
+	void save() const;
+
+	DeviceList m_cache;
+	QThread *m_worker = nullptr;
+	bool m_pending = false;                   // A refresh was requested while the worker ran
+	QTimer *m_settle;                         // Collapses a burst of endpoint notifications
+	std::unique_ptr<Utils::DeviceWatcher> m_watcher;
+};
@@ -1,6 +1,29 @@
 #include "MainViewModel.hpp"
+#include <QSignalBlocker>
+#include <cstring>
+#include <algorithm>
+
 #include "MAConvert.hpp"
-#include "Utils.hpp"
+
+// First row of the format dropdowns: negotiate format, rate and channels with the devices.
+static const QString kAutoFormat = QStringLiteral("Auto — match the devices");
+
+// Rows of the channels dropdown: a routing of the first two source channels, or none for the
+// default routing by channel position.
+static const std::vector<ChannelRoute> kChannelRoutings[] = {
+    {},
+    {{1, 0, 1.0f}, {0, 1, 1.0f}},
+    {{0, 0, 1.0f}, {0, 1, 1.0f}},
+    {{1, 0, 1.0f}, {1, 1, 1.0f}},
+    {{0, 0, 0.5f}, {1, 0, 0.5f}, {0, 1, 0.5f}, {1, 1, 0.5f}},
+};
+
+// Rows of the buffering dropdown.
+enum Buffering {
+    BufferingDefault,
+    BufferingConservative,
+    BufferingAutoTuned
+};
 
 MainViewModel::MainViewModel(
     const MainUIState &loopbackUIState,
@@ -18,93 +41,164 @@ MainViewModel::MainViewModel(
             QString::fromStdString(result.error().str())
 		);
 	}
+
+    m_periodTuner = new PeriodTuner(this);
+    connect(m_periodTuner, &PeriodTuner::tuned, this, [this](PeriodTuner::Path path, const PeriodConfig &config) {
+        (path == PeriodTuner::Path::Loopback ? m_loopbackTuneText : m_captureTuneText) = config.periodSizeInFrames == 0
+            ? QStringLiteral("Auto-tuned: no period below the default was stable")
+            : QStringLiteral("Auto-tuned to %1-frame periods").arg(config.periodSizeInFrames);
+
+        // Tuning leaves its result applied; put back a choice made while it ran.
+        if (uiState(path).bufferingDropdown->currentIndex() != BufferingAutoTuned) this->changeBuffering(path);
+    });
+    connect(m_periodTuner, &PeriodTuner::tuningFailed, this, [this](PeriodTuner::Path path, const QString &message) {
+        (path == PeriodTuner::Path::Loopback ? m_loopbackTuneText : m_captureTuneText) = "Period tuning failed: " + message;
+    });
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(500);
+    connect(m_statsTimer, &QTimer::timeout, this, &MainViewModel::updateStats);
+    m_statsTimer->start();
 }
 
 MainViewModel::~MainViewModel() {
+    delete m_periodTuner;   // Waits for a tuning in progress, which drives the redirect
+    delete m_deviceCatalog; // Waits for an enumeration in progress, which uses the context
     AudioRedirector::Uninitialize();
 }
 
 void MainViewModel::loadDevices() {
-    auto result = AudioRedirector::GetAudioDevices();
-
-    if (result.has_value()) {
-        m_audioDevices = result.value();
-    } else {
-        this->errorOccurred(
-            "Failed to get audio devices",
-            QString::fromStdString(result.error().str())
-        );
-    }
+    m_deviceCatalog = new DeviceCatalog(this);
+    connect(m_deviceCatalog, &DeviceCatalog::devicesEnumerated, this, [this](const DeviceList &devices) {
+        this->updateDevices(devices, true);
+    });
+    connect(m_deviceCatalog, &DeviceCatalog::enumerationFailed, this, [this](const QString &message) {
+        this->errorOccurred("Failed to get audio devices", message);
+    });
 
     this->populateDropdowns();      // populate dropdowns
+    this->updateDevices(m_deviceCatalog->Cached(), false); // devices of the last run, until enumerated
     this->setDefaults();            // setup config defaults
     this->connectCaptureSignals();  // connect signals and slots
     this->connectLoopbackSignals(); // connect signals and slots
-}
 
-void MainViewModel::populateDropdowns() {
-    const QIcon microphoneIcon(":/icons/microphone.ico");
-    int defaultCaptureIndex = 0; /* Active default capture device */
+    // activated() is only emitted for the user's own picks, not for the defaults set here.
+    for (QComboBox *dropdown : {
+        m_loopbackUIState.inputDropdown, m_loopbackUIState.outputDropdown,
+        m_captureUIState.inputDropdown, m_captureUIState.outputDropdown
+    }) {
+        connect(dropdown, &QComboBox::activated, this, [this]() { m_devicesChosen = true; });
+    }
 
-    for (ma_uint32 i = 0; i < m_audioDevices.captureDeviceCount; ++i) {
-        const ma_device_info device_info = m_audioDevices.captureDeviceInfos[i];
+    m_deviceCatalog->Refresh();     // enumerate and resolve icons on a worker thread
+}
 
-        auto result = Utils::GetDeviceIconPath(device_info.id.wasapi);
-        QIcon icon = microphoneIcon;
+void MainViewModel::updateDevices(const DeviceList &devices, bool enumerated) {
+    const bool first = m_playbackDevices.empty() && m_captureDevices.empty();
+    // The cached list may be out of date on which devices are the defaults.
+    const bool firstEnumerated = enumerated && !m_enumerated;
+    m_enumerated = m_enumerated || enumerated;
 
-        if (result.has_value()) {
-            HICON hIcon = Utils::ExtractDeviceIcon(result.value());
-            if (hIcon) {
-                QImage image = QImage::fromHICON(hIcon);
-                DestroyIcon(hIcon); // Clean up the HICON
-                icon = QIcon(QPixmap::fromImage(image));
-            }
-        }
+    this->mergeDevices(
+        m_captureDevices, devices.capture,
+        { m_captureUIState.inputDropdown }, QIcon(":/icons/microphone.ico")
+    );
+    this->mergeDevices(
+        m_playbackDevices, devices.playback,
+        { m_loopbackUIState.inputDropdown, m_loopbackUIState.outputDropdown, m_captureUIState.outputDropdown },
+        QIcon(":/icons/speaker.ico")
+    );
 
-        if (device_info.isDefault) {
-            defaultCaptureIndex = i;
+    if (!first && !(firstEnumerated && !m_devicesChosen)) return;
+
+    // The first devices in, or the first live ones unless the user picked devices from the
+    // cached list meanwhile: select the active defaults.
+    const auto defaultIndex = [](const std::vector<DeviceItem> &items) {
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (items[i].info.isDefault) return static_cast<int>(i);
         }
+        return 0;
+    };
 
-        const QString name = QString::fromUtf8(device_info.name);
-        m_captureUIState.inputDropdown->addItem(icon, name);
-    }
+    m_captureUIState.inputDropdown->setCurrentIndex(defaultIndex(m_captureDevices));
+    m_captureUIState.outputDropdown->setCurrentIndex(defaultIndex(m_playbackDevices));
+    m_loopbackUIState.inputDropdown->setCurrentIndex(defaultIndex(m_playbackDevices));
+}
 
-    const QIcon speakerIcon(":/icons/speaker.ico");
-    int defaultPlaybackIndex = 0; /* Active default playback device */
+// Brings one device list and its dropdowns up to date with an enumeration, touching only the
+// rows that changed, so the selections and a running redirect are left alone. A selected
+// device that disappears keeps its row, marked disconnected; the redirect resumes on it when
+// it comes back.
+void MainViewModel::mergeDevices(
+    std::vector<DeviceItem> &items, const std::vector<DeviceEntry> &entries,
+    const QList<QComboBox *> &dropdowns, const QIcon &genericIcon
+) {
+    std::vector<QSignalBlocker> blockers;
+    blockers.reserve(dropdowns.size());
+    for (QComboBox *dropdown : dropdowns) blockers.emplace_back(dropdown);
+
+    const auto iconOf = [&](const QImage &image) {
+        return image.isNull() ? genericIcon : QIcon(QPixmap::fromImage(image));
+    };
 
-    for (ma_uint32 i = 0; i < m_audioDevices.playbackDeviceCount; ++i) {
-        ma_device_info device_info = m_audioDevices.playbackDeviceInfos[i];
+    // --- Removed ---
+    for (int row = static_cast<int>(items.size()) - 1; row >= 0; --row) {
+        const bool present = std::any_of(entries.begin(), entries.end(), [&](const DeviceEntry &entry) {
+            return ma_device_id_equal(&entry.info.id, &items[row].info.id);
+        });
+        if (present) continue;
+
+        const bool selected = std::any_of(dropdowns.begin(), dropdowns.end(), [row](QComboBox *dropdown) {
+            return dropdown->currentIndex() == row;
+        });
+        if (selected) {
+            if (items[row].connected) {
+                items[row].connected = false;
+                const QString name = QString::fromUtf8(items[row].info.name) + " (disconnected)";
+                for (QComboBox *dropdown : dropdowns) dropdown->setItemText(row, name);
+            }
+            continue;
+        }
 
-        auto result = Utils::GetDeviceIconPath(device_info.id.wasapi);
-        QIcon icon = speakerIcon;
+        items.erase(items.begin() + row);
+        for (QComboBox *dropdown : dropdowns) dropdown->removeItem(row);
+    }
 
-        if (result.has_value()) {
-            HICON hIcon = Utils::ExtractDeviceIcon(result.value());
-            if (hIcon) {
-                QImage image = QImage::fromHICON(hIcon);
-                DestroyIcon(hIcon); // Clean up the HICON
-                icon = QIcon(QPixmap::fromImage(image));
-            }
+    // --- Added and changed ---
+    for (const DeviceEntry &entry : entries) {
+        auto item = std::find_if(items.begin(), items.end(), [&](const DeviceItem &candidate) {
+            return ma_device_id_equal(&candidate.info.id, &entry.info.id);
+        });
+        const QString name = QString::fromUtf8(entry.info.name);
+
+        if (item == items.end()) {
+            items.push_back(DeviceItem{ entry.info, entry.icon, true });
+            for (QComboBox *dropdown : dropdowns) dropdown->addItem(iconOf(entry.icon), name);
+            continue;
         }
 
-        if (device_info.isDefault) {
-            defaultPlaybackIndex = i;
+        const int row = static_cast<int>(item - items.begin());
+        if (!item->connected || std::strcmp(item->info.name, entry.info.name) != 0) {
+            for (QComboBox *dropdown : dropdowns) dropdown->setItemText(row, name);
+        }
+        if (item->icon != entry.icon) {
+            for (QComboBox *dropdown : dropdowns) dropdown->setItemIcon(row, iconOf(entry.icon));
         }
 
-        const QString name = QString::fromUtf8(device_info.name);
-        m_loopbackUIState.inputDropdown->addItem(icon, name);
-        m_loopbackUIState.outputDropdown->addItem(icon, name);
-        m_captureUIState.outputDropdown->addItem(icon, name);
+        item->info = entry.info;
+        item->icon = entry.icon;
+        item->connected = true;
     }
+}
 
-    m_captureUIState.inputDropdown->setCurrentIndex(defaultCaptureIndex);
-    m_captureUIState.outputDropdown->setCurrentIndex(defaultPlaybackIndex);
-    m_loopbackUIState.inputDropdown->setCurrentIndex(defaultPlaybackIndex);
-
+void MainViewModel::populateDropdowns() {
     // -----------------------------------
     // Populate formats and sample rates
     // -----------------------------------
 
+    m_loopbackUIState.formatDropdown->addItem(kAutoFormat);
+    m_captureUIState.formatDropdown->addItem(kAutoFormat);
+
     for (const ma_format &format : AudioRedirector::Formats) {
         const QString fmt = QString::fromStdString(ma::convert::to_string(format));
         m_loopbackUIState.formatDropdown->addItem(fmt);
@@ -134,6 +228,42 @@ void MainViewModel::populateDropdowns() {
 
     m_loopbackUIState.volumeBoostDropdown->addItems(items);
     m_captureUIState.volumeBoostDropdown->addItems(items);
+
+    // Populate buffering dropdown, in the order of the Buffering rows
+
+    const QStringList buffering = {
+        "Default — 10 ms periods",
+        "Conservative — larger periods",
+        "Auto-tuned — smallest stable period"
+    };
+
+    m_loopbackUIState.bufferingDropdown->addItems(buffering);
+    m_captureUIState.bufferingDropdown->addItems(buffering);
+
+    // Populate resampler dropdown, in the order of ResamplerQuality
+
+    const QStringList resamplers = {
+        "Linear — fastest, audible aliasing",
+        "Sinc, low — 16 taps",
+        "Sinc, medium — 32 taps",
+        "Sinc, high — 64 taps"
+    };
+
+    m_loopbackUIState.resamplerDropdown->addItems(resamplers);
+    m_captureUIState.resamplerDropdown->addItems(resamplers);
+
+    // Populate channels dropdown, in the order of kChannelRoutings
+
+    const QStringList channels = {
+        "By speaker position",
+        "Swap left and right",
+        "Left on both sides",
+        "Right on both sides",
+        "Mono mix"
+    };
+
+    m_loopbackUIState.channelsDropdown->addItems(channels);
+    m_captureUIState.channelsDropdown->addItems(channels);
 }
 
 void MainViewModel::setDefaults() {
@@ -148,6 +278,9 @@ void MainViewModel::setDefaults() {
 
     m_captureUIState.formatDropdown->setCurrentText(duplexFormat);
     m_captureUIState.sampleRateDropdown->setCurrentText(duplexSampleRate);
+
+    m_loopbackUIState.resamplerDropdown->setCurrentIndex(static_cast<int>(AudioRedirector::GetLoopbackResampler()));
+    m_captureUIState.resamplerDropdown->setCurrentIndex(static_cast<int>(AudioRedirector::GetDuplexResampler()));
 }
 
 void MainViewModel::connectLoopbackSignals() {
@@ -156,10 +289,16 @@ void MainViewModel::connectLoopbackSignals() {
     });
 
     connect(m_loopbackUIState.outputDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
-        if (index >= 0) this->restartLoopbackRedirect();
+        if (index >= 0) this->switchLoopbackOutput(index);
     });
 
     connect(m_loopbackUIState.formatDropdown, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+        // The sample rate follows the devices too in auto mode.
+        const bool autoFormat = text == kAutoFormat;
+        AudioRedirector::SetLoopbackAutoFormat(autoFormat);
+        m_loopbackUIState.sampleRateDropdown->setEnabled(!autoFormat);
+        if (autoFormat) return this->reconfigureLoopbackRedirect();
+
         std::optional<ma_format> formatOpt = ma::convert::to_format(text.toStdString());
         if (!formatOpt.has_value()) {
             return this->errorOccurred(
@@ -169,7 +308,7 @@ void MainViewModel::connectLoopbackSignals() {
         }
 
         AudioRedirector::SetLoopbackFormat(formatOpt.value());
-        this->restartLoopbackRedirect();  // Restart redirect if running to apply new format
+        this->reconfigureLoopbackRedirect();  // Apply the new format to a running redirect
     });
 
     connect(m_loopbackUIState.sampleRateDropdown, &QComboBox::currentTextChanged, this, [this](const QString &text) {
@@ -184,11 +323,27 @@ void MainViewModel::connectLoopbackSignals() {
         }
 
         AudioRedirector::SetLoopbackSampleRate(sampleRate);
-        this->restartLoopbackRedirect();  // Restart redirect if running to apply new sample rate
+        this->reconfigureLoopbackRedirect();  // Apply the new sample rate to a running redirect
+    });
+
+    connect(m_loopbackUIState.resamplerDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
+        AudioRedirector::SetLoopbackResampler(static_cast<ResamplerQuality>(index));
+        this->reconfigureLoopbackRedirect();  // Apply the new resampler to a running redirect
+    });
+
+    connect(m_loopbackUIState.channelsDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
+        if (index < 0) return;
+        AudioRedirector::SetLoopbackRouting(kChannelRoutings[index]);
+        this->reconfigureLoopbackRedirect();  // Apply the new routing to a running redirect
     });
 
     connect(m_loopbackUIState.volumeBoostDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
         m_loopbackUIState.volumeSlider->setRange(0, 100 * (index + 1));
+        this->applyLimiter();
+    });
+
+    connect(m_loopbackUIState.bufferingDropdown, &QComboBox::currentIndexChanged, this, [this]() {
+        this->changeBuffering(PeriodTuner::Path::Loopback);
     });
 
     connect(m_loopbackUIState.volumeSlider, &QSlider::valueChanged, this, [this](int value) {
@@ -230,10 +385,16 @@ void MainViewModel::connectCaptureSignals() {
     });
 
     connect(m_captureUIState.outputDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
-        if (index >= 0) this->restartCaptureRedirect();
+        if (index >= 0) this->switchCaptureOutput(index);
     });
 
     connect(m_captureUIState.formatDropdown, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+        // The sample rate follows the devices too in auto mode.
+        const bool autoFormat = text == kAutoFormat;
+        AudioRedirector::SetDuplexAutoFormat(autoFormat);
+        m_captureUIState.sampleRateDropdown->setEnabled(!autoFormat);
+        if (autoFormat) return this->reconfigureCaptureRedirect();
+
         std::optional<ma_format> formatOpt = ma::convert::to_format(text.toStdString());
         if (!formatOpt.has_value()) {
             return this->errorOccurred(
@@ -243,7 +404,7 @@ void MainViewModel::connectCaptureSignals() {
         }
 
         AudioRedirector::SetDuplexFormat(formatOpt.value());
-        this->restartCaptureRedirect();  // Restart redirect if running to apply new format
+        this->reconfigureCaptureRedirect();  // Apply the new format to a running redirect
     });
 
     connect(m_captureUIState.sampleRateDropdown, &QComboBox::currentTextChanged, this, [this](const QString &text) {
@@ -258,11 +419,27 @@ void MainViewModel::connectCaptureSignals() {
         }
 
         AudioRedirector::SetDuplexSampleRate(sampleRate);
-        this->restartCaptureRedirect();  // Restart redirect if running to apply new sample rate
+        this->reconfigureCaptureRedirect();  // Apply the new sample rate to a running redirect
+    });
+
+    connect(m_captureUIState.resamplerDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
+        AudioRedirector::SetDuplexResampler(static_cast<ResamplerQuality>(index));
+        this->reconfigureCaptureRedirect();  // Apply the new resampler to a running redirect
+    });
+
+    connect(m_captureUIState.channelsDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
+        if (index < 0) return;
+        AudioRedirector::SetDuplexRouting(kChannelRoutings[index]);
+        this->reconfigureCaptureRedirect();  // Apply the new routing to a running redirect
     });
 
     connect(m_captureUIState.volumeBoostDropdown, &QComboBox::currentIndexChanged, this, [this](int index) {
         m_captureUIState.volumeSlider->setRange(0, 100 * (index + 1));
+        this->applyLimiter();
+    });
+
+    connect(m_captureUIState.bufferingDropdown, &QComboBox::currentIndexChanged, this, [this]() {
+        this->changeBuffering(PeriodTuner::Path::Duplex);
     });
 
     connect(m_captureUIState.volumeSlider, &QSlider::valueChanged, this, [this](int value) {
@@ -311,7 +488,7 @@ bool MainViewModel::startLoopbackRedirect() {
         return false;
     }
 
-    if (inputIndex >= static_cast<int>(m_audioDevices.playbackDeviceCount)) {
+    if (inputIndex >= static_cast<int>(m_playbackDevices.size())) {
         this->errorOccurred(
             "Selection Error", 
             "Selected input loopback device index is out of range."
@@ -319,14 +496,16 @@ bool MainViewModel::startLoopbackRedirect() {
         return false;
     }
 
-    if (outputIndex >= static_cast<int>(m_audioDevices.playbackDeviceCount)) {
+    if (outputIndex >= static_cast<int>(m_playbackDevices.size())) {
         this->errorOccurred("Selection Error", "Selected output device index is out of range.");
         return false;
     }
 
+    this->applyBuffering(PeriodTuner::Path::Loopback, outputIndex);
+
     ResultVoid result = AudioRedirector::StartLoopbackRedirect(
-        &m_audioDevices.playbackDeviceInfos[inputIndex].id,
-        &m_audioDevices.playbackDeviceInfos[outputIndex].id
+        &m_playbackDevices[inputIndex].info.id,
+        &m_playbackDevices[outputIndex].info.id
     );
 
     if (!result.has_value()) {
@@ -336,6 +515,8 @@ bool MainViewModel::startLoopbackRedirect() {
         );
         return false;
     }
+
+    this->tuneBuffering(PeriodTuner::Path::Loopback, outputIndex);
     return true;
 }
 
@@ -352,7 +533,7 @@ bool MainViewModel::startCaptureRedirect() {
         return false;
     }
 
-    if (inputIndex >= static_cast<int>(m_audioDevices.captureDeviceCount)) {
+    if (inputIndex >= static_cast<int>(m_captureDevices.size())) {
         this->errorOccurred(
             "Selection Error", 
             "Selected input capture device index is out of range."
@@ -360,14 +541,16 @@ bool MainViewModel::startCaptureRedirect() {
         return false;
     }
 
-    if (outputIndex >= static_cast<int>(m_audioDevices.playbackDeviceCount)) {
+    if (outputIndex >= static_cast<int>(m_playbackDevices.size())) {
         this->errorOccurred("Selection Error", "Selected output device index is out of range.");
         return false;
     }
 
+    this->applyBuffering(PeriodTuner::Path::Duplex, outputIndex);
+
     ResultVoid result = AudioRedirector::StartDuplexRedirect(
-        &m_audioDevices.captureDeviceInfos[inputIndex].id,
-        &m_audioDevices.playbackDeviceInfos[outputIndex].id
+        &m_captureDevices[inputIndex].info.id,
+        &m_playbackDevices[outputIndex].info.id
     );
 
     if (!result.has_value()) {
@@ -377,6 +560,8 @@ bool MainViewModel::startCaptureRedirect() {
         );
         return false;
     } 
+
+    this->tuneBuffering(PeriodTuner::Path::Duplex, outputIndex);
     return true;
 }
 
@@ -393,3 +578,237 @@ void MainViewModel::restartCaptureRedirect() {
         m_captureUIState.startButton->click(); // Start
     }
 }
+
+// The limiter keeps a boosted signal from clipping. Without a boost it would only add its
+// lookahead latency, so it is on while either path has a boost selected.
+void MainViewModel::applyLimiter() {
+    const bool boosted = m_loopbackUIState.volumeBoostDropdown->currentIndex() > 0 ||
+        m_captureUIState.volumeBoostDropdown->currentIndex() > 0;
+    if (boosted == AudioRedirector::IsLimiterEnabled()) return;
+
+    AudioRedirector::SetLimiterEnabled(boosted);
+    this->reconfigureLoopbackRedirect();
+    this->reconfigureCaptureRedirect();
+}
+
+void MainViewModel::reconfigureLoopbackRedirect() {
+    if (m_loopbackUIState.startButton->text() != "Stop") return;
+
+    // The running route keeps playing until the reconfigured one takes over.
+    ResultVoid result = AudioRedirector::ReconfigureLoopbackRedirect();
+    if (!result.has_value()) {
+        this->restartLoopbackRedirect(); // Fall back to a full restart
+    }
+}
+
+void MainViewModel::reconfigureCaptureRedirect() {
+    if (m_captureUIState.startButton->text() != "Stop") return;
+
+    ResultVoid result = AudioRedirector::ReconfigureDuplexRedirect();
+    if (!result.has_value()) {
+        this->restartCaptureRedirect();
+    }
+}
+
+static QString formatSwitchReport(const SwitchReport &report) {
+    return QStringLiteral("Last output switch: %1 ms gap (%2 ms overlap), new device ready after %3 ms")
+        .arg(report.gapMs, 0, 'f', 1)
+        .arg(report.overlapMs, 0, 'f', 1)
+        .arg(report.prepareMs, 0, 'f', 0);
+}
+
+// The new device opens and starts while the old one keeps playing, then the stream crossfades over.
+void MainViewModel::switchLoopbackOutput(int index) {
+    if (m_loopbackUIState.startButton->text() != "Stop") return;
+    if (index >= static_cast<int>(m_playbackDevices.size())) return;
+
+    this->applyBuffering(PeriodTuner::Path::Loopback, index); // The new pair may be tuned differently
+
+    auto report = AudioRedirector::SwitchLoopbackOutput(&m_playbackDevices[index].info.id);
+    if (report.has_value()) {
+        m_loopbackSwitchText = formatSwitchReport(report.value());
+        this->tuneBuffering(PeriodTuner::Path::Loopback, index);
+    } else {
+        m_loopbackSwitchText.clear();
+        this->restartLoopbackRedirect(); // Fall back to a full restart
+    }
+}
+
+void MainViewModel::switchCaptureOutput(int index) {
+    if (m_captureUIState.startButton->text() != "Stop") return;
+    if (index >= static_cast<int>(m_playbackDevices.size())) return;
+
+    this->applyBuffering(PeriodTuner::Path::Duplex, index);
+
+    auto report = AudioRedirector::SwitchDuplexOutput(&m_playbackDevices[index].info.id);
+    if (report.has_value()) {
+        m_captureSwitchText = formatSwitchReport(report.value());
+        this->tuneBuffering(PeriodTuner::Path::Duplex, index);
+    } else {
+        m_captureSwitchText.clear();
+        this->restartCaptureRedirect();
+    }
+}
+
+const MainUIState &MainViewModel::uiState(PeriodTuner::Path path) const {
+    return path == PeriodTuner::Path::Loopback ? m_loopbackUIState : m_captureUIState;
+}
+
+// The input and output device of a path with outputIndex as its output; false while either
+// selection is out of range.
+bool MainViewModel::devicePair(
+    PeriodTuner::Path path, int outputIndex, const ma_device_id *&input, const ma_device_id *&output
+) const {
+    const std::vector<DeviceItem> &inputs = path == PeriodTuner::Path::Loopback ? m_playbackDevices : m_captureDevices;
+    const int inputIndex = uiState(path).inputDropdown->currentIndex();
+
+    if (inputIndex < 0 || inputIndex >= static_cast<int>(inputs.size())) return false;
+    if (outputIndex < 0 || outputIndex >= static_cast<int>(m_playbackDevices.size())) return false;
+
+    input = &inputs[inputIndex].info.id;
+    output = &m_playbackDevices[outputIndex].info.id;
+    return true;
+}
+
+// Set the device period for the next time the path's devices open. An auto-tuned pair starts
+// at its saved period; one not tuned yet starts at the default and is tuned once it runs.
+void MainViewModel::applyBuffering(PeriodTuner::Path path, int outputIndex) {
+    PeriodConfig config;
+    const ma_device_id *input = nullptr;
+    const ma_device_id *output = nullptr;
+
+    switch (uiState(path).bufferingDropdown->currentIndex()) {
+        case BufferingConservative:
+            config.performanceProfile = ma_performance_profile_conservative;
+            break;
+        case BufferingAutoTuned:
+            if (this->devicePair(path, outputIndex, input, output)) {
+                config = PeriodTuner::Saved(path, *input, *output).value_or(config);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (path == PeriodTuner::Path::Loopback) AudioRedirector::SetLoopbackPeriodConfig(config);
+    else AudioRedirector::SetDuplexPeriodConfig(config);
+}
+
+// Tune a running auto-tuned pair that has no saved period yet, in the background.
+void MainViewModel::tuneBuffering(PeriodTuner::Path path, int outputIndex) {
+    if (uiState(path).bufferingDropdown->currentIndex() != BufferingAutoTuned) return;
+
+    const ma_device_id *input = nullptr;
+    const ma_device_id *output = nullptr;
+    if (!this->devicePair(path, outputIndex, input, output)) return;
+    if (PeriodTuner::Saved(path, *input, *output).has_value()) return;
+
+    (path == PeriodTuner::Path::Loopback ? m_loopbackTuneText : m_captureTuneText) = "Auto-tuning the device period...";
+    m_periodTuner->Tune(path, *input, *output);
+}
+
+void MainViewModel::changeBuffering(PeriodTuner::Path path) {
+    const MainUIState &ui = uiState(path);
+    const int outputIndex = ui.outputDropdown->currentIndex();
+
+    (path == PeriodTuner::Path::Loopback ? m_loopbackTuneText : m_captureTuneText).clear();
+    this->applyBuffering(path, outputIndex);
+
+    if (ui.startButton->text() != "Stop") return;
+    if (path == PeriodTuner::Path::Loopback) this->reconfigureLoopbackRedirect();
+    else this->reconfigureCaptureRedirect();
+    this->tuneBuffering(path, outputIndex);
+}
+
+static QString formatCallbackStats(const char *name, const CallbackStats &stats) {
+    return QStringLiteral("%1: DSP load %2% (peak %3%), p99 %4 ms every %5 ms, %6 underruns, %7 overruns, %8-frame periods")
+        .arg(name)
+        .arg(stats.loadPercent, 0, 'f', 1)
+        .arg(stats.peakLoadPercent, 0, 'f', 1)
+        .arg(stats.p99Micros / 1000.0, 0, 'f', 2)
+        .arg(stats.averageIntervalMicros / 1000.0, 0, 'f', 1)
+        .arg(stats.underruns)
+        .arg(stats.overruns)
+        .arg(stats.periodFrames);
+}
+
+// Which of miniaudio's conversion stages run on each device; capture converts from the device
+// format, playback to it.
+static QString formatConversions(const RouteConversions &conversions) {
+    const auto describe = [](const StreamConversion &stream, bool capture) {
+        const auto step = [capture](const QString &device, const QString &redirect) {
+            return capture ? device + " → " + redirect : redirect + " → " + device;
+        };
+        QStringList active;
+        if (stream.convertsFormat) {
+            active << "format " + step(ma_get_format_name(stream.deviceFormat), ma_get_format_name(stream.format));
+        }
+        if (stream.convertsChannels) {
+            active << "channels " + step(QString::number(stream.deviceChannels), QString::number(stream.channels));
+        }
+        if (stream.resamples) {
+            active << QStringLiteral("resampling %1 Hz (%2)")
+                .arg(step(QString::number(stream.deviceSampleRate), QString::number(stream.sampleRate)))
+                .arg(stream.resampler == ResamplerQuality::Linear ? QStringLiteral("linear") : QStringLiteral("sinc"));
+        }
+        return active.isEmpty() ? QStringLiteral("none") : active.join(", ");
+    };
+
+    QString text = QStringLiteral("Conversions%1: capture %2; playback %3")
+        .arg(conversions.negotiated ? " (auto)" : "")
+        .arg(describe(conversions.capture, true))
+        .arg(describe(conversions.playback, false));
+    if (conversions.routing != nullptr && std::strcmp(conversions.routing, "identity") != 0) {
+        text += QStringLiteral("; channels %1 → %2 routed (%3)")
+            .arg(conversions.capture.channels)
+            .arg(conversions.playback.channels)
+            .arg(conversions.routing);
+    }
+    return text;
+}
+
+// Empty until the redirect has lost a device or stalled at least once.
+static QString formatRecoveryStats(const RecoveryStats &stats) {
+    if (stats.recovering) {
+        return QStringLiteral("Device lost, reopening (%1 attempts failed)...").arg(stats.failedAttempts);
+    }
+    if (stats.recoveries == 0) return QString();
+
+    return QStringLiteral("Recovered %1 times (%2 device losses, %3 stalls), last in %4 ms, worst %5 ms")
+        .arg(stats.recoveries)
+        .arg(stats.deviceLosses)
+        .arg(stats.stalls)
+        .arg(stats.lastRecoveryMs, 0, 'f', 0)
+        .arg(stats.maxRecoveryMs, 0, 'f', 0);
+}
+
+void MainViewModel::updateStats() {
+    const RedirectorStats stats = AudioRedirector::GetStats();
+
+    if (m_loopbackUIState.startButton->text() == "Stop") {
+        QString text = formatCallbackStats("Capture", stats.loopbackCapture) + "\n" +
+            formatCallbackStats("Playback", stats.loopbackPlayback);
+        const RouteConversions conversions = AudioRedirector::GetLoopbackConversions();
+        if (conversions.running) text += "\n" + formatConversions(conversions);
+        if (!m_loopbackSwitchText.isEmpty()) text += "\n" + m_loopbackSwitchText;
+        if (!m_loopbackTuneText.isEmpty()) text += "\n" + m_loopbackTuneText;
+        const QString recovery = formatRecoveryStats(stats.loopbackRecovery);
+        if (!recovery.isEmpty()) text += "\n" + recovery;
+        m_loopbackUIState.statsLabel->setText(text);
+    } else {
+        m_loopbackUIState.statsLabel->clear();
+    }
+
+    if (m_captureUIState.startButton->text() == "Stop") {
+        QString text = formatCallbackStats("Duplex", stats.duplex);
+        const RouteConversions conversions = AudioRedirector::GetDuplexConversions();
+        if (conversions.running) text += "\n" + formatConversions(conversions);
+        if (!m_captureSwitchText.isEmpty()) text += "\n" + m_captureSwitchText;
+        if (!m_captureTuneText.isEmpty()) text += "\n" + m_captureTuneText;
+        const QString recovery = formatRecoveryStats(stats.duplexRecovery);
+        if (!recovery.isEmpty()) text += "\n" + recovery;
+        m_captureUIState.statsLabel->setText(text);
+    } else {
+        m_captureUIState.statsLabel->clear();
+    }
+}
@@ -2,9 +2,14 @@
 #include <QObject>
 #include <QString>
 #include <QIcon>
+#include <QTimer>
+#include <QList>
+#include <vector>
 
 #include "MainView.hpp"
 #include "AudioRedirector.hpp"
+#include "DeviceCatalog.hpp"
+#include "PeriodTuner.hpp"
 
 class MainViewModel : public QObject {
 	Q_OBJECT
@@ -23,8 +28,20 @@ signals:
 	void errorOccurred(const QString &title, const QString &message);
 
 private:
+	// One per row of the device dropdowns, in the same order.
+	struct DeviceItem {
+		ma_device_info info;
+		QImage icon;
+		bool connected = true; // False while a selected device is unplugged; its row stays
+	};
+
 	void setDefaults();
 	void populateDropdowns();
+	void updateDevices(const DeviceList &devices, bool enumerated);
+	void mergeDevices(
+		std::vector<DeviceItem> &items, const std::vector<DeviceEntry> &entries,
+		const QList<QComboBox *> &dropdowns, const QIcon &genericIcon
+	);
 	void connectLoopbackSignals();
 	void connectCaptureSignals();
 
@@ -34,8 +51,33 @@ private:
 	void restartLoopbackRedirect();
 	void restartCaptureRedirect();
 
+	void reconfigureLoopbackRedirect();
+	void reconfigureCaptureRedirect();
+	void applyLimiter();
+
+	void switchLoopbackOutput(int index);
+	void switchCaptureOutput(int index);
+
+	const MainUIState &uiState(PeriodTuner::Path path) const;
+	bool devicePair(PeriodTuner::Path path, int outputIndex, const ma_device_id *&input, const ma_device_id *&output) const;
+	void applyBuffering(PeriodTuner::Path path, int outputIndex);
+	void tuneBuffering(PeriodTuner::Path path, int outputIndex);
+	void changeBuffering(PeriodTuner::Path path);
+
+	void updateStats();
+
 private:
 	MainUIState m_loopbackUIState;
 	MainUIState m_captureUIState;
-	AudioDevices m_audioDevices = { nullptr, 0, nullptr, 0 };
+	std::vector<DeviceItem> m_playbackDevices;
+	std::vector<DeviceItem> m_captureDevices;
+	DeviceCatalog *m_deviceCatalog = nullptr;
+	bool m_enumerated = false;     // A live enumeration came in, not just the cached list
+	bool m_devicesChosen = false;  // The user picked a device in one of the device dropdowns
+	PeriodTuner *m_periodTuner = nullptr;
+	QTimer *m_statsTimer;
+	QString m_loopbackSwitchText; // Timing of the last output switch, shown with the stats
+	QString m_captureSwitchText;
+	QString m_loopbackTuneText;   // Outcome of the last period tuning, shown with the stats
+	QString m_captureTuneText;
 };
@@ -0,0 +1,74 @@
+#include "PeriodTuner.hpp"
+#include <QSettings>
+#include <QCryptographicHash>
+
+PeriodTuner::PeriodTuner(QObject *parent) : QObject(parent) {}
+
+PeriodTuner::~PeriodTuner() {
+	// A running tuning finishes; the result it posts is dropped with this object.
+	for (QThread *worker : m_workers) {
+		if (!worker) continue;
+		worker->wait();
+		delete worker;
+	}
+}
+
+// Device IDs are long and may hold characters QSettings treats specially; the pair is hashed.
+QString PeriodTuner::key(Path path, const ma_device_id &input, const ma_device_id &output) {
+	const QByteArray pair = QByteArray::fromStdString(
+		AudioRedirector::GetDeviceIdString(input) + "\n" + AudioRedirector::GetDeviceIdString(output)
+	);
+	const QString hash = QString::fromLatin1(QCryptographicHash::hash(pair, QCryptographicHash::Sha1).toHex());
+	return QStringLiteral("PeriodTuning/%1/%2").arg(path == Path::Loopback ? QStringLiteral("loopback") : QStringLiteral("duplex"), hash);
+}
+
+std::optional<PeriodConfig> PeriodTuner::Saved(Path path, const ma_device_id &input, const ma_device_id &output) {
+	QSettings settings;
+	settings.beginGroup(key(path, input, output));
+	if (!settings.contains("periodSizeInFrames")) return std::nullopt;
+
+	PeriodConfig config;
+	config.periodSizeInFrames = settings.value("periodSizeInFrames").toUInt();
+	config.periods = settings.value("periods").toUInt();
+	config.performanceProfile = settings.value("conservative").toBool()
+		? ma_performance_profile_conservative
+		: ma_performance_profile_low_latency;
+	return config;
+}
+
+void PeriodTuner::save(const QString &key, const PeriodConfig &config) {
+	QSettings settings;
+	settings.beginGroup(key);
+	settings.setValue("periodSizeInFrames", config.periodSizeInFrames);
+	settings.setValue("periods", config.periods);
+	settings.setValue("conservative", config.performanceProfile == ma_performance_profile_conservative);
+}
+
+void PeriodTuner::Tune(Path path, const ma_device_id &input, const ma_device_id &output) {
+	QThread *&worker = m_workers[index(path)];
+	if (worker) return;
+
+	worker = QThread::create([this, path, settingsKey = key(path, input, output)]() {
+		auto report = path == Path::Loopback
+			? AudioRedirector::TuneLoopbackPeriod()
+			: AudioRedirector::TuneDuplexPeriod();
+		QMetaObject::invokeMethod(this, [this, path, settingsKey, report = std::move(report)]() {
+			finished(path, settingsKey, report);
+		}, Qt::QueuedConnection);
+	});
+	worker->start();
+}
+
+void PeriodTuner::finished(Path path, const QString &key, const Result<PeriodTuneReport, Error> &report) {
+	QThread *&worker = m_workers[index(path)];
+	worker->wait(); // Returns at once: posting the result was the worker's last step
+	delete worker;
+	worker = nullptr;
+
+	if (report.has_value()) {
+		save(key, report.value().config);
+		emit tuned(path, report.value().config);
+	} else {
+		emit tuningFailed(path, QString::fromStdString(report.error().str()));
+	}
+}
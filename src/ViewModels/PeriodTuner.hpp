@@ -0,0 +1,47 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <optional>
+
+#include "AudioRedirector.hpp"
+
+// The smallest stable device period of each redirect path, found once per device pair and kept.
+//
+// Tuning steps a running redirect through smaller periods (AudioRedirector::Tune*Period) on a
+// worker thread, since each step is watched for a couple of seconds. The result is saved in
+// QSettings by path and by the IDs of the input and output device, so the pair starts at its
+// tuned period from then on.
+class PeriodTuner : public QObject {
+	Q_OBJECT
+
+public:
+	enum class Path {
+		Loopback,
+		Duplex
+	};
+
+	explicit PeriodTuner(QObject *parent = nullptr);
+	~PeriodTuner();
+
+	// The configuration tuned for a device pair, if it has been.
+	static std::optional<PeriodConfig> Saved(Path path, const ma_device_id &input, const ma_device_id &output);
+
+	// Tune the running redirect of path, which must be on this device pair. tuned() or
+	// tuningFailed() follow on the UI thread. Ignored while that path is being tuned.
+	void Tune(Path path, const ma_device_id &input, const ma_device_id &output);
+	bool IsTuning(Path path) const { return m_workers[index(path)] != nullptr; }
+
+signals:
+	void tuned(PeriodTuner::Path path, const PeriodConfig &config);
+	void tuningFailed(PeriodTuner::Path path, const QString &message);
+
+private:
+	static int index(Path path) { return path == Path::Loopback ? 0 : 1; }
+	static QString key(Path path, const ma_device_id &input, const ma_device_id &output);
+	static void save(const QString &key, const PeriodConfig &config);
+
+	void finished(Path path, const QString &key, const Result<PeriodTuneReport, Error> &report);
+
+	QThread *m_workers[2] = {};
+};
@@ -29,10 +29,22 @@ QWidget *CreateMainView(MainUIState &s) {
                 new QLabel("Format:"), 
                 s.formatDropdown = new QComboBox()
             ),
+            Layout<QHBoxLayout>(
+                new QLabel("Resampler:"),
+                s.resamplerDropdown = new QComboBox()
+            ),
+            Layout<QHBoxLayout>(
+                new QLabel("Channels:"),
+                s.channelsDropdown = new QComboBox()
+            ),
             Layout<QHBoxLayout>(
                 new QLabel("Volume Boost:"),
                 s.volumeBoostDropdown = new QComboBox()
             ),
+            Layout<QHBoxLayout>(
+                new QLabel("Buffering:"),
+                s.bufferingDropdown = new QComboBox()
+            ),
             Spacing(15),
             Layout<QHBoxLayout>(
                 new QLabel("Volume:"),
@@ -44,6 +56,10 @@ QWidget *CreateMainView(MainUIState &s) {
             )
         ),
         Spacing(15),
+        Container<QLabel>(
+            s.statsLabel = new QLabel(),
+            APPLY_EX(setContentsMargins(4, 0, 0, 0), setTextInteractionFlags(Qt::TextSelectableByMouse))
+        ),
         Stretch(1),
         s.startButton = new QPushButton("Start")
     );
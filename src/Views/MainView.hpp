@@ -11,9 +11,13 @@ struct MainUIState {
     QComboBox *outputDropdown;
     QComboBox *sampleRateDropdown;
     QComboBox *formatDropdown;
+    QComboBox *resamplerDropdown; // Rows in ResamplerQuality order
+    QComboBox *channelsDropdown;  // Channel routing presets
     QComboBox *volumeBoostDropdown;
+    QComboBox *bufferingDropdown; // Device period: backend default, conservative or auto-tuned
     SmoothSlider *volumeSlider;
     QLabel *volumeLabel;
+    QLabel *statsLabel; // Live callback statistics while redirecting
     QPushButton *startButton;
 };
 
@@ -0,0 +1,78 @@
+// Record rate change test: a reconfiguration to another sample rate ends a running recording.
+//
+// Records the loopback path on VirtualBackend's manual clock, reconfigures it from 48000 to
+// 44100 Hz a second in and runs on for another second. The file must stop at the change with
+// the rate it started at in its header, rather than taking the 44100 Hz frames as well.
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <filesystem>
+
+#include "AudioRedirector.hpp"
+#include "VirtualBackend.hpp"
+#include "WavFile.hpp"
+
+static const ma_device_id *find_endpoint(const AudioDevices &devices, ma_device_type type, std::string_view name) {
+	const ma_device_info *infos = type == ma_device_type_playback ? devices.playbackDeviceInfos : devices.captureDeviceInfos;
+	const ma_uint32 count = type == ma_device_type_playback ? devices.playbackDeviceCount : devices.captureDeviceCount;
+
+	for (ma_uint32 i = 0; i < count; ++i) {
+		if (name == infos[i].name) return &infos[i].id;
+	}
+	return nullptr;
+}
+
+static int fail(const char *message) {
+	std::fprintf(stderr, "FAIL: %s\n", message);
+	AudioRedirector::Uninitialize();
+	return 1;
+}
+
+int main() {
+	VirtualBackend::Script script = VirtualBackend::DefaultScript();
+	script.manual = true;
+
+	const ma_backend backend = ma_backend_custom;
+	const ma_context_config config = VirtualBackend::ContextConfig(&script);
+	if (!AudioRedirector::Initialize(&backend, 1, &config)) return fail("initialize");
+
+	const AudioDevices devices = AudioRedirector::GetAudioDevices().value();
+	const ma_device_id *sourceId = find_endpoint(devices, ma_device_type_playback, "Speakers");
+	const ma_device_id *playbackId = find_endpoint(devices, ma_device_type_playback, "Headphones");
+	const ma_context *context = AudioRedirector::GetContext();
+	const std::string path = (std::filesystem::temp_directory_path() / "RecordRateChangeTest.wav").string();
+
+	AudioRedirector::SetLoopbackSampleRate(48000);
+	if (!AudioRedirector::StartLoopbackRedirect(sourceId, playbackId)) return fail("start the redirect");
+	if (!AudioRedirector::StartLoopbackRecording(path)) return fail("start the recording");
+	VirtualBackend::Advance(context, 1.0);
+
+	AudioRedirector::SetLoopbackSampleRate(44100);
+	if (!AudioRedirector::ReconfigureLoopbackRedirect()) return fail("reconfigure to 44100 Hz");
+	const RecordingStats atChange = AudioRedirector::GetLoopbackRecordingStats();
+	VirtualBackend::Advance(context, 1.0);
+	const RecordingStats after = AudioRedirector::GetLoopbackRecordingStats();
+
+	AudioRedirector::StopLoopbackRecording();
+	AudioRedirector::StopLoopbackRedirect();
+
+	if (atChange.recording || after.recording) return fail("still recording after the rate change");
+	if (after.framesWritten == 0 || after.framesWritten != atChange.framesWritten) return fail("frames written after the rate change");
+
+	MappedWavFile file;
+	if (file.Open(path.c_str()) != MA_SUCCESS) return fail("open the recording");
+	const ma_uint32 sampleRate = file.GetSampleRate();
+	const ma_uint64 frames = file.GetFrameCount();
+	file.Close();
+	std::filesystem::remove(path);
+
+	if (sampleRate != 48000) return fail("the header lost the recording's rate");
+	if (frames != after.framesWritten) return fail("the header disagrees with the frames written");
+	// About a second of 48000 Hz audio, less what the jitter buffer held back at the start.
+	if (frames > 48000 * 5 / 4) return fail("the file holds more than the audio before the change");
+
+	AudioRedirector::Uninitialize();
+	std::printf("PASS: %llu frames at %u Hz, recording ended at the rate change\n", (unsigned long long)frames, sampleRate);
+	return 0;
+}
@@ -0,0 +1,66 @@
+// Short read test: an underrun on the loopback path records a ShortRead event.
+//
+// Drives internal::data_callback_{loopback,playback} without devices, as CallbackBench does:
+// pairs of periods until the jitter buffer pre-rolled, then playback periods alone until the
+// ring runs dry. The pre-roll must record no short reads, the underrun must record one.
+
+#include <cstdio>
+#include <vector>
+
+#include "AudioRedirector.hpp"
+#include "AudioInternal.hpp"
+#include "FlightRecorder.hpp"
+
+static constexpr ma_uint32 kPeriod = 480;
+
+static ma_uint64 count_short_reads(ma_uint64 &cursor) {
+	std::vector<FlightRecorder::Entry> entries;
+	internal::event_recorder().Read(cursor, entries);
+
+	ma_uint64 count = 0;
+	for (const FlightRecorder::Entry &entry : entries) {
+		if (entry.event == FlightRecorder::Event::ShortRead && entry.source == FlightRecorder::Source::LoopbackPlayback) ++count;
+	}
+	return count;
+}
+
+int main() {
+	AudioRedirector::SetLoopbackFormat(ma_format_f32);
+	AudioRedirector::SetLoopbackSampleRate(48000);
+	if (internal::init_loopback_pipeline() != MA_SUCCESS) {
+		std::fprintf(stderr, "Failed to initialize the loopback pipeline.\n");
+		return 1;
+	}
+
+	static ma_device device = {};
+	const ma_uint32 channels = AudioRedirector::GetLoopbackChannels();
+	const std::vector<float> input((size_t)kPeriod * channels, 0.25f);
+	std::vector<ma_uint8> output((size_t)kPeriod * ma_get_bytes_per_frame(ma_format_f32, AudioRedirector::GetLoopbackPlaybackChannels()));
+	ma_uint64 cursor = internal::event_recorder().GetRecorded();
+
+	const ma_uint64 prerollCalls = (ma_uint64)AudioRedirector::GetLoopbackLatency() * 48000 / 1000 / kPeriod + 8;
+	for (ma_uint64 i = 0; i < prerollCalls; ++i) {
+		internal::data_callback_loopback(&device, nullptr, input.data(), kPeriod);
+		internal::data_callback_playback(&device, output.data(), nullptr, kPeriod);
+	}
+	const ma_uint64 prerollReads = count_short_reads(cursor);
+
+	// Starve the reader: the ring holds about the target latency, so this runs it dry.
+	for (ma_uint64 i = 0; i < prerollCalls * 2; ++i) {
+		internal::data_callback_playback(&device, output.data(), nullptr, kPeriod);
+	}
+	const ma_uint64 underrunReads = count_short_reads(cursor);
+
+	internal::uninit_loopback_pipeline();
+
+	if (prerollReads != 0) {
+		std::fprintf(stderr, "FAIL: %llu short reads recorded while pre-rolling\n", (unsigned long long)prerollReads);
+		return 1;
+	}
+	if (underrunReads != 1) {
+		std::fprintf(stderr, "FAIL: %llu short reads recorded for one underrun, expected 1\n", (unsigned long long)underrunReads);
+		return 1;
+	}
+	std::printf("PASS: underrun recorded one short read\n");
+	return 0;
+}